@@ -62,6 +62,7 @@
     // * Some settings require a special feature known as PWM. These are marked above with an asterisks (*). Not all of the lights on the board are capable of implementing PWM,
     //   only the first 6 sockets. If you look at the underside of the physical board, these lights are marked with an asterisks (*). If you want to use these special settings,
     //   they must be on lights 1-6. Otherwise if you specify one of these settings on lights 7 or 8, the program will simply turn them OFF isntead.
+    //   Lights 9 and up, on shift registers (see ShiftRegisters in AA_UserConfig.h), can all do PWM.
 
     // EXPLANATION OF SCHEMES
     // ------------------------------------------------------------------------------------------------------------------------------------------------>
@@ -72,9 +73,16 @@
     // ------------------------------------------------------------------------------------------------------------------------------------------------>
     // Below you will see the lighting schemes. Each Scheme has a single row for each of the eight lights. The columns represent the states. The values
     // in the individual tables represent the settings for that light at that state.
+    // If you have added shift registers, add a row for each extra light after Light 8 in every scheme. Any light without a row is always OFF.
     //
     // OK, YOU'RE READY. TRY NOT TO MESS UP THE LAYOUT. JUST CHANGE THE SETTINGS.
+    //
+    // (If UseCompiledSchemes is set to true in AA_UserConfig.h, the schemes below are ignored and AA_SchemesCompiled.h is used instead. That file
+    // is made by tools/osl_scheme_compile.py from a CSV export of the OSL Light Setup spreadsheet.)
 
+#if UseCompiledSchemes
+    #include "AA_SchemesCompiled.h"
+#else
     const PROGMEM uint8_t Schemes[NumSchemes][NumLights][NumStates] =
     {
         {
@@ -105,3 +113,22 @@
             {  OFF,            OFF,            OFF,            OFF,            OFF,            NA,             NA,             NA,             NA,             NA,             NA,             NA,             NA,             NA,             NA             }   // Light 8    -- 
         }                                                                                                                                                                                                                                                     
     };
+#endif
+
+
+    // ADDRESSABLE PIXELS
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+    // Only used if PixelCount in AA_UserConfig.h is more than 0. Each pixel on the strip copies one of the lights above: whatever that light is doing in
+    // the current scheme (on, dim, blinking, fading...) the pixel does too, in the color given here. Red, green and blue are 0-255, the color at full
+    // brightness. Light 0 leaves the pixel off. There must be a row for every pixel, in the order they are wired, starting from the one nearest the
+    // board. Rows past PixelCount are ignored. 
+    const PROGMEM uint8_t PixelMap[][4] =
+    {
+    //     Light   Red     Green   Blue
+        {  1,      255,    255,    255    },  // Pixel 1    -- White, with Headlight One
+        {  2,      255,    255,    255    },  // Pixel 2    -- White, with Headlight Two
+        {  3,      255,    0,      0      },  // Pixel 3    -- Red, with the Brake Light
+        {  4,      255,    100,    0      },  // Pixel 4    -- Amber, with the Right Turn Lights
+        {  5,      255,    100,    0      },  // Pixel 5    -- Amber, with the Left Turn Lights
+        {  6,      255,    255,    255    }   // Pixel 6    -- White, with the Reverse Lights
+    };
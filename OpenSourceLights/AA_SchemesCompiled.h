@@ -0,0 +1,32 @@
+// AA_SchemesCompiled.h - light schemes, generated by tools/osl_scheme_compile.py from schemes_default.csv
+// DON'T EDIT THIS FILE - change the CSV and run the script again. Only used if UseCompiledSchemes = true in AA_UserConfig.h
+// 2 schemes, 9 unique light rows, 151 bytes of flash (240 as a full table)
+
+#if NumSchemes != 2
+#error "AA_SchemesCompiled.h holds 2 schemes, set NumSchemes in AA_UserConfig.h to match"
+#endif
+#if NumLights != 8
+#error "AA_SchemesCompiled.h has 8 lights per scheme, compile it again with --registers to match ShiftRegisters in AA_UserConfig.h"
+#endif
+
+    // Each unique light row, one setting per state
+    const PROGMEM uint8_t SchemeRows[9][NumStates] =
+    {
+        //     Pos 1            Pos 2            Pos 3            Pos 4            Pos 5            Forward          Reverse          Stop             StopDelay        Brake            Right Turn       Left Turn        No Turn          Accelerating     Decelerating
+            {  OFF,             OFF,             XENON,           XENON,           XENON,           NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              FASTBLINK,       NA },  // Row 0
+            {  FADEOFF,         FADEOFF,         ON,              ON,              ON,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA },  // Row 1
+            {  OFF,             OFF,             DIM,             DIM,             DIM,             NA,              NA,              NA,              NA,              ON,              NA,              NA,              NA,              NA,              NA },  // Row 2
+            {  OFF,             OFF,             DIM,             DIM,             DIM,             NA,              NA,              NA,              NA,              NA,              SOFTBLINK,       NA,              NA,              NA,              NA },  // Row 3
+            {  OFF,             OFF,             DIM,             DIM,             DIM,             NA,              NA,              NA,              NA,              NA,              NA,              SOFTBLINK,       NA,              NA,              NA },  // Row 4
+            {  OFF,             OFF,             OFF,             OFF,             OFF,             NA,              ON,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA },  // Row 5
+            {  OFF,             OFF,             OFF,             OFF,             OFF,             NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              BACKFIRE },  // Row 6
+            {  OFF,             OFF,             OFF,             OFF,             OFF,             NA,              BLINK,           NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA },  // Row 7
+            {  OFF,             OFF,             OFF,             OFF,             OFF,             NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA,              NA }   // Row 8
+    };
+
+    // For each scheme, the row used by each light
+    const PROGMEM uint8_t SchemeLightRows[NumSchemes][NumLights] =
+    {
+        {    0,   1,   2,   3,   4,   5,   6,   7  },  // Scheme 1
+        {    8,   8,   8,   8,   8,   8,   8,   8  }   // Scheme 2
+    };
@@ -7,6 +7,8 @@
 // ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
         #define NumSchemes                   2          // The number of lighting schemes implemented. Theoretically it can be anything up the memory limit. Defaults to 2. 
                                                         // MAKE SURE THIS NUMBER MATCHES THE NUMBER OF SCHEMES DEFINED IN AA_LIGHT_SETUP !!
+        #define UseCompiledSchemes       false          // If true, the schemes come from AA_SchemesCompiled.h instead of AA_LightSetup. Make that file from a CSV export 
+                                                        // of the light setup spreadsheet with tools/osl_scheme_compile.py, which also checks every setting. 
 
 
 // ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
@@ -43,6 +45,15 @@
         #define SmoothSteering            false
         #define SmoothChannel3            false
 
+    // Auto Calibration
+    // -------------------------------------------------------------------------------------------------------------------------------------------->
+        // If true, OSL keeps adjusting the throttle and steering endpoints and centers it learned in Radio Setup while you drive. The endpoints grow out 
+        // to the furthest the sticks actually go and very slowly shrink back in when they aren't used, and are saved every few minutes if they have moved. 
+        // The centers follow where the sticks rest, but only a little way from the centers Radio Setup found. Channel 3 is left as Radio Setup set it. 
+        // This lets you swap radios without running Radio Setup again, though you still need it once to set the channel directions and centers. 
+        
+        #define EnableAutoCalibration     false
+
 
 // ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
 // STATE ADJUSTMENTS
@@ -134,7 +145,29 @@
         #define SafetyBlinkRate             40         // Rate of blinking for the SafetyBlink effect in milliseconds - small numbers are fast, large numbers are slow. 
         #define SafetyBlinkCount             3         // The number of blinks in a row on one side, then the same number of blinks will occur on the other ("ALT") side, alternating back and forth. 
         #define SafetyBlink_Pause           80         // The length of time to pause between a series of blinks on one side followed by a series on the other side, in milliseconds. 
-                                                       // If you don't want a pause, set this to zero. 
+                                                       // If you don't want a pause, set this to zero.
+
+    // Extra Lights
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        // More than 8 lights can be run by adding a chain of 74HC595 shift registers, each of which adds 8 lights (9-16 on the first, 17-24 on the next, and so on).
+        // Connect them as described under SHIFT REGISTERS in OSL_Settings.h, and add a row to each scheme in AA_LightSetup for every extra light (lights
+        // without a row stay off). All the extra lights can use the PWM settings. Lights 1 and 2 keep theirs too, but they are then dimmed by the same
+        // timer as the shift registers, so nothing else can use Timer1.
+        // Every light takes about 82 bytes of RAM (its LED handler 63, its scheme settings 15, plus the current setting, telemetry and the shift register
+        // bits), so each register adds about 660 bytes. The ATmega328 only has 2048 bytes in all: check "Global variables use" when you compile, and
+        // leave at least 300 bytes free. That leaves room for one register at most (SHIFT_MAX_REGISTERS in OSL_Settings.h).
+        #define ShiftRegisters               0         // 0 for none (8 lights) or 1 (16 lights)
+
+    // Addressable Pixels
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        // A strip of WS2812 (NeoPixel) addressable LEDs can be connected to pin 12, with its own 5 volt supply. Each pixel copies one of the lights, in
+        // a color of its choosing: set which light and color for each pixel in PixelMap at the bottom of AA_LightSetup. Every pixel takes 3 bytes of RAM. 
+        // Pixels can't be used with shift registers, they need the same pin. 
+        // While the strip is being sent the RC inputs can't be read, so a pulse that ends during that time reads long. PixelsPerBurst limits how many pixels
+        // are sent in one go (30 uS each), letting the RC inputs in between. 1 keeps the error within the default throttle deadband. 0 sends the whole strip
+        // at once, which some older WS2812B need (see PIXEL_GAP_MAX_US in OSL_Settings.h), but it is only a good idea for a few pixels. 
+        #define PixelCount                   0         // 0 for none, up to 64
+        #define PixelsPerBurst               1         // Most pixels sent at once, 0 for the whole strip
 
 
 
@@ -163,6 +196,49 @@
         #define sqd_Time_Long             6000
 
 
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+// SCHEME UPLOAD
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+    // Light schemes can be sent to the OSL over the USB/serial port and stored in EEPROM, so you can try out a new scheme without re-flashing the 
+    // firmware. An uploaded scheme replaces the scheme of the same number in AA_LightSetup until it is erased again. Up to four schemes can be stored (two with one shift register, none with more). 
+    // Use the tools/osl_scheme_upload.py script to send a scheme. If set to false, uploads are ignored and only the schemes in AA_LightSetup are used. 
+
+        #define EnableSchemeUpload        true
+
+
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+// POWER SAVING
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+    // If true, the processor will sleep between events instead of running the main loop continuously. Lights, the radio and the serial port all work as 
+    // usual. This mostly helps models left on display in shelf-queen mode on battery power, where very little is happening most of the time. 
+
+        #define EnableIdleSleep           true
+
+
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+// TELEMETRY
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+    // If true, the OSL continuously sends a snapshot of the radio inputs, drive mode and every light's setting and brightness out the serial port, 
+    // which tools/osl_telemetry.py can display or plot on a laptop while you drive. It is a binary stream, so leave DEBUG false or the serial monitor 
+    // will be hard to read. Each snapshot is 37 bytes, so at 38400 baud the interval can't go much below 20 mS. 
+
+        #define EnableTelemetry          false
+        #define TelemetryInterval_mS        50          // How often to send a snapshot (50 = 20 times a second)
+
+
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+// MULTI-BOARD SYNC
+// ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
+    // Large models may need more than 8 lights. Several OSL boards can be chained so that only one of them, the master, reads the radio. It sends the 
+    // drive mode, turn signals, Channel 3 and so on to the others, the followers, at 100 Hz, and each board shows that with its own light scheme. Blinking 
+    // lights stay in step across all the boards. Connect the master's TX pin to the RX pin of every follower, and join their grounds. The followers don't 
+    // need a radio connected. The master's serial port is then used for the link, so leave DEBUG and EnableTelemetry false on it, and don't use the 
+    // serial monitor or scheme uploads on a follower while the master is connected. 
+    // Set to SYNC_OFF for a single board, or SYNC_MASTER or SYNC_FOLLOWER. 
+
+        #define SyncRole                        SYNC_OFF
+
+
 // ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
 // DEBUGGING
 // ---------------------------------------------------------------------------------------------------------------------------------------------------------------->
@@ -176,3 +252,7 @@
                                                     // You can use these to verify the board is working correctly without having any external lights connected.
     #define BLINK_LIGHTS_RX_LOST      false         // If true, all eight LED outputs will blink rapidly when the radio signal has been lost. 
                                                     // If set to false, only the onboard Red and Green LEDs will blink when the radio signal has been lost.
+    #define PROFILER                  false         // If true, the time taken by each part of the main loop is measured. Send "p" from the serial monitor to see the 
+                                                    // results, "r" to reset them. This uses a few hundred bytes of RAM, leave it false unless you are working on the code.
+    #define TRACE                     false         // If true, radio, drive mode and light changes are logged to a small buffer in RAM without the delays of printing them. 
+                                                    // Send "t" from the serial monitor to dump it, and decode the dump with tools/osl_trace_decode.py. Uses 256 bytes of RAM.
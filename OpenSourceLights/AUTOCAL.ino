@@ -0,0 +1,92 @@
+// AUTO CALIBRATION - keep learning the channel endpoints and centers while driving
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Only used if EnableAutoCalibration = true (see AA_UserConfig.h). AutoCalPulse is called by ProcessChannelPulses for every good pulse on a synched throttle
+// or steering channel and does as little as possible. UpdateAutoCalibration runs from the status task and applies what has been learned once every 
+// AUTOCAL_UPDATE_MS. The settings are under AUTO CALIBRATION in OSL_Settings.h
+
+void InitAutoCalibration()
+{   // Start from the calibration in RC_Channel, either loaded from EEPROM or just set by Radio Setup
+    for (uint8_t i=0; i<AUTOCAL_CHANNELS; i++)
+    {
+        AutoCal[i].lastPulse = RC_Channel[i].pulseCenter;
+        AutoCal[i].learnedMin = RC_Channel[i].pulseMin;
+        AutoCal[i].learnedMax = RC_Channel[i].pulseMax;
+        AutoCal[i].centerSum = 0;
+        AutoCal[i].centerCount = 0;
+    }
+}
+
+void AutoCalPulse(uint8_t ch, int16_t pulse)
+{
+    _autocal *a = &AutoCal[ch];
+    int16_t lower;
+    int16_t higher;
+
+    // An extreme only counts once two pulses in a row have reached it, so a single glitch can't stretch the range
+    if (pulse < a->lastPulse) { lower = pulse; higher = a->lastPulse; }
+    else                      { lower = a->lastPulse; higher = pulse; }
+    if (lower > a->learnedMax)  a->learnedMax = lower;
+    if (higher < a->learnedMin) a->learnedMin = higher;
+
+    // Count the pulse toward the center if the stick is resting near the calibrated one. Measuring from the saved center rather than the learned
+    // one means the center can't creep away a little at a time.
+    if (a->centerCount < 255 && (higher - lower) <= AUTOCAL_STILL_US && abs(pulse - Config.channel[ch].pulseCenter) <= AUTOCAL_CENTER_WINDOW_US)
+    {
+        a->centerSum += pulse;
+        a->centerCount++;
+    }
+    a->lastPulse = pulse;
+}
+
+void UpdateAutoCalibration()
+{
+    static uint32_t lastUpdate = 0;
+    static uint32_t lastSave = 0;
+    static boolean  wasInSetup = false;
+    _autocal       *a;
+    boolean         moved = false;
+
+    // Radio Setup sets the calibration itself. Start learning again from its results once it's done.
+    if (RadioSetupActive) { wasInSetup = true; return; }
+    if (wasInSetup) { InitAutoCalibration(); wasInSetup = false; }
+
+    if ((millis() - lastUpdate) < AUTOCAL_UPDATE_MS) return;
+    lastUpdate = millis();
+
+    for (uint8_t i=0; i<AUTOCAL_CHANNELS; i++)
+    {
+        a = &AutoCal[i];
+        if (RC_Channel[i].state != RC_SIGNAL_SYNCHED) continue;     // Nothing was learned, and we don't want the extremes shrinking with the radio off
+
+        // Move the center if the stick rested near it for most of the last update
+        if (a->centerCount >= AUTOCAL_DWELL_PULSES)
+        {
+            RC_Channel[i].pulseCenter = constrain(a->centerSum / a->centerCount, Config.channel[i].pulseCenter - AUTOCAL_CENTER_WINDOW_US, 
+                                                                                 Config.channel[i].pulseCenter + AUTOCAL_CENTER_WINDOW_US);
+        }
+        a->centerSum = 0;
+        a->centerCount = 0;
+
+        // Shrink the extremes a little. Any stick movement that reaches further pushes them straight back out.
+        if (a->learnedMax > RC_Channel[i].pulseCenter + AUTOCAL_MIN_SPAN_US) a->learnedMax -= AUTOCAL_DECAY_US;
+        if (a->learnedMin < RC_Channel[i].pulseCenter - AUTOCAL_MIN_SPAN_US) a->learnedMin += AUTOCAL_DECAY_US;
+        RC_Channel[i].pulseMax = max(a->learnedMax, RC_Channel[i].pulseCenter + AUTOCAL_MIN_SPAN_US);
+        RC_Channel[i].pulseMin = min(a->learnedMin, RC_Channel[i].pulseCenter - AUTOCAL_MIN_SPAN_US);
+
+        if (abs(RC_Channel[i].pulseMin - Config.channel[i].pulseMin) > AUTOCAL_SAVE_THRESHOLD_US ||
+            abs(RC_Channel[i].pulseMax - Config.channel[i].pulseMax) > AUTOCAL_SAVE_THRESHOLD_US) moved = true;
+    }
+
+    // Save all channels at once, and not often, the config store takes a new slot each time. Only the extremes are saved: the saved center is
+    // what the learned one is measured from, so it stays as Radio Setup left it.
+    if (moved && (millis() - lastSave) >= AUTOCAL_SAVE_INTERVAL_MS)
+    {
+        lastSave = millis();
+        for (uint8_t i=0; i<AUTOCAL_CHANNELS; i++)
+        {
+            Config.channel[i].pulseMin = RC_Channel[i].pulseMin;
+            Config.channel[i].pulseMax = RC_Channel[i].pulseMax;
+        }
+        SaveConfig();
+    }
+}
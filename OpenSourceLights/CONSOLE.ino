@@ -0,0 +1,355 @@
+// CONSOLE - change the user parameters from the serial monitor while the car is running
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Commands are typed one per line (set the serial monitor to send a newline). Characters are collected as they arrive, nothing is done until the
+// end of the line, so the console never holds up the radio or the lights.
+//
+//   help                   List the commands
+//   list                   Show every parameter with its value and allowed range
+//   get NAME               Show one parameter
+//   set NAME VALUE         Change a parameter. It takes effect straight away but is lost at power-off unless saved.
+//   save                   Save all the parameters to EEPROM, they will then be used instead of the values in AA_UserConfig.h
+//   defaults               Go back to the values in AA_UserConfig.h (save afterwards to make it permanent)
+//   s                      Scheduler task statistics
+//   p, r                   Print or reset the profiler (if PROFILER = true)
+//   t                      Dump the trace buffer (if TRACE = true)
+//
+// Parameter names are the same as the #defines in AA_UserConfig.h and are not case sensitive. The EEPROM block layout is described in OSL_Settings.h
+
+typedef struct {
+    uint8_t  offset;                                // Where the parameter is in the UserParams struct
+    uint8_t  size;                                  // 1, 2 or 4 bytes
+    uint32_t minimum;
+    uint32_t maximum;
+    uint32_t defaultValue;                          // From AA_UserConfig.h
+} _param_def;
+
+#define PARAM(field, lo, hi, def)   { offsetof(_user_params, field), sizeof(((_user_params *)0)->field), lo, hi, (uint32_t)(def) }
+
+// Must be in the same order as the PARAM_ numbers in OSL_Settings.h
+const _param_def ParamDefs[NUM_PARAMS] PROGMEM = {
+    PARAM(throttleDeadband,         0,      50,     ThrottleDeadband),
+    PARAM(turnDeadband,             0,      50,     TurnDeadband),
+    PARAM(smoothing,                0,      4,      smoothingStrength),
+    PARAM(doubleTapReverse,         0,      1,      DoubleTapReverse),
+    PARAM(longStopTime,             0,      3600000UL, LongStopTime_mS),
+    PARAM(brakeAtThrottlePctBelow,  0,      100,    BrakeAtThrottlePctBelow),
+    PARAM(blinkTurnOnlyAtStop,      0,      1,      BlinkTurnOnlyAtStop),
+    PARAM(turnSignalDelay,          0,      65535,  TurnSignalDelay_mS),
+    PARAM(turnFromStartContinue,    0,      65535,  TurnFromStartContinue_mS),
+    PARAM(accelPct,                 1,      100,    AccelPct),
+    PARAM(overtakeTime,             1,      65535,  OvertakeTime),
+    PARAM(decelPct,                 1,      100,    DecelPct),
+    PARAM(bfTimeShort,              1,      65535,  BF_Time_Short),
+    PARAM(bfTimeLong,               1,      65535,  BF_Time_Long),
+    PARAM(blinkInterval,            1,      65535,  BlinkInterval),
+    PARAM(fastBlinkInterval,        1,      65535,  FastBlinkInterval),
+    PARAM(dimLevel,                 0,      255,    DimLevel),
+    PARAM(fadeOutTime,              0,      65535,  FadeOutTime),
+    PARAM(fadeInTime,               0,      65535,  FadeInTime),
+    PARAM(safetyBlinkRate,          1,      65535,  SafetyBlinkRate),
+    PARAM(safetyBlinkCount,         1,      255,    SafetyBlinkCount),
+    PARAM(safetyBlinkPause,         0,      65535,  SafetyBlink_Pause)
+};
+
+static_assert(sizeof(_user_params) < 256, "UserParams is too big for the length byte of the EEPROM block");
+static_assert(EEPROM_PARAMS_START + EEPROM_PARAMS_HEADER_SIZE + sizeof(_user_params) <= EEPROM_SCHEME_BANK_START, "EEPROM parameter block runs into the scheme bank");
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// PARAMETER VALUES
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+uint32_t GetParam(uint8_t param)
+{
+    _param_def def;
+    uint32_t   value = 0;                           // Little-endian, so copying fewer than 4 bytes in still gives the right number
+
+    memcpy_P(&def, &ParamDefs[param], sizeof(def));
+    memcpy(&value, (uint8_t *)&UserParams + def.offset, def.size);
+    return value;
+}
+
+boolean SetParam(uint8_t param, uint32_t value)
+{
+    _param_def def;
+
+    memcpy_P(&def, &ParamDefs[param], sizeof(def));
+    if (value < def.minimum || value > def.maximum) return false;
+    memcpy((uint8_t *)&UserParams + def.offset, &value, def.size);
+    return true;
+}
+
+void LoadDefaultParams()
+{
+    _param_def def;
+
+    for (uint8_t i=0; i<NUM_PARAMS; i++)
+    {
+        memcpy_P(&def, &ParamDefs[i], sizeof(def));
+        memcpy((uint8_t *)&UserParams + def.offset, &def.defaultValue, def.size);
+    }
+}
+
+void LoadUserParams()
+{
+    // Called once at startup before anything uses the parameters. Use the saved copy if there is a valid one, otherwise the AA_UserConfig.h values.
+    // A copy saved by firmware with another PARAMS_FORMAT_VERSION is brought up to date by MigrateUserParams, or if it can't be, the defaults are used.
+    // Saved values that are now out of range (the limits above may have changed since) are put back to their defaults.
+    _param_def def;
+    uint8_t    version;
+    uint8_t    length;
+
+    LoadDefaultParams();
+    version = SavedUserParamsVersion();
+    if (version == 0) return;
+
+    // Anything the saved copy doesn't have keeps its default
+    length = EEPROMWriter.read(EEPROM_PARAMS_START + 1);
+    EEPROMWriter.readBlock(&UserParams, EEPROM_PARAMS_START + EEPROM_PARAMS_HEADER_SIZE, min(length, sizeof(UserParams)));
+    if (version != PARAMS_FORMAT_VERSION || length != sizeof(UserParams))
+    {   // A copy of the current version but the wrong length shouldn't happen, don't trust it
+        if (version == PARAMS_FORMAT_VERSION || !MigrateUserParams(version, length))
+        {
+            LoadDefaultParams();
+            return;
+        }
+    }
+    for (uint8_t i=0; i<NUM_PARAMS; i++)
+    {
+        if (!SetParam(i, GetParam(i)))
+        {
+            memcpy_P(&def, &ParamDefs[i], sizeof(def));
+            SetParam(i, def.defaultValue);
+        }
+    }
+}
+
+boolean MigrateUserParams(uint8_t version, uint8_t length)
+{   // UserParams holds the defaults with the first length bytes of a copy saved by firmware with another PARAMS_FORMAT_VERSION laid over them. Bring
+    // it up to date one version at a time, each case falling through to the next, as MigrateConfig does for the config store. Return false if the
+    // version is unknown and the defaults should be used instead. Parameters that were only added to the end of _user_params need nothing more than
+    // a case that returns true, the saved ones are already in place and the new ones have their defaults. The migrated values are used from then on
+    // but only written back to EEPROM by the next save. There has only been one version so far.
+    switch (version)
+    {
+        default:
+            return false;
+    }
+}
+
+void ApplyUserParams()
+{
+    // Most parameters are read straight from UserParams each time they are used, only these have been copied somewhere else
+    DriveModeConfig config;
+    GetDriveModeConfig(config);
+    Drive.setConfig(config);
+    RC_Channel[0].deadband = UserParams.throttleDeadband;
+    RC_Channel[1].deadband = UserParams.turnDeadband;
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// EEPROM BLOCK
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+uint16_t UserParamsCRC(uint8_t Version, uint8_t Length)
+{   // CRC over the version byte, the length and the data as stored in EEPROM. The version is passed in so the CRC can be calculated before the
+    // version byte is written, and the length so a block saved by other firmware can be checked too.
+    uint16_t crc = 0;
+    crc = _crc_xmodem_update(crc, Version);
+    crc = _crc_xmodem_update(crc, Length);
+    for (uint16_t i=0; i<Length; i++)
+    {
+        crc = _crc_xmodem_update(crc, EEPROMWriter.read(EEPROM_PARAMS_START + EEPROM_PARAMS_HEADER_SIZE + i));
+    }
+    return crc;
+}
+
+uint8_t SavedUserParamsVersion()
+{   // The format version of the saved parameters, whichever firmware saved them, or 0 if none have been saved or the block is corrupt
+    uint8_t  version = EEPROMWriter.read(EEPROM_PARAMS_START);
+    uint8_t  length = EEPROMWriter.read(EEPROM_PARAMS_START + 1);
+    uint16_t crc;
+
+    if (version == 0 || version == EEPROM_PARAMS_EMPTY) return 0;
+    if (EEPROM_PARAMS_START + EEPROM_PARAMS_HEADER_SIZE + length > EEPROM_SCHEME_BANK_START) return 0;
+    EEPROMWriter.readBlock(&crc, EEPROM_PARAMS_START + 2, sizeof(crc));
+    return (crc == UserParamsCRC(version, length)) ? version : 0;
+}
+
+boolean UserParamsSaved()
+{   // A copy of the parameters as they are now has been saved
+    return (SavedUserParamsVersion() == PARAMS_FORMAT_VERSION && EEPROMWriter.read(EEPROM_PARAMS_START + 1) == sizeof(UserParams));
+}
+
+boolean SaveUserParams(boolean start)
+{
+    // The block is bigger than the EEPROM write queue, so like a scheme upload it is queued as room comes free, called with start = true to 
+    // begin and then with false on every pass of the serial task. Returns true until the save is done and has been checked.
+    // The version byte is cleared first and only set again once the CRC is in, so a power loss part-way through leaves the defaults rather than a mix.
+    // The CRC is calculated from the bytes as they are queued. Checking what was saved waits until the writer has finished, reading the block back 
+    // any sooner would wait on every byte still being written.
+    static boolean saving = false;
+    static boolean verifying = false;
+    static uint8_t count;
+    static uint16_t crc;
+    uint8_t b;
+
+    if (start)
+    {
+        EEPROMWriter.write(EEPROM_PARAMS_START, EEPROM_PARAMS_EMPTY);
+        EEPROMWriter.write(EEPROM_PARAMS_START + 1, sizeof(UserParams));
+        crc = _crc_xmodem_update(0, PARAMS_FORMAT_VERSION);                         // See UserParamsCRC()
+        crc = _crc_xmodem_update(crc, sizeof(UserParams));
+        count = 0;
+        saving = true;
+        verifying = false;
+        return true;
+    }
+
+    if (verifying)
+    {
+        if (!EEPROMWriter.idle()) return true;
+        verifying = false;
+        Serial.println(UserParamsSaved() ? F("Saved") : F("Save failed"));
+        return false;
+    }
+    if (!saving) return false;
+
+    for ( ; EEPROMWriter.room() > 0 && count<sizeof(UserParams); count++)
+    {
+        b = ((uint8_t *)&UserParams)[count];
+        EEPROMWriter.write(EEPROM_PARAMS_START + EEPROM_PARAMS_HEADER_SIZE + count, b);
+        crc = _crc_xmodem_update(crc, b);
+    }
+    if (count < sizeof(UserParams) || EEPROMWriter.room() < 3) return true;
+
+    EEPROMWriter.writeBlock(&crc, EEPROM_PARAMS_START + 2, sizeof(crc));
+    EEPROMWriter.write(EEPROM_PARAMS_START, PARAMS_FORMAT_VERSION);
+    saving = false;
+    verifying = true;
+    return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// COMMAND LINE
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+void SerialCommand(char c)
+{
+    // Every character from the serial monitor that isn't part of a scheme upload ends up here
+    static char    line[CONSOLE_LINE_LENGTH + 1];
+    static uint8_t length = 0;
+    static boolean overflow = false;
+
+    if (c == '\r' || c == '\n')
+    {
+        line[length] = '\0';
+        if (overflow)         Serial.println(F("Line too long"));
+        else if (length > 0)  ConsoleCommand(line);
+        length = 0;
+        overflow = false;
+    }
+    else if (length < CONSOLE_LINE_LENGTH) line[length++] = c;
+    else overflow = true;
+}
+
+void ConsoleCommand(char *line)
+{
+    char     *cmd;
+    char     *name;
+    char     *arg;
+    char     *end;
+    uint8_t  param;
+    uint32_t value;
+
+    cmd  = strtok(line, " \t");
+    name = strtok(NULL, " \t");
+    arg  = strtok(NULL, " \t");
+    if (cmd == NULL) return;
+
+    if (strcasecmp_P(cmd, PSTR("list")) == 0)
+    {
+        for (param=0; param<NUM_PARAMS; param++) PrintParam(param);
+    }
+    else if (strcasecmp_P(cmd, PSTR("get")) == 0 || strcasecmp_P(cmd, PSTR("set")) == 0)
+    {
+        param = FindParam(name);
+        if (param >= NUM_PARAMS) { Serial.println(F("Unknown parameter, type list to see them all")); return; }
+        if (cmd[0] == 's' || cmd[0] == 'S')
+        {
+            if (arg == NULL) { Serial.println(F("Usage: set NAME VALUE")); return; }
+            value = strtoul(arg, &end, 10);
+            if (*end != '\0' || arg[0] == '-' || !SetParam(param, value)) { Serial.println(F("Out of range")); PrintParam(param); return; }
+            ApplyUserParams();
+        }
+        PrintParam(param);
+    }
+    else if (strcasecmp_P(cmd, PSTR("save")) == 0)
+    {
+        SaveUserParams(true);
+    }
+    else if (strcasecmp_P(cmd, PSTR("defaults")) == 0)
+    {
+        LoadDefaultParams();
+        ApplyUserParams();
+        Serial.println(F("Defaults loaded, type save to keep them"));
+    }
+    else if (strcasecmp_P(cmd, PSTR("s")) == 0)
+    {
+        PrintTaskStats();
+    }
+#if PROFILER
+    else if (strcasecmp_P(cmd, PSTR("p")) == 0)
+    {
+        PrintProfile();
+    }
+    else if (strcasecmp_P(cmd, PSTR("r")) == 0)
+    {
+        Profiler.reset();
+        Serial.println(F("Profiler reset"));
+    }
+#endif
+#if TRACE
+    else if (strcasecmp_P(cmd, PSTR("t")) == 0)
+    {
+        Trace.dump(Serial);
+    }
+#endif
+    else
+    {
+        PrintWaiting(F("Commands: list, get NAME, set NAME VALUE, save, defaults, s (task stats)"));
+        if (PROFILER) PrintWaiting(F(", p (profile), r (reset profile)"));
+        if (TRACE) PrintWaiting(F(", t (trace)"));
+        Serial.println();
+    }
+}
+
+uint8_t FindParam(const char *name)
+{   // Returns NUM_PARAMS if there is no such parameter
+    uint8_t param;
+
+    if (name == NULL) return NUM_PARAMS;
+    for (param=0; param<NUM_PARAMS; param++)
+    {
+        if (strcasecmp_P(name, (const char *)printParamName(param)) == 0) break;
+    }
+    return param;
+}
+
+void PrintParam(uint8_t param)
+{
+    _param_def def;
+
+    memcpy_P(&def, &ParamDefs[param], sizeof(def));
+    WaitForSerial(DEBUG_MESSAGE_MAX);               // Keeps the other tasks running while a long list goes out
+    Serial.print(printParamName(param));
+    PrintSpaces(26 - strlen_P((const char *)printParamName(param)));
+    Serial.print(GetParam(param));
+    WaitForSerial(DEBUG_MESSAGE_MAX);
+    Serial.print(F("  ("));
+    Serial.print(def.minimum);
+    Serial.print(F("-"));
+    Serial.print(def.maximum);
+    Serial.print(F(", default "));
+    Serial.print(def.defaultValue);
+    Serial.println(F(")"));
+}
@@ -0,0 +1,91 @@
+// DEBUG QUEUE - debug messages printed while driving, without waiting on the serial port
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// QueueDebugMessage() stores a 4-byte record, DrainDebugQueue() (run by the serial task) turns the oldest record into text once the transmit buffer 
+// has room for all of it, so the print itself never has to wait. See DEBUG_QUEUE_LENGTH in OSL_Settings.h
+
+void QueueDebugMessage(uint8_t type, uint8_t arg, int16_t value)
+{
+    _debug_message *m;
+    
+    if (DebugQueueCount >= DEBUG_QUEUE_LENGTH)
+    {
+        if (DebugQueueDropped < 255) DebugQueueDropped++;
+        return;
+    }
+    m = &DebugQueue[(DebugQueueHead + DebugQueueCount) % DEBUG_QUEUE_LENGTH];
+    m->type = type;
+    m->arg = arg;
+    m->value = value;
+    DebugQueueCount++;
+}
+
+void DrainDebugQueue()
+{
+    _debug_message *m;
+
+    while (DebugQueueCount > 0 && Serial.availableForWrite() >= DEBUG_MESSAGE_MAX)
+    {
+        if (DebugQueueDropped)
+        {   // Let the reader know there is a gap
+            Serial.print(F("(")); Serial.print(DebugQueueDropped); Serial.println(F(" messages dropped)"));
+            DebugQueueDropped = 0;
+            continue;
+        }
+
+        m = &DebugQueue[DebugQueueHead];
+        switch (m->type)
+        {
+            case DBG_LIGHT_SETTING:
+                PrintLightSetting(m->arg, m->value);
+                break;
+            
+            case DBG_DRIVE_MODE:
+                Serial.print(F("Drive Mode: ")); Serial.println(printMode(m->arg));
+                break;
+
+            case DBG_RADIO_STATE:
+                Serial.print(F("Radio state change: "));
+                Serial.print(printRadioState(m->arg));
+                if (m->arg == RC_SIGNAL_LOST) Serial.print(F("!"));
+                Serial.println();
+                break;
+
+            case DBG_SCHEME_CHANGED:
+                Serial.print(F("Scheme ")); Serial.print(m->arg);
+                Serial.println(m->value ? F(" loaded from EEPROM") : F(" restored from program memory"));
+                break;
+
+            case DBG_IDLE_STATS:
+                Serial.print(F("Idle: ")); Serial.print(m->value / 10); Serial.print(F(".")); Serial.print(m->value % 10); Serial.println(F("% asleep"));
+                break;
+
+            case DBG_SCHEME_SELECTED:
+                Serial.print(F("Scheme changed to: ")); Serial.println(m->arg);
+                break;
+
+            case DBG_CHANGE_SCHEME_MODE:
+                Serial.print(m->value ? F("Enter") : F("Exit")); Serial.print(F(" Change-Scheme-Mode, scheme ")); Serial.println(m->arg);
+                break;
+        }
+        DebugQueueHead = (DebugQueueHead + 1) % DEBUG_QUEUE_LENGTH;
+        DebugQueueCount--;
+    }
+}
+
+void WaitForSerial(uint8_t bytes)
+{
+    // For the longer printouts: wait until the transmit buffer has room for this many bytes, keeping the radio, lights and timers going meanwhile.
+    while (Serial.availableForWrite() < bytes) PerLoopUpdates();
+}
+
+void PrintWaiting(const __FlashStringHelper *str)
+{
+    // Print a string from program memory that may be longer than the transmit buffer, a piece at a time
+    const char *p = (const char *)str;
+    char c;
+    while ((c = pgm_read_byte(p++)) != 0)
+    {
+        WaitForSerial(1);
+        Serial.write(c);
+    }
+}
@@ -1,11 +1,22 @@
 
-int ReturnDriveMode(int ThrottleCMD)
+void InitializeDriveMode(uint32_t now)
 {
-    if (ThrottleCMD       >  ThrottleDeadband) { return FWD;  }
-    else if (ThrottleCMD  < -ThrottleDeadband) { return REV;  }
-    else                                       { return STOP; }
+    // Hand the drive mode state machine its settings and start it out stopped
+    DriveModeConfig config;
+    GetDriveModeConfig(config);
+    Drive.begin(config, now);
 }
 
-
-
-
+void GetDriveModeConfig(DriveModeConfig &config)
+{
+    // Most of these can be changed from the serial console so come from UserParams, the rest are fixed in OSL_Settings.h
+    config.throttleDeadband         = UserParams.throttleDeadband;
+    config.doubleTapReverse         = UserParams.doubleTapReverse;
+    config.brakeAtThrottlePctBelow  = UserParams.brakeAtThrottlePctBelow;
+    config.fwdToRevBrakeTime        = FWD_to_REV_BrakeTime;
+    config.turnSignalDelay          = UserParams.turnSignalDelay;
+    config.changeSchemeDelay        = CSM_StopDelay_mS;
+    config.longStopTime             = UserParams.longStopTime;
+    config.accelPct                 = UserParams.accelPct;
+    config.decelPct                 = UserParams.decelPct;
+}
@@ -1,43 +1,150 @@
-
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
+// CONFIG STORE - radio calibration and the selected scheme. See OSL_ConfigStore and EEPROM CONFIG STORE in OSL_Settings.h
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
 void Initialize_EEPROM() 
 {   // If EEPROM has not been used before, we initialize to some sensible, yet conservative, default values.
     // The first time a radio setup is performed, these will be overwritten with actual values, and never referred to again. 
     // Because the radio setup is the first thing a user should do, these in fact should not come into play. 
-
-    eeprom_write(PULSE_WIDTH_TYP_MIN,    E_ThrottlePulseMin);
-    eeprom_write(PULSE_WIDTH_TYP_MAX,    E_ThrottlePulseMax);
-    eeprom_write(PULSE_WIDTH_TYP_CENTER, E_ThrottlePulseCenter);
-    eeprom_write(PULSE_WIDTH_TYP_MIN,    E_TurnPulseMin);
-    eeprom_write(PULSE_WIDTH_TYP_MAX,    E_TurnPulseMax);
-    eeprom_write(PULSE_WIDTH_TYP_CENTER, E_TurnPulseCenter);
-    eeprom_write(PULSE_WIDTH_TYP_MIN,    E_Channel3PulseMin);
-    eeprom_write(PULSE_WIDTH_TYP_MAX,    E_Channel3PulseMax);
-    eeprom_write(PULSE_WIDTH_TYP_CENTER, E_Channel3PulseCenter);
-    
-    eeprom_write(false, E_ThrottleChannelReverse);
-    eeprom_write(false, E_TurnChannelReverse);
-    eeprom_write(false, E_Channel3Reverse);    
-
-    eeprom_write(1, E_CurrentScheme);    // Default to Scheme #1
-    
-    // This is our initialization constant
-    eeprom_write(EEPROM_Init, E_InitNum);
-
-    // Finally - we still need to set up our variables, so now we call Load_EEPROM
-    Load_EEPROM();
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        Config.channel[i].pulseMin    = PULSE_WIDTH_TYP_MIN;
+        Config.channel[i].pulseCenter = PULSE_WIDTH_TYP_CENTER;
+        Config.channel[i].pulseMax    = PULSE_WIDTH_TYP_MAX;
+        Config.channel[i].reversed    = false;
+    }
+    Config.currentScheme = 1;           // Default to Scheme #1
 }
 
 void Load_EEPROM()
 {   
-    // If EEPROM has been used before, we run this routine to load all our saved values at startup
-    eeprom_read(CurrentScheme, E_CurrentScheme);
+    // Load the newest saved config. If none has been saved yet, carry over the settings from older firmware if there are any, otherwise start 
+    // from the defaults. Either way the result is saved straight away so this only happens once. 
+    uint8_t version;
+    long    initNum;
+
+    ConfigStore.begin(EEPROM_CONFIG_START, EEPROM_CONFIG_SLOTS, EEPROM_CONFIG_SLOT_SIZE);
+    Initialize_EEPROM();                // Anything not in the saved record keeps its default
+    version = ConfigStore.load(&Config, sizeof(Config));
+    if (version == CONFIG_SCHEMA_VERSION && ConfigStore.length() == sizeof(Config))
+    {   
+        // Up to date
+    }
+    else if (version == 0)
+    {
+        eeprom_read(initNum, E_InitNum);
+        if (initNum == EEPROM_Init) MigrateLegacyEEPROM();
+        ConfigStore.save(&Config, sizeof(Config), CONFIG_SCHEMA_VERSION);
+    }
+    else
+    {   // Written by other firmware. A record of the current version but the wrong length shouldn't happen, don't trust it.
+        if (version == CONFIG_SCHEMA_VERSION || !MigrateConfig(version)) Initialize_EEPROM();
+        ConfigStore.save(&Config, sizeof(Config), CONFIG_SCHEMA_VERSION);
+    }
+    if (Config.currentScheme < 1 || Config.currentScheme > NumSchemes) Config.currentScheme = 1;
+    CurrentScheme = Config.currentScheme;
+}
+
+boolean MigrateConfig(uint8_t version)
+{   // Config holds a record written by firmware with an older (or newer) schema version, as it was loaded. Bring it up to date one version 
+    // at a time, each case falling through to the next. Return false if the version is unknown and the defaults should be used instead. 
+    // There has only been one version so far. When CONFIG_SCHEMA_VERSION goes to 2, add something like this ahead of the default: 
+    //      case 1:     move any fields that changed place, and give new fields their default
+    //                  // fall through to the case for version 2 once there is a version 3
+    //                  return true;
+    switch (version)
+    {
+        default:
+            return false;
+    }
+}
+
+void MigrateLegacyEEPROM()
+{   // Settings saved by firmware from before the config store
+    eeprom_read(Config.channel[0].pulseMin,    E_ThrottlePulseMin);
+    eeprom_read(Config.channel[0].pulseMax,    E_ThrottlePulseMax);
+    eeprom_read(Config.channel[0].pulseCenter, E_ThrottlePulseCenter);
+    eeprom_read(Config.channel[0].reversed,    E_ThrottleChannelReverse);
+    eeprom_read(Config.channel[1].pulseMin,    E_TurnPulseMin);
+    eeprom_read(Config.channel[1].pulseMax,    E_TurnPulseMax);
+    eeprom_read(Config.channel[1].pulseCenter, E_TurnPulseCenter);
+    eeprom_read(Config.channel[1].reversed,    E_TurnChannelReverse);
+    eeprom_read(Config.channel[2].pulseMin,    E_Channel3PulseMin);
+    eeprom_read(Config.channel[2].pulseMax,    E_Channel3PulseMax);
+    eeprom_read(Config.channel[2].pulseCenter, E_Channel3PulseCenter);
+    eeprom_read(Config.channel[2].reversed,    E_Channel3Reverse);
+    eeprom_read(Config.currentScheme,          E_CurrentScheme);
+}
+
+void SaveConfig()
+{   // Every save goes into a new slot, so only call this when something has actually changed. The record fits in the EEPROM write queue, 
+    // so this returns once it is queued and the writing happens in the background. 
+    PROFILE_START(PROF_EEPROM);
+    ConfigStore.save(&Config, sizeof(Config), CONFIG_SCHEMA_VERSION);
+    PROFILE_END(PROF_EEPROM);
 }
 
 void SaveScheme_To_EEPROM()
 {  // Save the current scheme to EEPROM
-    eeprom_write(CurrentScheme, E_CurrentScheme);
-    return;   
+    if (Config.currentScheme == CurrentScheme) return;
+    Config.currentScheme = CurrentScheme;
+    SaveConfig();
 }
 
+void SaveCalibration_To_EEPROM()
+{   // Save the radio calibration from RC_Channel. Radio setup calls this after each stage, a stage that didn't finish leaves the old values in RC_Channel. 
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        Config.channel[i].pulseMin    = RC_Channel[i].pulseMin;
+        Config.channel[i].pulseCenter = RC_Channel[i].pulseCenter;
+        Config.channel[i].pulseMax    = RC_Channel[i].pulseMax;
+        Config.channel[i].reversed    = RC_Channel[i].reversed;
+    }
+    SaveConfig();
+}
+
+
 
 
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
+// EEPROM SCHEME BANK - schemes uploaded over the serial port (see SCHEME_UPLOAD). Slot layout is described in OSL_Settings.h
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
+uint16_t SchemeSlotAddress(uint8_t WhatScheme)
+{   // Schemes are one-based, slots are zero-based
+    return EEPROM_SCHEME_BANK_START + ((uint16_t)(WhatScheme - 1) * EEPROM_SCHEME_SLOT_SIZE);
+}
+
+uint16_t SchemeSlotCRC(uint16_t SlotAddress, uint8_t Version)
+{   // CRC over the version byte, the light count and the settings. The version is passed in rather than read from EEPROM so we can 
+    // calculate the CRC of a slot before its version byte has been written. 
+    uint16_t crc = 0;
+    crc = _crc_xmodem_update(crc, Version);
+    crc = _crc_xmodem_update(crc, EEPROMWriter.read(SlotAddress + 1));
+    for (uint16_t i=0; i<EEPROM_SCHEME_DATA_SIZE; i++)
+    {
+        crc = _crc_xmodem_update(crc, EEPROMWriter.read(SlotAddress + EEPROM_SCHEME_HEADER_SIZE + i));
+    }
+    return crc;
+}
+
+boolean SchemeSlotValid(uint8_t WhatScheme)
+{   // A slot is only used if it was written by this version of the scheme format, for this number of lights, and the CRC checks out. 
+    // Anything else (never written, erased, written by older firmware, corrupted) and we fall back to the scheme in AA_LightSetup. 
+    uint16_t addr;
+    uint16_t crc;
+
+    if (!EnableSchemeUpload) return false;
+    if (WhatScheme < 1 || WhatScheme > EEPROM_SCHEME_SLOTS) return false;
+
+    addr = SchemeSlotAddress(WhatScheme);
+    if (EEPROMWriter.read(addr) != SCHEME_FORMAT_VERSION) return false;
+    if (EEPROMWriter.read(addr + 1) != NumLights) return false;
+    EEPROMWriter.readBlock(&crc, addr + 2, sizeof(crc));
+    return (crc == SchemeSlotCRC(addr, SCHEME_FORMAT_VERSION));
+}
+
+void EraseSchemeSlot(uint8_t WhatScheme)
+{   // Marking the version byte empty is enough, the rest of the slot is ignored from then on
+    EEPROMWriter.write(SchemeSlotAddress(WhatScheme), EEPROM_SCHEME_SLOT_EMPTY);
+}
@@ -6,24 +6,37 @@ void SetLightScheme(int WhatScheme)
 {
     int i;
     int j;
+    boolean fromEEPROM = SchemeSlotValid(WhatScheme);   // A scheme uploaded to EEPROM takes precedence over the one defined in AA_LightSetup
 
     for (i=0; i<NumLights; i++)
     {
         for (j=0; j<NumStates; j++)
         {
-            LightSettings[i][j] = pgm_read_word_near(&(Schemes[WhatScheme-1][i][j]));    // WhatScheme is minus -1 because Schemes are zero-based. We let the user use
-        }                                                                                // one-based numbers for convenience
+            LightSettings[i][j] = ReadSchemeSetting(WhatScheme, i, j, fromEEPROM);
+        }
     }
     return;
 }
 
+// Returns a single setting from either the EEPROM scheme bank or the Schemes array in program memory
+uint8_t ReadSchemeSetting(int WhatScheme, uint8_t light, uint8_t state, boolean fromEEPROM)
+{
+    if (fromEEPROM) return EEPROMWriter.read(SchemeSlotAddress(WhatScheme) + EEPROM_SCHEME_HEADER_SIZE + (light * NumStates) + state);
+#if UseCompiledSchemes
+    // Compiled schemes store each unique light row once, so first look up which row this light uses in this scheme
+    else            return pgm_read_byte_near(&(SchemeRows[pgm_read_byte_near(&(SchemeLightRows[WhatScheme-1][light]))][state]));
+#else
+    else            return pgm_read_byte_near(&(Schemes[WhatScheme-1][light][state]));     // WhatScheme is minus -1 because Schemes are zero-based. We let the user use
+#endif                                                                                      // one-based numbers for convenience
+}
+
 
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->  
 // SETLIGHTS - the main function which assigns the appropriate setting to each light based on the current actual drive mode (different from commanded drive mode)
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->  
 void SetLights(int DriveMode)
 {
-    int SaveSetting[NumLights];
+    uint8_t SaveSetting;                    // Only needed for one light at a time, so it doesn't grow with NumLights
     int j;
 
     // Loop through each light, assign the setting appropriate to its state
@@ -38,29 +51,29 @@ void SetLights(int DriveMode)
         if (shelfQueenMode == true)
         {   
             // In shelf-queen mode we only apply channel 3, and only position 1 (0)
-            SaveSetting[j] = LightSettings[j][ShelfQueenCh3Position];
+            SaveSetting = LightSettings[j][ShelfQueenCh3Position];
         }
         else
         {
             // Least important - does this light have a setting related to Channel 3? 
             // --------------------------------------------------------------------------------------------------->>
-            SaveSetting[j] = LightSettings[j][Channel3Command];
+            SaveSetting = LightSettings[j][Channel3Command];
     
             // Next - does this light have a setting related to Drive Mode? (Forward, reverse, stop)
             // --------------------------------------------------------------------------------------------------->>
             switch (DriveMode) {
                 case FWD:
-                    if (LightSettings[j][StateFwd]  != NA) { SaveSetting[j] = LightSettings[j][StateFwd]; }
+                    if (LightSettings[j][StateFwd]  != NA) { SaveSetting = LightSettings[j][StateFwd]; }
                     break;
                 case REV:
-                    if (LightSettings[j][StateRev]  != NA) { SaveSetting[j] = LightSettings[j][StateRev]; }
+                    if (LightSettings[j][StateRev]  != NA) { SaveSetting = LightSettings[j][StateRev]; }
                     break;
                 case STOP:
                     // We have two stop states: 
                     // StateStop occurs when the vehicle stops
                     // StateStopDelay occurs when the vehicle has been stopped for LongStopTime_mS and will supersede StateStop when it occurs (if not NA)
-                    if (LightSettings[j][StateStop] != NA) { SaveSetting[j] = LightSettings[j][StateStop]; }
-                    if (LightSettings[j][StateStopDelay] != NA && StoppedLongTime == true) { SaveSetting[j] = LightSettings[j][StateStopDelay]; }
+                    if (LightSettings[j][StateStop] != NA) { SaveSetting = LightSettings[j][StateStop]; }
+                    if (LightSettings[j][StateStopDelay] != NA && StoppedLongTime == true) { SaveSetting = LightSettings[j][StateStopDelay]; }
                     break;
             }
     
@@ -69,8 +82,8 @@ void SetLights(int DriveMode)
             // --------------------------------------------------------------------------------------------------->>        
             if (canBackfire)
             {
-            //  if (LightSettings[j][StateDecel] != NA) { SaveSetting[j] = BACKFIRE; } // Override setting - we assume the only setting they want during decel is BACKFIRE
-                if (LightSettings[j][StateDecel] != NA) { SaveSetting[j] = LightSettings[j][StateDecel]; } // Or we can allow any setting during deceleration
+            //  if (LightSettings[j][StateDecel] != NA) { SaveSetting = BACKFIRE; } // Override setting - we assume the only setting they want during decel is BACKFIRE
+                if (LightSettings[j][StateDecel] != NA) { SaveSetting = LightSettings[j][StateDecel]; } // Or we can allow any setting during deceleration
             }
 
     
@@ -78,7 +91,7 @@ void SetLights(int DriveMode)
             // --------------------------------------------------------------------------------------------------->>        
             if (Overtaking)
             {
-                if (LightSettings[j][StateAccel] != NA) { SaveSetting[j] = LightSettings[j][StateAccel]; } 
+                if (LightSettings[j][StateAccel] != NA) { SaveSetting = LightSettings[j][StateAccel]; } 
             }
     
             
@@ -86,7 +99,7 @@ void SetLights(int DriveMode)
             // --------------------------------------------------------------------------------------------------->>        
             if (Braking)
             {
-                if (LightSettings[j][StateBrake] != NA) { SaveSetting[j] = LightSettings[j][StateBrake]; }
+                if (LightSettings[j][StateBrake] != NA) { SaveSetting = LightSettings[j][StateBrake]; }
             }
     
             
@@ -96,67 +109,68 @@ void SetLights(int DriveMode)
             {
                 // If we have a blink command on right turn, and if we have the BlinkTurnOnlyAtStop = true, 
                 // then we only appy the turn signal if we are stopped AND if the turn signal delay has expired (TurnSignal_Enable = true)
-                if ((LightSettings[j][StateRT] == BLINK || LightSettings[j][StateRT] == SOFTBLINK) && (BlinkTurnOnlyAtStop == true))
+                if ((LightSettings[j][StateRT] == BLINK || LightSettings[j][StateRT] == SOFTBLINK) && (UserParams.blinkTurnOnlyAtStop == true))
                 {
-                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting[j] = LightSettings[j][StateRT]; }
+                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting = LightSettings[j][StateRT]; }
                 }
                 // Same as above except for all other settings under turn
                 else if (LightSettings[j][StateRT] != NA && AllTurnSettingsMatch == true )
                 {
-                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting[j] = LightSettings[j][StateRT]; }
+                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting = LightSettings[j][StateRT]; }
                 }
                 // Otherwise if it is any other setting, or if the BlinkTurnOnlyAtStop flag and the AllTurnSettingsMatch are not true, then we apply the setting normally
-                else if (LightSettings[j][StateRT] != NA) { SaveSetting[j] = LightSettings[j][StateRT]; }
+                else if (LightSettings[j][StateRT] != NA) { SaveSetting = LightSettings[j][StateRT]; }
             }
             if (TurnSignalOverride > 0) // Artificial Right Turn
             {   
                 // In this case we want to artificially create a turn signal even though the wheel may or may not be turned.
                 // We ignore driving state or TurnSignal_Enable state 
-                if (LightSettings[j][StateRT] == BLINK || LightSettings[j][StateRT] == SOFTBLINK) { SaveSetting[j] = LightSettings[j][StateRT]; }
+                if (LightSettings[j][StateRT] == BLINK || LightSettings[j][StateRT] == SOFTBLINK) { SaveSetting = LightSettings[j][StateRT]; }
                 // We may also want to artificially create any setting assigned to the turn state
-                else if (AllTurnSettingsMatch)                                                    { SaveSetting[j] = LightSettings[j][StateRT]; }
+                else if (AllTurnSettingsMatch)                                                    { SaveSetting = LightSettings[j][StateRT]; }
             }
     
             if (TurnCommand < 0 || TurnSignalOverride < 0)    // Left Turn
             {
                 // If we have a blink command on left turn, and if we have the BlinkTurnOnlyAtStop = true, 
                 // then we only appy the turn signal if we are stopped AND if the turn signal delay has expired (TurnSignal_Enable = true)
-                if ((LightSettings[j][StateLT] == BLINK || LightSettings[j][StateLT] == SOFTBLINK) && (BlinkTurnOnlyAtStop == true))
+                if ((LightSettings[j][StateLT] == BLINK || LightSettings[j][StateLT] == SOFTBLINK) && (UserParams.blinkTurnOnlyAtStop == true))
                 {
-                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting[j] = LightSettings[j][StateLT]; }
+                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting = LightSettings[j][StateLT]; }
                 }
                 // Same as above except for all other settings under turn
                 else if (LightSettings[j][StateLT] != NA && AllTurnSettingsMatch == true )
                 {
-                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting[j] = LightSettings[j][StateLT]; }
+                    if ((DriveMode == STOP) && (TurnSignal_Enable == true)) { SaveSetting = LightSettings[j][StateLT]; }
                 }
                 // Otherwise if it is any other setting, or if the BlinkTurnOnlyAtStop flag and the AllTurnSettingsMatch are not true, then we apply the setting normally
-                else if (LightSettings[j][StateLT] != NA) { SaveSetting[j] = LightSettings[j][StateLT]; }
+                else if (LightSettings[j][StateLT] != NA) { SaveSetting = LightSettings[j][StateLT]; }
             }
             if (TurnSignalOverride < 0) // Artificial Left Turn
             {
                 // In this case we want to artificially create a turn signal even though the wheel may or may not be turned.
                 // We ignore driving state or TurnSignal_Enable state 
-                if (LightSettings[j][StateLT] == BLINK || LightSettings[j][StateLT] == SOFTBLINK) { SaveSetting[j] = LightSettings[j][StateLT]; }
+                if (LightSettings[j][StateLT] == BLINK || LightSettings[j][StateLT] == SOFTBLINK) { SaveSetting = LightSettings[j][StateLT]; }
                 // We may also want to artificially create any setting assigned to the turn state
-                else if (AllTurnSettingsMatch)                                                    { SaveSetting[j] = LightSettings[j][StateLT]; }
+                else if (AllTurnSettingsMatch)                                                    { SaveSetting = LightSettings[j][StateLT]; }
             }
     
             if (TurnCommand == 0)       // No turn
             {
-                if (LightSettings[j][StateNT] != NA) { SaveSetting[j] = LightSettings[j][StateNT]; }               
+                if (LightSettings[j][StateNT] != NA) { SaveSetting = LightSettings[j][StateNT]; }               
             }
         }
         
 
-        // Light "j" now has a single setting = SaveSetting[j]
+        // Light "j" now has a single setting = SaveSetting
         // --------------------------------------------------------------------------------------------------->>          
         // We call the function that will set this light to that setting
-        if (CurrentLightSetting[j] != SaveSetting[j])   // But only update the setting if it is different from the current setting
+        if (CurrentLightSetting[j] != SaveSetting)   // But only update the setting if it is different from the current setting
         {   
-            CurrentLightSetting[j] = SaveSetting[j]; 
-            SetLight(j, SaveSetting[j]);
-            if (DEBUG) PrintLightSetting(j, CurrentLightSetting[j]);
+            CurrentLightSetting[j] = SaveSetting; 
+            SetLight(j, SaveSetting);
+            TRACE_EVENT(TRACE_LIGHT_SETTING, j, SaveSetting);
+            if (DEBUG) QueueDebugMessage(DBG_LIGHT_SETTING, j, CurrentLightSetting[j]);
         }
     }
 }
@@ -178,35 +192,35 @@ void SetLight(int WhatLight, int WhatSetting)
             break;
         
         case FADEOFF:
-            LightOutput[WhatLight].Fade(FADE_OUT, FadeOutTime);
+            LightOutput[WhatLight].Fade(FADE_OUT, UserParams.fadeOutTime);
             break;         
 
         case FADEON:
-            LightOutput[WhatLight].Fade(FADE_IN, FadeInTime, FADE_TYPE_SINE);   // We don't usually use the sine wave fade but for fading-in it looks better than exponential. 
+            LightOutput[WhatLight].Fade(FADE_IN, UserParams.fadeInTime, FADE_TYPE_SINE);   // We don't usually use the sine wave fade but for fading-in it looks better than exponential. 
             break;       
             
         case BLINK:
-            LightOutput[WhatLight].startBlinking(BlinkInterval, BlinkInterval, false);
+            LightOutput[WhatLight].startBlinking(UserParams.blinkInterval, UserParams.blinkInterval, false);
             break;
 
         case BLINK_ALT:
-            LightOutput[WhatLight].startBlinking(BlinkInterval, BlinkInterval, true);
+            LightOutput[WhatLight].startBlinking(UserParams.blinkInterval, UserParams.blinkInterval, true);
             break;            
             
         case FASTBLINK:
-            LightOutput[WhatLight].startBlinking(FastBlinkInterval, FastBlinkInterval, false);
+            LightOutput[WhatLight].startBlinking(UserParams.fastBlinkInterval, UserParams.fastBlinkInterval, false);
             break;
                                 
         case FASTBLINK_ALT:
-            LightOutput[WhatLight].startBlinking(FastBlinkInterval, FastBlinkInterval, true);
+            LightOutput[WhatLight].startBlinking(UserParams.fastBlinkInterval, UserParams.fastBlinkInterval, true);
             break;
             
         case SAFETYBLINK:       
-            LightOutput[WhatLight].SafetyBlink(SafetyBlinkRate, SafetyBlinkCount, SafetyBlink_Pause, false);
+            LightOutput[WhatLight].SafetyBlink(UserParams.safetyBlinkRate, UserParams.safetyBlinkCount, UserParams.safetyBlinkPause, false);
             break;
 
         case SAFETYBLINK_ALT:
-            LightOutput[WhatLight].SafetyBlink(SafetyBlinkRate, SafetyBlinkCount, SafetyBlink_Pause, true);
+            LightOutput[WhatLight].SafetyBlink(UserParams.safetyBlinkRate, UserParams.safetyBlinkCount, UserParams.safetyBlinkPause, true);
             break;
         
         case SOFTBLINK:
@@ -214,7 +228,7 @@ void SetLight(int WhatLight, int WhatSetting)
             break;
        
         case DIM:
-            LightOutput[WhatLight].dim(DimLevel);
+            LightOutput[WhatLight].dim(UserParams.dimLevel);
             break;
 
         case XENON:
@@ -241,29 +255,7 @@ void BackfireOff()
     // Time up - stop backfire effect
     canBackfire = false;
     // Reset the random backfire timeout for the next event
-    backfire_timeout = random(BF_Time_Short, BF_Time_Long);
-}
-
-
-// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
-// OVERTAKEOFF - Overtaking time is up
-// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
-void OvertakeOff()
-{
-    // Time up - stop the overtake effects
-    Overtaking = false;
-}
-
-
-// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
-// TURN SIGNAL - Artificial turn signal cancel
-// ------------------------------------------------------------------------------------------------------------------------------------------------------->  
-// If TurnSignalOverride is not zero, then it acts as an artificial turn signal command, keeping the turn signals on even after the car has begun
-// to move forward. But it only does so for a brief period of time (set by the user in TurnFromStartContinue_mS in UserConfig.h). When that time
-// runs out this function is called which sets TurnSignalOverride back to 0. 
-void ClearBlinkerOverride(void)
-{
-    TurnSignalOverride = 0;
+    backfire_timeout = random(UserParams.bfTimeShort, UserParams.bfTimeLong);
 }
 
 
@@ -273,11 +265,11 @@ void ClearBlinkerOverride(void)
 void TwinkleLights(int mS)
 {
     // Start rapid blinking
-    GreenLED.startBlinking(FastBlinkInterval, FastBlinkInterval);
-    RedLED.startBlinking(FastBlinkInterval, FastBlinkInterval);
+    GreenLED.startBlinking(UserParams.fastBlinkInterval, UserParams.fastBlinkInterval);
+    RedLED.startBlinking(UserParams.fastBlinkInterval, UserParams.fastBlinkInterval);
     for (int i=0; i<NumLights; i++)
     {    
-        LightOutput[i].startBlinking(FastBlinkInterval, FastBlinkInterval);
+        LightOutput[i].startBlinking(UserParams.fastBlinkInterval, UserParams.fastBlinkInterval);
     }
 
     // Wait desired seconds
@@ -311,7 +303,7 @@ void BlinkAllLights(int HowManyTimes)
                 {   LightOutput[j].on(); } 
                 CSM_PriorState = true;
                 CSM_TimesBlinked += 1;
-                timer.setTimeout(130, BlinkOn);
+                timer.setTimeout(130, CSM_BlinkTimeUp, (void *)false);     // Next blink phase is off
             }
         }
         else
@@ -324,38 +316,25 @@ void BlinkAllLights(int HowManyTimes)
                 for (int j=0; j<NumLights; j++)
                 {   LightOutput[j].off(); }
                 CSM_PriorState = false;
-                CSM_BlinkOffTimerID = timer.setTimeout(160, BlinkOff);
+                CSM_BlinkOffTimerID = timer.setTimeout(160, CSM_BlinkTimeUp, (void *)true);
             }
 
             if (CSM_TimesBlinked >= HowManyTimes)
             {   CSM_TimesBlinked = 0;
                 CSM_Blinking = false;
-                timer.setTimeout(1000, BlinkWait);
+                timer.setTimeout(1000, CSM_BlinkTimeUp, (void *)true);    // Pause, then start the next series of blinks
                 timer.deleteTimer(CSM_BlinkOffTimerID);
             }
         }
     }
 }
 
-void BlinkOn()
-{
-    CSM_Blinking = true;
-    CSM_State = false;
-    CSM_PriorState = true;
-}
-
-void BlinkOff()
-{
-    CSM_Blinking = true;
-    CSM_State = true;
-    CSM_PriorState = false;
-}
-
-void BlinkWait()
+// The timer parameter carries the next blink state directly, true for on and false for off
+void CSM_BlinkTimeUp(void *nextState)
 {
     CSM_Blinking = true;
-    CSM_State = true;
-    CSM_PriorState = false;
+    CSM_State = (nextState != NULL);
+    CSM_PriorState = !CSM_State;
 }
 
 
@@ -21,10 +21,23 @@
     #include "AA_UserConfig.h"
     #include "src/OSL_Settings/OSL_Settings.h"
     #include "src/elapsedMillis/elapsedMillis.h"
-    #include "src/OSL_Button/OSL_Button.h"  // By JChristensen. See: https://github.com/JChristensen/Button Renamed from Button to OSL_Button so it won't conflict with other button libraries. 
+    #include "src/OSL_ButtonEvents/OSL_ButtonEvents.h"        // Creates the InputButton object, read from the Timer2 interrupt
     #include "src/OSL_LedHandler/OSL_LedHandler.h"
+    #include "src/OSL_ShiftOutput/OSL_ShiftOutput.h"          // Creates the ShiftOutput object, only started if ShiftRegisters is more than 0 in AA_UserConfig.h
+    #include "src/OSL_PixelOutput/OSL_PixelOutput.h"          // Creates the PixelOutput object, only started if PixelCount is more than 0 in AA_UserConfig.h
     #include "src/OSL_SimpleTimer/OSL_SimpleTimer.h"
+    #include "src/OSL_Scheduler/OSL_Scheduler.h"
+    #include "src/OSL_DriveMode/OSL_DriveMode.h"
+    #include "src/OSL_EEPROMWriter/OSL_EEPROMWriter.h"
+    #include "src/OSL_ConfigStore/OSL_ConfigStore.h"
     #include "src/OSL_PinChangeInterrupt/PinChangeInterrupt.h"
+    #include "src/OSL_PinChangeDispatch/OSL_PinChangeDispatch.h"  // Used for the RC inputs if PCINT_TEMPLATE_DISPATCH is true (see OSL_Settings.h)
+    #include "src/OSL_Profiler/OSL_Profiler.h"                // Only compiled if PROFILER is set to true in AA_UserConfig.h
+    #include "src/OSL_Trace/OSL_Trace.h"                      // Only compiled if TRACE is set to true in AA_UserConfig.h
+    #include "src/OSL_Telemetry/OSL_Telemetry.h"
+    #include "src/OSL_SyncLink/OSL_SyncLink.h"
+    #include <util/crc16.h>
+    #include <avr/sleep.h>
 
    
 // ====================================================================================================================================================>
@@ -44,17 +57,74 @@
         OSL_LedHandler                   RedLED;
         OSL_LedHandler                 GreenLED;
         OSL_LedHandler   LightOutput[NumLights];                // LED handler for each output (NUM_LIGHT_OUTPUTS is defined in OSL_Settings.h)
-        OSL_Button                  InputButton;                // Button object, will get set later in Setup() when we know what hardware version we are running on.
+        OSL_DriveMode                     Drive;                // Drive mode state machine, works out the drive mode, braking, etc. from the throttle command
 
     // Simple Timer
     // ------------------------------------------------------------------------------------------------------------------------------------------------>
         OSL_SimpleTimer                   timer;                // Instantiate a SimpleTimer named "timer"
         boolean TimeUp                   = true;
 
+    // Radio Setup
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        boolean RadioSetupActive         = false;               // Set to start a radio setup, cleared by the setup task when it's done (see the RADIO_SETUP tab)
+        struct _pulse_stats {                                   // Readings taken during setup, one per channel. Sums are kept relative to the first reading so they stay small.
+            uint16_t count;
+            int16_t  first;
+            int32_t  sum;
+            uint32_t sumSquares;
+            int16_t  minimum;
+            int16_t  maximum;
+        };
+        _pulse_stats SetupStats[NUM_RC_CHANNELS];
+
+    // Multi-Board Sync
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        uint8_t SyncDriveMode           = STOP;                 // On a follower, the drive mode last sent by the master (see the SYNC tab)
+
+    // Auto Calibration
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        struct _autocal {                                       // What has been learned about each channel since the last update (see the AUTOCAL tab)
+            int16_t  lastPulse;                                 // The pulse before this one
+            int16_t  learnedMin;                                // Lowest and highest pulses reached, shrinking slowly
+            int16_t  learnedMax;
+            uint32_t centerSum;                                 // Sum and count of pulses with the stick resting near center
+            uint8_t  centerCount;
+        };
+        _autocal AutoCal[NUM_RC_CHANNELS];
+
+    // Debug Messages
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        struct _debug_message {                                 // Debug messages waiting to be printed, see the DEBUG_QUEUE tab
+            uint8_t type;
+            uint8_t arg;
+            int16_t value;
+        };
+        _debug_message DebugQueue[DEBUG_QUEUE_LENGTH];
+        uint8_t DebugQueueHead              = 0;                // Oldest message
+        uint8_t DebugQueueCount             = 0;                // How many are waiting
+        uint8_t DebugQueueDropped           = 0;                // How many were thrown away because the queue was full
+
+    // Task Scheduler
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        OSL_Scheduler                 Scheduler;                // Runs each of the tasks on the TASKS tab at its own rate
+
     // EEPROM
     // ------------------------------------------------------------------------------------------------------------------------------------------------>
-        const long EEPROM_Init         = 0xDF03;                // Change this any time the EEPROM content changes
-        struct __eeprom_data {                                  // __eeprom_data is the structure that maps all of the data we are storing in EEPROM
+        struct _channel_config {
+            int16_t pulseMin;
+            int16_t pulseCenter;
+            int16_t pulseMax;
+            boolean reversed;
+        };
+        struct _config {                                        // Everything kept in the config store (see the EEPROM tab). If you change this, also change CONFIG_SCHEMA_VERSION
+            _channel_config channel[NUM_RC_CHANNELS];           // in OSL_Settings.h and add a migration from the old layout to MigrateConfig().
+            uint8_t currentScheme;
+        };
+        _config Config;                                         // Working copy in RAM
+        OSL_ConfigStore ConfigStore;                            // Saves it to EEPROM
+
+        const long EEPROM_Init         = 0xDF03;                // Older firmware kept its settings in the __eeprom_data struct at address 0, marked valid by this number.
+        struct __eeprom_data {                                  // It is only read now, once, to carry the radio calibration over to the config store. 
           long E_InitNum;                                       // Number that indicates if EEPROM values have ever been initialized 
           int16_t E_ThrottlePulseMin;
           int16_t E_ThrottlePulseMax;
@@ -71,6 +141,34 @@
           uint8_t E_CurrentScheme;
         };
 
+    // User parameters
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        struct _user_params {                                   // Working copy of the AA_UserConfig.h settings that can be changed from the serial console (see the CONSOLE tab). 
+            uint8_t  throttleDeadband;                          // The order and types here are what gets saved to EEPROM, if you change them also change 
+            uint8_t  turnDeadband;                              // PARAMS_FORMAT_VERSION in OSL_Settings.h and the table on the CONSOLE tab
+            uint8_t  smoothing;
+            uint8_t  doubleTapReverse;
+            uint32_t longStopTime;
+            uint8_t  brakeAtThrottlePctBelow;
+            uint8_t  blinkTurnOnlyAtStop;
+            uint16_t turnSignalDelay;
+            uint16_t turnFromStartContinue;
+            uint8_t  accelPct;
+            uint16_t overtakeTime;
+            uint8_t  decelPct;
+            uint16_t bfTimeShort;
+            uint16_t bfTimeLong;
+            uint16_t blinkInterval;
+            uint16_t fastBlinkInterval;
+            uint8_t  dimLevel;
+            uint16_t fadeOutTime;
+            uint16_t fadeInTime;
+            uint16_t safetyBlinkRate;
+            uint8_t  safetyBlinkCount;
+            uint16_t safetyBlinkPause;
+        };
+        _user_params UserParams;
+
     // RC Channel defines
     // -------------------------------------------------------------------------------------------------------------------------------------------------->            
         struct _rc_channel {
@@ -105,8 +203,7 @@
         int8_t ThrottleCommand              = 0;                // Discrete variables are also useful, we will map these to the correct channel inputs in ProcessRCCommand()
         int8_t TurnCommand                  = 0;
         uint8_t Channel3Command             = 0;                        
-        int8_t ThrottleCommand_Previous     = 0;                // We keep a second set so we can compare and determine when a command has changed
-        uint8_t Channel3Command_Previous    = 0;
+        uint8_t Channel3Command_Previous    = 0;                // We keep a second set so we can compare and determine when a command has changed
         int8_t TurnCommand_Previous         = 0;
 
     // Driving
@@ -176,17 +273,14 @@ void setup()
 
     // Load values from EEPROM  
     // ------------------------------------------------------------------------------------------------------------------------------------------------>
-        long Temp;
-        eeprom_read(Temp, E_InitNum);                           // Get our EEPROM Initialization value
-        if(Temp != EEPROM_Init)                                 // If EEPROM has never been initialized before, do so now
-        {    Initialize_EEPROM();  }
-        else
-        {    Load_EEPROM();        }                            // Otherwise, load the values from EEPROM. Note this is only for non-channel values, 
-                                                                // channel-EEPROM values will get assigned below in InitializeRCChannels();
+        Load_EEPROM();                                          // Radio calibration and scheme from the config store. The channel values get assigned 
+                                                                // below in InitializeRCChannels();
+        LoadUserParams();                                       // Settings that can be changed from the serial console, saved values if there are any (see the CONSOLE tab)
     // RC Inputs
     // -------------------------------------------------------------------------------------------------------------------------------------------------->        
         InitializeRCChannels();                                 // Initialize/clear RC channels
-        EnableRCInterrupts();                                   // Start checking the RC pins for a signal
+        InitAutoCalibration();                                  // Start learning from the calibration we just loaded (see the AUTOCAL tab)
+        if (SyncRole != SYNC_FOLLOWER) EnableRCInterrupts();    // Start checking the RC pins for a signal. A follower gets everything from the master instead.
 
     // Initialize lights
     // ------------------------------------------------------------------------------------------------------------------------------------------------>
@@ -198,7 +292,7 @@ void setup()
         // random value each time a deceleration event occurs, but we need to initialize it for the first event. 
         if (HardwareVersion == 2) randomSeed(analogRead(pin_HW2_SetupButton));    // When the button is not pressed, this input is left floating, meaning the value could be anything, which is what we want for randomSeed
         else                      randomSeed(analogRead(pin_HW1_SetupButton));
-        backfire_timeout  = random(BF_Time_Short, BF_Time_Long);
+        backfire_timeout  = random(UserParams.bfTimeShort, UserParams.bfTimeLong);
 
     // Setup light objects
     // -------------------------------------------------------------------------------------------------------------------------------------------------->        
@@ -214,7 +308,7 @@ void setup()
             LightOutput[5].begin(pin_HW1_Light6, false, true);
             LightOutput[6].begin(pin_HW1_Light7, false, false);         // Outputs 7 & 8 are not PWM-able
             LightOutput[7].begin(pin_HW1_Light8, false, false);
-            InputButton.begin(pin_HW1_SetupButton, true, true, 25);     // Initialize a button object. Set pin, internal pullup = true, inverted = true, debounce time = 25 mS
+            InputButton.begin(pin_HW1_SetupButton, true, true);         // Start reading the button. Set pin, internal pullup = true, inverted = true (debounce time is BUTTON_DEBOUNCE_MS)
         }
         else if (HardwareVersion == 2)
         {
@@ -228,8 +322,18 @@ void setup()
             LightOutput[5].begin(pin_HW2_Light6, false, true);
             LightOutput[6].begin(pin_HW2_Light7, false, false);         // Outputs 7 & 8 are not PWM-able
             LightOutput[7].begin(pin_HW2_Light8, false, false);
-            InputButton.begin(pin_HW2_SetupButton, true, true, 25);     // Initialize a button object. Set pin, internal pullup = true, inverted = true, debounce time = 25 mS
+            InputButton.begin(pin_HW2_SetupButton, true, true);         // Start reading the button. Set pin, internal pullup = true, inverted = true (debounce time is BUTTON_DEBOUNCE_MS)
         }        
+        // Lights 9 and up are on shift registers. Their interrupt takes over Timer1, so it also dims lights 1 and 2 in place of their hardware PWM.
+        if (ShiftRegisters > 0)
+        {
+            if (ShiftOutput.begin(pin_ShiftData, pin_ShiftClock, pin_ShiftLatch, ShiftRegisters))
+            {
+                LightOutput[0].begin(ShiftOutput, ShiftOutput.addPin(HardwareVersion == 2 ? pin_HW2_Light1 : pin_HW1_Light1));
+                LightOutput[1].begin(ShiftOutput, ShiftOutput.addPin(HardwareVersion == 2 ? pin_HW2_Light2 : pin_HW1_Light2));
+            }
+            for (uint8_t i=8; i<NumLights; i++) LightOutput[i].begin(ShiftOutput, i - 8);    // If the registers didn't start (see the pin notes in OSL_Settings.h) these do nothing
+        }
         // Start lights in the off state
         RedLED.off();
         GreenLED.off();
@@ -238,6 +342,11 @@ void setup()
             LightOutput[i].off();
             CurrentLightSetting[i] = LS_UNKNOWN;
         }
+        if (PixelCount > 0) InitPixels();                       // Addressable pixels, all off to start (see the PIXELS tab)
+
+    // Start the tasks
+    // -------------------------------------------------------------------------------------------------------------------------------------------------->        
+        StartTasks();
 }
 
 
@@ -246,6 +355,21 @@ void setup()
 //  MAIN LOOP
 // ====================================================================================================================================================>
 void loop()
+{
+    // Everything is done by tasks that the scheduler runs at fixed rates (see the TASKS tab and TASK SCHEDULER in OSL_Settings.h). 
+    // The vehicle logic that used to make up the body of this loop is now VehicleLogic() below, which runs 100 times a second.
+        PerLoopUpdates();
+
+    // If nothing is due for a while, let the processor sleep until it is (only if EnableIdleSleep is set in AA_UserConfig.h)
+        IdleUntilNextEvent();
+}
+
+
+
+// ====================================================================================================================================================>
+//  VEHICLE LOGIC
+// ====================================================================================================================================================>
+void VehicleLogic()
 {
     // Main loop local variables
     // ------------------------------------------------------------------------------------------------------------------------------------------------>    
@@ -256,15 +380,8 @@ void loop()
     static uint8_t DriveModeCommand_Previous = STOP;            // There is no "previous" command when we first start. Initialize to STOP
     static uint8_t DriveMode_LastDirection = STOP;
 
-
-    // Driving
-    static boolean canBrake             = false;                // If BrakeAtThrottlePctBelow > 0 (in AA_UserConfig) we may set the brake flag even when moving in forward or reverse
-    static uint32_t TimeStopped;                                // When did we stop - will be used to initiate a delay after stopping before turn signals can be used, or when stop-delay light settings can take effect.
-    static uint32_t StopCMDLength;                              // Counter to determine how long we have been commanding Stop.
-    static uint32_t Last_FWD_Time;                              // Keep track of how recently we were in forward. This will help us know whether to enter the Brake state or not. NOTE: The brake state
-                                                                // will only ever apply if DoubeTapReverse = true. For crawler type ESCs that can go directly into reverse from forward, the only way to get
-                                                                // the brake lights to turn on is to set them to the Stop state. 
-    static uint8_t ReverseTaps              = 0;                // How many times have we gone into reverse - used for ESCs that require tapping reverse twice before the car will move in reverse
+    // Setup button
+    static uint8_t ButtonEvent           = BUTTON_NONE;         // The event taken from the button's queue this pass
 
 
     // Scheme change variables
@@ -291,6 +408,8 @@ void loop()
     // Temp vars
     static unsigned long currentMillis;        
     static boolean WhatState = true;
+
+    PROFILE_START(PROF_LOOP);                                   // Does nothing unless PROFILER is set to true in AA_UserConfig.h
    
 
     // STARTUP - RUN ONCE
@@ -322,6 +441,7 @@ void loop()
                     currentMillis = millis();                   // Save the time
                     do {
                         PerLoopUpdates();
+                        IdleUntilNextEvent();
                     } while (((millis() - currentMillis) < sq_delay) && RC_State == RC_SIGNAL_UNINITIALIZED); 
                 }
 
@@ -357,6 +477,7 @@ void loop()
                     // Keep polling the radio
                     do{
                         PerLoopUpdates();
+                        IdleUntilNextEvent();                   // Nothing else going on, sleep until there is
                     } while (RC_State == RC_SIGNAL_UNINITIALIZED);
     
                     // If we make it to here, a radio signal has been detected.
@@ -385,7 +506,7 @@ void loop()
 
         currentMillis = millis();                               // Initializing some variables 
         TransitionStart = currentMillis;  
-        TimeStopped = currentMillis;
+        InitializeDriveMode(currentMillis);                     // Start the drive mode state machine, stopped
         TurnSignal_Enable = false;
         StoppedLongTime = false;
         
@@ -398,12 +519,12 @@ void loop()
    }
 
 
-// ETERNAL LOOP
+// EVERY 10 mS
 // ------------------------------------------------------------------------------------------------------------------------------------------------>    
-
-    // Per loop updates - things that need to be polled
-        PerLoopUpdates();
-
+    // RC pulses, the lights and the timer are all handled by their own tasks, which the scheduler has already run this pass.
+    // The button is read in the background too, we take one event per pass (see SETUP BUTTON in OSL_Settings.h). Events that arrive without a 
+    // radio signal are thrown away. 
+    ButtonEvent = InputButton.getEvent();
 
     // Everything from here on, we only run if we are receiving valid radio commands
     if (Failsafe == false)
@@ -411,10 +532,27 @@ void loop()
         
     // USER WANTS TO RUN SETUPS
     // -------------------------------------------------------------------------------------------------------------------------------------------------->
-        if (InputButton.pressedFor(2000))    
+        if (ButtonEvent == BUTTON_LONG_PRESS && !RadioSetupActive)
+        {
+            // User has held down the input button for two seconds. We are going to enter the radio setup routine, which runs as its own task. 
+            RadioSetupActive = true;
+        }
+        if (RadioSetupActive)                                   // The setup has the sticks and the onboard LEDs until it's done
+        {
+            PROFILE_END(PROF_LOOP);
+            return;
+        }
+
+    // USER WANTS TO CHANGE SCHEMES
+    // -------------------------------------------------------------------------------------------------------------------------------------------------->
+        // A click on the button selects the next scheme, a double click the one before. Unlike Change-Scheme-Mode, the new scheme is used straight away.
+        if ((ButtonEvent == BUTTON_CLICK || ButtonEvent == BUTTON_DOUBLE_CLICK) && !ChangeSchemeMode)
         {
-            // User has held down the input button for two seconds. We are going to enter the radio setup routine. 
-            RadioSetup(); 
+            if (ButtonEvent == BUTTON_CLICK) { CurrentScheme += 1; if (CurrentScheme > NumSchemes) CurrentScheme = 1; }
+            else                             { CurrentScheme -= 1; if (CurrentScheme < 1) CurrentScheme = NumSchemes; }
+            if (DEBUG) QueueDebugMessage(DBG_SCHEME_SELECTED, CurrentScheme, 0);
+            SetLightScheme(CurrentScheme);
+            SaveScheme_To_EEPROM();
         }
 
     
@@ -469,11 +607,7 @@ void loop()
         // If no control movements are made for 20 seconds, the program will automatically exit Change-Scheme-Mode
         if (ChangeSchemeMode)
         {
-            Serial.println();
-            PrintLine(80);
-            Serial.println(F("ENTERING CHANGE-SCHEME MODE")); 
-            PrintLine(80);
-            Serial.print(F("Current Scheme: ")); Serial.println(CurrentScheme);
+            if (DEBUG) QueueDebugMessage(DBG_CHANGE_SCHEME_MODE, CurrentScheme, 1);
             TwinkleLights(2000);
             CSM_TimesBlinked = 0;
             CSM_Blinking = true;
@@ -513,12 +647,12 @@ void loop()
                         {   if (TurnCommand > 0) 
                             {   CurrentScheme += 1;
                                 if (CurrentScheme > NumSchemes) { CurrentScheme = 1; }
-                                Serial.print(F("Scheme changed to: ")); Serial.println(CurrentScheme);
+                                if (DEBUG) QueueDebugMessage(DBG_SCHEME_SELECTED, CurrentScheme, 0);
                             }
                             else if (TurnCommand < 0)
                             {   CurrentScheme -= 1;
                                 if (CurrentScheme < 1) { CurrentScheme = NumSchemes; }
-                                Serial.print(F("Scheme changed to: ")); Serial.println(CurrentScheme);
+                                if (DEBUG) QueueDebugMessage(DBG_SCHEME_SELECTED, CurrentScheme, 0);
                             }
                             TransitionStart = millis();                       // Force them to wait a bit before changing the scheme again
                         }
@@ -547,10 +681,7 @@ void loop()
                 }
             }
             while (ChangeSchemeMode);
-            PrintLine(80);
-            Serial.print(F("EXIT CHANGE-SCHEME MODE IN SCHEME: ")); Serial.println(CurrentScheme);
-            PrintLine(80);
-            Serial.println();
+            if (DEBUG) QueueDebugMessage(DBG_CHANGE_SCHEME_MODE, CurrentScheme, 0);
             TwinkleLights(2000);
             SetLightScheme(CurrentScheme);  // Change the scheme
             SaveScheme_To_EEPROM();      // Save the selection to EEPROM
@@ -558,180 +689,49 @@ void loop()
         }
 
 
-    // CALCULATE DRIVE MODE FROM COMMAND - The command and mode are not always the same, if DoubleTapReverse = true
+    // FOLLOWER BOARDS
     // ------------------------------------------------------------------------------------------------------------------------------------------------>
-        DriveModeCommand = ReturnDriveMode(ThrottleCommand);    // Figure out what Drive Mode the receiver is indicating
-
-        switch (DriveModeCommand)
+        // A follower doesn't read the radio. The drive mode, turn signals and everything else SetLights needs come from the master (see the SYNC tab). 
+        if (SyncRole == SYNC_FOLLOWER)
         {
-            case FWD:                                           
-                DriveMode = FWD;                                // Pretty much all ESCs allow us to go directly into forward
-                ReverseTaps = 0;                                // Reset reverse taps
-                StoppedLongTime = false;                        // Reset the StoppedLongTime flag because we are no longer stopped
-                Last_FWD_Time = millis();                       // Keep track of the most current time we are commanding forward, this will be used to set the brake lights if DoubleTapReverse = true
-                canChangeScheme = false;                        // Also reset the canChangeScheme flag, we don't want to enter ChangeScheme mode while moving forward
-                if (BrakeAtThrottlePctBelow > 0 && canBrake == false && ThrottleCommand > BrakeAtThrottlePctBelow)
-                {   
-                    Braking = false;                            // Since we are above the threshold, we are not now braking
-                    canBrake = true;                            // But as we've exceeded the threshold, we can enable braking so that if we fall back below it the brake State can activate
-                }
-                
-                if (BrakeAtThrottlePctBelow > 0 && canBrake == true && ThrottleCommand <= BrakeAtThrottlePctBelow)
-                {
-                    Braking = true;                             // We are below the threshold, so we can activate the Braking state
-                    canBrake = false;                           // But we also reset the canBrake flag, so if we go back over the threshold the Brake state will be disactivated
-                }
-                break;
-
-            case REV:
-                if (DoubleTapReverse)
-                {   // Here we have just started commanding reverse from something else. Start counting taps. 
-                    if (DriveModeCommand_Previous != REV)
-                    {
-                        ReverseTaps +=1;
-
-                        if (ReverseTaps >= 2)
-                        {
-                            ReverseTaps = 2;
-                            DriveMode = REV;
-                            StoppedLongTime = false;            // Rset the StoppedLongTime flag because we are no longer stopped
-                            canChangeScheme = false;            // Also reset the canChangeScheme flag, we don't want to enter ChangeScheme mode while moving forward
-                        }
-                        else
-                        {
-                            if (millis() - Last_FWD_Time < FWD_to_REV_BrakeTime)  // FWD_to_REV_BrakeTime is defined in OSL_Settings.h
-                            { 
-                                DriveMode = STOP;               // A reverse command here, if it is only the first tap, is counted as a DriveMode = STOP
-                                Braking = true;                 // But also, it is counted as braking
-                            }
-                        }                        
-                    }
-
-                    // Here we are actually in reverse, not just commanding it
-                    if (DriveMode == REV)
-                    {   
-                        if (BrakeAtThrottlePctBelow > 0 && canBrake == false && abs(ThrottleCommand) > BrakeAtThrottlePctBelow)
-                        {   
-                            Braking = false;                            // Since we are above the threshold, we are not now braking
-                            canBrake = true;                            // But as we've exceeded the threshold, we can enable braking so that if we fall back below it the brake State can activate
-                        }
-                        
-                        if (BrakeAtThrottlePctBelow > 0 && canBrake == true && abs(ThrottleCommand) <= BrakeAtThrottlePctBelow)
-                        {   
-                            Braking = true;                             // We are below the threshold, so we can activate the Braking state
-                            canBrake = false;                           // But we also reset the canBrake flag, so if we go back over the threshold the Brake state will be disactivated
-                        }                        
-                    }
-                }
-                else
-                {
-                    DriveMode = REV;
-                    StoppedLongTime = false;                    // Reset the StoppedLongTime flag because we are no longer stopped
-                    canChangeScheme = false;                    // Also reset the canChangeScheme flag, we don't want to enter ChangeScheme mode while moving forward
-                    if (BrakeAtThrottlePctBelow > 0 && canBrake == false && abs(ThrottleCommand) > BrakeAtThrottlePctBelow)
-                    {   
-                        Braking = false;                            // Since we are above the threshold, we are not now braking
-                        canBrake = true;                            // But as we've exceeded the threshold, we can enable braking so that if we fall back below it the brake State can activate
-                    }
-                    
-                    if (BrakeAtThrottlePctBelow > 0 && canBrake == true && abs(ThrottleCommand) <= BrakeAtThrottlePctBelow)
-                    {
-                        Braking = true;                             // We are below the threshold, so we can activate the Braking state
-                        canBrake = false;                           // But we also reset the canBrake flag, so if we go back over the threshold the Brake state will be disactivated
-                    }              
-                }
-                break;
-
-            case STOP:
-                if (DriveModeCommand_Previous != STOP)
-                {   //Previously we were commanding something else, meaning we have just started the stop. 
-                    // This tells us we need to start the stop time counter
-                    StopCMDLength = millis();
-                    // We also reset the braking flag
-                    Braking = false;
-                    canBrake = false;
-                }
-                DriveMode = STOP;
-                break;
-                
-        }
-
-
-    // NOW WE KNOW OUR ACTUAL DRIVE MODE - TAKE CARE OF TURN SIGNALS AND STOP LENGTH
-    // ------------------------------------------------------------------------------------------------------------------------------------------------>        
-        switch (DriveMode)
-        {
-            case FWD: 
-            case REV:
-                if (DriveMode_Previous != DriveMode)
-                {   // We've just started moving forwards or backwards. 
-                    // Should we leave the turn signal on even though we're now moving forward? 
-                    // TurnCommand != 0                 The wheels must be turned   
-                    // TurnFromStartContinue_mS > 0     User must have enabled this setting
-                    // BlinkTurnOnlyAtStop = true       This must be true, otherwise we just allow blinking all the time, so none of this is necessary
-                    // TurnSignal_Enable = true         This means the car has already been stopped for some length of time
-                    if (TurnCommand != 0 && TurnFromStartContinue_mS > 0 && BlinkTurnOnlyAtStop && TurnSignal_Enable) 
-                    {
-                        // In this case we have just begun starting to move, and our wheels are turned at the same time. 
-                        // We will keep the turn signals on for a brief period after starting, as set by TurnFromStartContinue_mS
-                        TurnSignalOverride = TurnCommand;                                 // TurnSignalOverride saves the turn direction, and will act as a fake turn command in the SetLights function
-                        timer.setTimeout(TurnFromStartContinue_mS, ClearBlinkerOverride); // ClearBlinkerOverride will set TurnSignalOverride back to 0 when the timer is up. 
-                    }
-                }   
-                break;
-
-            case STOP:
-                // Turn signal timer - start the timer when the car first comes to a stop. 
-                if (DriveMode_Previous != STOP)
-                {   // The car has only just now come to a stop. We begin a timer. Not until this timer runs out will a turn command (while still stopped)
-                    // actually engage the turn signal lights (if we are stills stopped when the timer expires). 
-                    // This is only if the user has specified BlinkTurnOnlyAtStop = true. 
-                    TurnSignal_Enable = false;
-                    TimeStopped = millis();
-                    // We use this same timer to delay the option of entering ChangeScheme mode
-                    canChangeScheme = false;
-                }
-                else 
-                {   // We have been stopped already. Check to see if the turn signal signal timer is up - if so, we will permit a turn command 
-                    // to engage the turn signal lights. This is only if the user has specified BlinkTurnOnlyAtStop = true. 
-                    if (TurnSignalDelay_mS > 0 && ((millis() - TimeStopped) >= TurnSignalDelay_mS))
-                    {
-                        TurnSignal_Enable = true;
-                    }        
-
-                    // We have been stopped already. Check to see if enough time has passed to enable entry into Change-Scheme-Mode, if the user desires
-                    if (millis() - TimeStopped >= CSM_StopDelay_mS)
-                    {
-                        canChangeScheme = true;                        
-                    }
-                    
-                    // Check to see if we have been stopped a "long" time, this will enable stop-delay effects
-                    if ((millis() - TimeStopped) >= LongStopTime_mS)
-                    {
-                        StoppedLongTime = true;
-                    }
-                    
-                    // If we are stopped and have been stopped, we are also no longer decelerating, so reset these flags.
-                    Decelerating = false;
-                    Accelerating = false;
-                }
-                break;
+            DriveMode = SyncDriveMode;
+            PROFILE_START(PROF_SETLIGHTS);
+            SetLights(DriveMode);
+            PROFILE_END(PROF_SETLIGHTS);
+            PROFILE_END(PROF_LOOP);
+            return;
         }
 
 
-    // DECELERATING
-    // -------------------------------------------------------------------------------------------------------------------------------------------->
-        // Here we are trying to identify sharp deceleration commands (user quickly letting off the throttle). 
-        // We need to be moving in a direction (forward or reverse), and still commanding the same direction, but the throttle amount needs to have dropped by DecelPct.
-        if ( ((DriveMode == FWD) && (ThrottleCommand >= 0) && (ThrottleCommand < ThrottleCommand_Previous - DecelPct)) ||
-             ((DriveMode == REV) && (ThrottleCommand <= 0) && (ThrottleCommand > ThrottleCommand_Previous + DecelPct)) )        
-        {   // We are decelerating
-            Decelerating = true;
-        }
-        else
-        {   // We are not decelerating, clear
-            Decelerating = false;
+    // CALCULATE DRIVE MODE FROM COMMAND - The command and mode are not always the same, if DoubleTapReverse = true
+    // ------------------------------------------------------------------------------------------------------------------------------------------------>
+        // The drive mode state machine (src/OSL_DriveMode) also works out braking, how long we've been stopped, and sharp acceleration/deceleration
+        Drive.step(ThrottleCommand, millis());
+        DriveModeCommand = Drive.command();
+        DriveMode = Drive.mode();
+        Braking = Drive.braking();
+        Decelerating = Drive.decelerating();
+        Accelerating = Drive.accelerating();
+        if (DriveMode != DriveMode_Previous || Braking != Braking_Previous) TRACE_EVENT(TRACE_DRIVE_MODE, DriveMode, Braking);
+
+        if (Drive.startedMoving())
+        {   // We've just started moving forwards or backwards. 
+            // Should we leave the turn signal on even though we're now moving forward? 
+            // TurnCommand != 0                 The wheels must be turned   
+            // TurnFromStartContinue_mS > 0     User must have enabled this setting
+            // BlinkTurnOnlyAtStop = true       This must be true, otherwise we just allow blinking all the time, so none of this is necessary
+            // TurnSignal_Enable = true         This means the car has already been stopped for some length of time
+            if (TurnCommand != 0 && UserParams.turnFromStartContinue > 0 && UserParams.blinkTurnOnlyAtStop && TurnSignal_Enable) 
+            {
+                // In this case we have just begun starting to move, and our wheels are turned at the same time. 
+                // We will keep the turn signals on for a brief period after starting, as set by TurnFromStartContinue_mS
+                TurnSignalOverride = TurnCommand;                                 // TurnSignalOverride saves the turn direction, and will act as a fake turn command in the SetLights function
+                timer.setTimeout(UserParams.turnFromStartContinue, TimerClearFlag, &TurnSignalOverride); // Sets TurnSignalOverride back to 0 when the timer is up. 
+            }
         }
+        TurnSignal_Enable = Drive.turnSignalEnabled();          // Delay after stopping before turn signals can be used (if BlinkTurnOnlyAtStop = true)
+        StoppedLongTime = Drive.stoppedLongTime();              // Stopped long enough for the stop-delay light settings
+        canChangeScheme = Drive.canChangeScheme();              // Stopped long enough to allow entry into Change-Scheme-Mode
 
 
     // BACKFIRE Enable
@@ -752,25 +752,6 @@ void loop()
         }
 
 
-    // ACCELERATING
-    // -------------------------------------------------------------------------------------------------------------------------------------------->
-        // Here we are trying to identify sharp acceleration commands. 
-        // The "if" statement says: 
-        // - if we are not already accelerating, and
-        // - if we are presently moving forward (we don't apply the accelerating state in reverse), and
-        // - if the user is not commanding a reverse throttle, and
-        // - if the current throttle command is greater than the prior command plus AccelPct (means, we have increased AccelPct throttle since last time)
-        // Then if all this is true, we set the Accelerating flag
-        if ((DriveMode == FWD) && (ThrottleCommand >= 0) && (ThrottleCommand > ThrottleCommand_Previous + AccelPct))        
-        {   // We are accelerating
-            Accelerating = true;
-        }
-        else
-        {   // We are not accelerating, clear
-            Accelerating = false;
-        }
-
-
     // OVERTAKE Enable
     // -------------------------------------------------------------------------------------------------------------------------------------------->
         // Overtaking is simply a timed event that occurs when a heavy acceleration is detected. The length of time the Overtake event lasts is set in 
@@ -780,8 +761,8 @@ void loop()
         if (Accelerating && !Overtaking)
         {   // The last overtaking is over, and we have started accelerating again. Enable the Overtaking timer again.
             Overtaking = true;
-            // This will set a timer of OvertakeTime length long, and when the timer expires, it will call the OvertakeOff function
-            OvertakeTimerID = timer.setTimeout(OvertakeTime, OvertakeOff);
+            // This will set a timer of OvertakeTime length long, and when the timer expires, it will clear the Overtaking flag
+            OvertakeTimerID = timer.setTimeout(UserParams.overtakeTime, TimerClearFlag, &Overtaking);
         } 
         else if (Overtaking && !timer.isEnabled(OvertakeTimerID)) 
         {   // disable overtaking effect if the timer has run out  
@@ -791,7 +772,9 @@ void loop()
 
     // FINALLY - SET THE LIGHTS
     // ------------------------------------------------------------------------------------------------------------------------------------------------>          
+        PROFILE_START(PROF_SETLIGHTS);
         SetLights(DriveMode);        // SetLights will take into account whatever position Channel 3 is in, as well as the present drive mode
+        PROFILE_END(PROF_SETLIGHTS);
 
 
     // DEBUGING
@@ -828,7 +811,7 @@ void loop()
                     if (DriveMode != DriveMode_Previous || Braking != Braking_Previous)     // We need to add the braking check here as well as change in drive mode, in order to overwrite the LEDs with new values if Braking changes
                     {
                         // Only show the message on changes in DriveMode
-                        if (DEBUG && DriveMode_Previous != DriveMode) { Serial.print(F("Drive Mode: ")); Serial.println(printMode(DriveMode)); } // Actual drive mode, not commanded
+                        if (DEBUG && DriveMode_Previous != DriveMode) QueueDebugMessage(DBG_DRIVE_MODE, DriveMode, 0); // Actual drive mode, not commanded
                         
                         switch (DriveMode)
                         {
@@ -861,7 +844,6 @@ void loop()
         // Set previous variables to current
         DriveMode_Previous = DriveMode;
         DriveModeCommand_Previous = DriveModeCommand;
-        ThrottleCommand_Previous = ThrottleCommand;
         TurnCommand_Previous = TurnCommand;
         Channel3Command_Previous = Channel3Command;
         Direction_Previous = Direction;
@@ -869,4 +851,6 @@ void loop()
 
     } // End of code that only takes place when we are NOT in failsafe
 
-} // End of Loop
+    PROFILE_END(PROF_LOOP);
+
+} // End of VehicleLogic
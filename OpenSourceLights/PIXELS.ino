@@ -0,0 +1,25 @@
+// ADDRESSABLE PIXELS - a strip of WS2812s, each pixel copying one of the lights in a color of its own
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Only runs if PixelCount in AA_UserConfig.h is more than 0. Which light and color each pixel uses is set in PixelMap at the bottom of AA_LightSetup,
+// the burst and gap timings are under ADDRESSABLE PIXELS in OSL_Settings.h
+
+static_assert(PixelCount == 0 || (sizeof(PixelMap) / sizeof(PixelMap[0])) >= PixelCount, "Add a row to PixelMap in AA_LightSetup for every pixel");
+
+void InitPixels()
+{
+    PixelOutput.begin(pin_Pixels, PixelCount, PixelsPerBurst);
+    PixelOutput.show();
+}
+
+void Task_Pixels()
+{
+    // Each pixel takes the brightness its light has right now, blinks, fades and all, so the task runs often enough to keep up with the fades.
+    // Nothing is sent unless a pixel has actually changed.
+    for (uint8_t i=0; i<PixelCount; i++)
+    {
+        uint8_t light = pgm_read_byte_near(&(PixelMap[i][0]));
+        uint8_t level = (light >= 1 && light <= NumLights) ? LightOutput[light - 1].level() : 0;     // Light 0 leaves the pixel off
+        PixelOutput.set(i, pgm_read_byte_near(&(PixelMap[i][1])), pgm_read_byte_near(&(PixelMap[i][2])), pgm_read_byte_near(&(PixelMap[i][3])), level);
+    }
+    PixelOutput.show();                                             // If it has to start over it'll be sent again next time
+}
@@ -1,300 +1,353 @@
+// RADIO SETUP - learn the endpoints, centers and directions of the radio channels
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Started from VehicleLogic when the setup button is held for two seconds (it sets RadioSetupActive), then stepped by the setup task every 10 mS until
+// it's done. Each step either waits out a pause, takes one reading of every channel, or starts the next state - nothing here waits on a loop, so the
+// radio, the light effects and failsafe keep running the whole time. Timings and thresholds are under RADIO SETUP in OSL_Settings.h
+
+#define RS_IDLE             0
+#define RS_START            1       // Red LED on for the whole of setup
+#define RS_S1_INTRO         2       // Stage 1: green LED on steady
+#define RS_S1_PAUSE         3       //          then off
+#define RS_S1_READ          4       //          one blink every 1200 mS while we record the extremes
+#define RS_S2_PAUSE         5       // Stage 2: off
+#define RS_S2_INTRO         6       //          two slow blinks
+#define RS_S2_READ          7       //          two quick blinks every 1200 mS until the sticks are still at center
+#define RS_S3_PAUSE         8       // Stage 3: off
+#define RS_S3_INTRO         9       //          two slow blinks
+#define RS_S3_READ         10       //          three quick blinks every 1200 mS until the sticks are still at full forward/right
+#define RS_END_PAUSE       11       // End:     off
+#define RS_END             12       //          on steady, then done
 
-void RadioSetup()
-{
-unsigned long TotThrottlePulse = 0;
-unsigned long TotTurnPulse = 0;
-unsigned long TotChannel3Pulse = 0;
-float TempFloat;
-int Count;
 #define _line_width 40
-BlinkStream bs;     // Used for some blinking effects
 
-       
-// RUN SETUP
-// -------------------------------------------------------------------------------------------------------------------------------------------------->        
-    Serial.println();
-    Serial.println();
-    Serial.println(F("ENTERING SETUP...")); 
-    Serial.println();
+void Task_RadioSetup()
+{
+    static uint8_t  state = RS_IDLE;
+    static uint32_t stateStart;                     // When we entered the current state
+    static uint32_t windowStart;                    // Stages 2 and 3: when the current window of readings began
+    uint32_t        inState;
+    boolean         done;
+    BlinkStream     bs;                             // Used for some blinking effects
+
+    if (!RadioSetupActive) return;
+    inState = millis() - stateStart;
+
+    switch (state)
+    {
+        case RS_IDLE:
+            SetupPrintln(F(""));
+            SetupPrintln(F(""));
+            SetupPrintln(F("ENTERING SETUP..."));
+            SetupPrintln(F(""));
+            RedLED.on();
+            state = RS_START;       stateStart = millis();
+            break;
+
+        // STAGE 1 = Read max travel values from radio, save to EEPROM
+        // -------------------------------------------------------------------------------------------------------------------------------------->
+        case RS_START:
+            if (inState < 2000) break;
+            PrintLine(_line_width);
+            SetupPrintln(F("STAGE 1 - STORE MAX TRAVEL VALUES"));
+            PrintLine(_line_width);
+            SetupPrintln(F("Move all controls to maximum values"));
+            SetupPrintln(F("while green LED blinks"));
+            SetupPrintln(F(""));
+            GreenLED.on();
+            state = RS_S1_INTRO;    stateStart = millis();
+            break;
+
+        case RS_S1_INTRO:
+            if (inState < 2000) break;
+            GreenLED.off();
+            state = RS_S1_PAUSE;    stateStart = millis();
+            break;
+
+        case RS_S1_PAUSE:
+            if (inState < 2000) break;
+            GreenLED.startBlinking(100, 1200);
+            SetupPrintln(F("Reading..."));
+            ResetSetupStats();
+            state = RS_S1_READ;     stateStart = millis();
+            break;
+
+        case RS_S1_READ:
+            // The user moves the sticks to the extremes, the lowest and highest readings are kept
+            AddSetupReadings();
+            if (inState < SETUP_MINMAX_TIME_MS) break;
+            GreenLED.stopBlinking();
+            FinishSetupStage1();
+            GreenLED.off();
+            state = RS_S2_PAUSE;    stateStart = millis();
+            break;
+
+        // Stage 2 = Set Channel center values (I've found they are not always equal to one half of max travel)
+        // For Channel 3, if you have a 3-position switch, set it to center. If you have a 2 position switch, set it to ON
+        // This routine will determine whether a 3 position switch is implemented or not.
+        // -------------------------------------------------------------------------------------------------------------------------------------->
+        case RS_S2_PAUSE:
+            if (inState < 2000) break;
+            PrintLine(_line_width);
+            SetupPrintln(F("STAGE 2 - STORE CENTER VALUES"));
+            PrintLine(_line_width);
+            SetupPrintln(F("Place throttle and steering in NEUTRAL."));
+            SetupPrintln(F("If Channel 3 is a 3-position switch, set it to CENTER."));
+            SetupPrintln(F(""));
+            GreenLED.Blink(2, 750, 500);    // Blink twice, 750mS on, 500mS off
+            state = RS_S2_INTRO;    stateStart = millis();
+            break;
+
+        case RS_S2_INTRO:
+            if (inState < 2000) break;
+            // Start green LED blinking for stage two: two blinks every 1200 ms
+            bs.interval[0] = 100;               // On
+            bs.interval[1] = 90;                // Off
+            bs.interval[2] = 100;               // On
+            bs.interval[3] = 1200;              // Off
+            bs.repeat = true;
+            GreenLED.StreamBlink(bs, 4);        // 4 steps in the stream
+            SetupPrintln(F("Reading..."));
+            ResetSetupStats();
+            state = RS_S2_READ;     stateStart = windowStart = millis();
+            break;
+
+        case RS_S2_READ:
+            AddSetupReadings();
+            if (!SetupWindowDone(stateStart, windowStart, done)) break;
+            if (!done) { ResetSetupStats(); windowStart = millis(); break; }
+            GreenLED.stopBlinking();
+            FinishSetupStage2();
+            GreenLED.off();
+            state = RS_S3_PAUSE;    stateStart = millis();
+            break;
+
+        // Stage 3 = Set channel reversing.
+        // -------------------------------------------------------------------------------------------------------------------------------------->
+        // Method used here is to ask the user to:
+        // Hold throttle stick for full forward,
+        // Hold steering wheel to full right,
+        // Move Channel 3 to full ON
+        // We take a string of readings and average them. We see if the pulse lengths are long or short, and knowing where the sticks are physically,
+        // allows us to determine if we need to reverse any channels in software.
+        case RS_S3_PAUSE:
+            if (inState < 2000) break;
+            PrintLine(_line_width);
+            SetupPrintln(F("STAGE 3 - STORE CHANNEL DIRECTIONS"));
+            PrintLine(_line_width);
+            SetupPrintln(F("Hold trigger down (full forward), hold steering wheel full right, set Channel 3 to ON"));
+            SetupPrintln(F(""));
+            GreenLED.Blink(2, 750, 500);    // Blink twice, 750mS on, 500mS off
+            state = RS_S3_INTRO;    stateStart = millis();
+            break;
+
+        case RS_S3_INTRO:
+            if (inState < 2000) break;
+            // Start green LED blinking for stage three: three blinks every 1200 ms
+            bs.interval[0] = 100;               // On
+            bs.interval[1] = 90;                // Off
+            bs.interval[2] = 100;               // On
+            bs.interval[3] = 90;                // Off
+            bs.interval[4] = 100;               // On
+            bs.interval[5] = 1200;              // Off
+            bs.repeat = true;
+            GreenLED.StreamBlink(bs, 6);        // 6 steps in the stream
+            SetupPrintln(F("Reading..."));
+            ResetSetupStats();
+            state = RS_S3_READ;     stateStart = windowStart = millis();
+            break;
+
+        case RS_S3_READ:
+            AddSetupReadings();
+            if (!SetupWindowDone(stateStart, windowStart, done)) break;
+            if (!done) { ResetSetupStats(); windowStart = millis(); break; }
+            GreenLED.stopBlinking();
+            FinishSetupStage3();
+            GreenLED.off();
+            state = RS_END_PAUSE;   stateStart = millis();
+            break;
+
+        // End Setup
+        // -------------------------------------------------------------------------------------------------------------------------------------->
+        case RS_END_PAUSE:
+            if (inState < 2000) break;
+            GreenLED.on();
+            state = RS_END;         stateStart = millis();
+            break;
+
+        case RS_END:
+            if (inState < 3000) break;
+            GreenLED.off();
+            SetupPrintln(F("--- END SETUP ---"));
+            SetupPrintln(F(""));
+            SetupPrintln(F(""));
+            RedLED.off();
+            state = RS_IDLE;
+            RadioSetupActive = false;
+            break;
+
+        default:
+            state = RS_IDLE;
+            RadioSetupActive = false;
+    }
+}
 
-    // While in setup, Red LED remains on:
-        RedLED.on();
-        delayWhilePolling(2000);
-
-
-    // STAGE 1 = Read max travel values from radio, save to EEPROM
-    // ------------------------------------------------------------------------------------------------------------------------------------------>                  
-        // Transition to Stage 1:
-        // Green LED on steady for two seconds
-        PrintLine(_line_width);
-        Serial.println(F("STAGE 1 - STORE MAX TRAVEL VALUES"));
-        PrintLine(_line_width);
-        Serial.println(F("Move all controls to maximum values"));
-        Serial.println(F("while green LED blinks"));
-        Serial.println();
-        GreenLED.on();
-        delayWhilePolling(2000);
-        GreenLED.off();
-        delayWhilePolling(2000);
-
-        // Start green LED blinking for stage one: one blink every 1200 ms
-        GreenLED.startBlinking(100, 1200);
-        StartWaiting_sec(15);
-        Serial.println(F("Reading..."));
-
-        // We initialize every min and max value to TypicalPulseCenter. In the loop below we will record deviations from the center. 
-        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-        {
-            RC_Channel[i].pulseMin = PULSE_WIDTH_TYP_CENTER;
-            RC_Channel[i].pulseMax = PULSE_WIDTH_TYP_CENTER;
-        }
-
-        // Repeat until StartWaiting timer is up
-        do
-        {
-            // Read the radio
-            PerLoopUpdates();
-
-            // Read channel while the user moves the sticks to the extremes
-            // Each time through the loop, only save the extreme values if they are greater than the last time through the loop. 
-            // At the end we should have the true min and max for each channel.
-            for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-            {
-                if (RC_Channel[i].pulse > RC_Channel[i].pulseMax) RC_Channel[i].pulseMax = RC_Channel[i].pulse;
-                if (RC_Channel[i].pulse > 0 && RC_Channel[i].pulse < RC_Channel[i].pulseMin) RC_Channel[i].pulseMin = RC_Channel[i].pulse;
-            }
-        }
-        while (!TimeUp);    // Keep looping until time's up
-        GreenLED.stopBlinking();
-        
+boolean SetupWindowDone(uint32_t stateStart, uint32_t windowStart, boolean &done)
+{   // Stages 2 and 3: returns true at the end of each window of readings. done is then set if the readings can be used - the user has had time to
+    // get the sticks in place and every channel was held still - or if we've run out of time waiting for that.
+    uint32_t now = millis();
+    if ((now - windowStart) < SETUP_WINDOW_MS) return false;
+    done = ((windowStart - stateStart) >= SETUP_SETTLE_MS && SetupReadingsStill()) || (now - stateStart) >= SETUP_READ_TIMEOUT_MS;
+    if (done && !SetupReadingsStill()) SetupPrintln(F("Controls were not held still, using the last readings"));
+    return true;
+}
+
+void FinishSetupStage1()
+{
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        RC_Channel[i].pulseMin = SetupStats[i].minimum;
+        RC_Channel[i].pulseMax = SetupStats[i].maximum;
         // Sanity check in case something weird happened (like Tx turned off during setup, or some channels disconnected)
-        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-        {
-            if (RC_Channel[i].pulseMin < PULSE_WIDTH_ABS_MIN) RC_Channel[i].pulseMin = PULSE_WIDTH_ABS_MIN;
-            if (RC_Channel[i].pulseMax > PULSE_WIDTH_ABS_MAX) RC_Channel[i].pulseMax = PULSE_WIDTH_ABS_MAX;
-        }
-
-        // Save values to EEPROM
-        eeprom_write(RC_Channel[0].pulseMin, E_ThrottlePulseMin);
-        eeprom_write(RC_Channel[0].pulseMax, E_ThrottlePulseMax);
-        eeprom_write(RC_Channel[1].pulseMin, E_TurnPulseMin);
-        eeprom_write(RC_Channel[1].pulseMax, E_TurnPulseMax);
-        eeprom_write(RC_Channel[2].pulseMin, E_Channel3PulseMin);
-        eeprom_write(RC_Channel[2].pulseMax, E_Channel3PulseMax);
-
-        Serial.println();
-        Serial.println(F("Stage 1 Results: Min & Max pulse values"));
-        Serial.println(F("Channel       Min       Max"));
-        PrintLine(_line_width);
-        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-        {
-            PrintChannelName(i, true);  // True for padding after the word
-            Serial.print(RC_Channel[i].pulseMin);
-            if (RC_Channel[i].pulseMin < 1000) PrintSpaces(7); else PrintSpaces(6);
-            Serial.println(RC_Channel[i].pulseMax);
-        }
-        Serial.println();
-        Serial.println();
-        Serial.println();
-        
-     
-    // Stage 2 = Set Channel center values (I've found they are not always equal to one half of max travel)
-    // For Channel 3, if you have a 3-position switch, set it to center. If you have a 2 position switch, set it to ON
-    // This routine will determine whether a 3 position switch is implemented or not. 
-    // ------------------------------------------------------------------------------------------------------------------------------------------>       
-        // Transition to Stage 2:
-        // Off for two seconds, two slow blinks
-        GreenLED.off();
-        delayWhilePolling(2000);        
-        PrintLine(_line_width);
-        Serial.println(F("STAGE 2 - STORE CENTER VALUES"));
-        PrintLine(_line_width);
-        Serial.println(F("Place throttle and steering in NEUTRAL."));
-        Serial.println(F("If Channel 3 is a 3-position switch, set it to CENTER."));
-        Serial.println();
-        GreenLED.Blink(2, 750, 500);    // Blink twice, 750mS on, 500mS off
-        delayWhilePolling(2000);
-
-        // Initialize some variables
-        TotThrottlePulse = 0;
-        TotTurnPulse = 0;    
-        TotChannel3Pulse = 0;       
-        Count = 0;
-
-        // Start green LED blinking for stage two: two blinks every 1200 ms
-        bs.interval[0] = 100;               // On
-        bs.interval[1] = 90;                // Off
-        bs.interval[2] = 100;               // On
-        bs.interval[3] = 1200;              // Off
-        bs.repeat = true;
-        GreenLED.StreamBlink(bs, 4);        // 4 steps in the stream
-
-        StartWaiting_sec(6); // For the first bit of time we don't take any readings, this lets the user get the sticks centered
-        Serial.println(F("Reading..."));
-        while (!TimeUp)
-        {    PerLoopUpdates(); }
-
-        StartWaiting_sec(4); // Now for the next four seconds we check the sticks
-        do
-        {        
-            delayWhilePolling(100);
-            TotThrottlePulse += RC_Channel[0].pulse;  
-            TotTurnPulse += RC_Channel[1].pulse;
-            TotChannel3Pulse += RC_Channel[2].pulse;
-            // Increment reading count
-            Count++;
-        }
-        while (!TimeUp);    // Keep looping until time's up
-        GreenLED.stopBlinking();
-
-        // Finally we record our readings
-        TempFloat = (float)TotThrottlePulse / (float)Count;
-        RC_Channel[0].pulseCenter = (int)lround(TempFloat);
-        TempFloat = (float)TotTurnPulse / (float)Count;
-        RC_Channel[1].pulseCenter = (int)lround(TempFloat);
-        TempFloat = (float)TotChannel3Pulse / (float)Count;
-        RC_Channel[2].pulseCenter = (int)lround(TempFloat);
+        if (RC_Channel[i].pulseMin < PULSE_WIDTH_ABS_MIN) RC_Channel[i].pulseMin = PULSE_WIDTH_ABS_MIN;
+        if (RC_Channel[i].pulseMax > PULSE_WIDTH_ABS_MAX) RC_Channel[i].pulseMax = PULSE_WIDTH_ABS_MAX;
+    }
+
+    // Save values to EEPROM
+    SaveCalibration_To_EEPROM();
+
+    SetupPrintln(F(""));
+    SetupPrintln(F("Stage 1 Results: Min & Max pulse values"));
+    SetupPrintln(F("Channel       Min       Max"));
+    PrintLine(_line_width);
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        WaitForSerial(DEBUG_MESSAGE_MAX);
+        PrintChannelName(i, true);  // True for padding after the word
+        Serial.print(RC_Channel[i].pulseMin);
+        if (RC_Channel[i].pulseMin < 1000) PrintSpaces(7); else PrintSpaces(6);
+        Serial.println(RC_Channel[i].pulseMax);
+    }
+    SetupPrintln(F(""));
+    SetupPrintln(F(""));
+    SetupPrintln(F(""));
+}
 
+void FinishSetupStage2()
+{
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        RC_Channel[i].pulseCenter = SetupReadingsMean(i);
         // Sanity check in case something weird happened (like Tx turned off during setup, or some channels disconnected)
-        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-        {        
-            if ((RC_Channel[i].pulseCenter < PULSE_WIDTH_TYP_MIN) || (RC_Channel[i].pulseCenter > PULSE_WIDTH_TYP_MAX))   {RC_Channel[i].pulseCenter = PULSE_WIDTH_TYP_CENTER; }
-        }
-
-        // Save values to EEPROM
-        eeprom_write(RC_Channel[0].pulseCenter, E_ThrottlePulseCenter);
-        eeprom_write(RC_Channel[1].pulseCenter, E_TurnPulseCenter);
-        eeprom_write(RC_Channel[2].pulseCenter, E_Channel3PulseCenter);
-
-        Serial.println();
-        Serial.println(F("Stage 2 Results - Pulse center values"));
-        Serial.println(F("Channel       Center"));
-        PrintLine(_line_width);
-        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-        {
-            PrintChannelName(i, true);  // True for padding after the word
-            Serial.println(RC_Channel[i].pulseCenter);
-        }
-        Serial.println();
-        Serial.println();        
-        Serial.println();
-
-
-    // Stage 3 = Set channel reversing. 
-    // ------------------------------------------------------------------------------------------------------------------------------------------>                                 
-        // Method used here is to ask the user to:
-        // Hold throttle stick for full forward, 
-        // Hold steering wheel to full right,
-        // Move Channel 3 to full ON
-        // We take a string of readings and average them. We see if the pulse lengths are long or short, and knowing where the sticks are physically, 
-        // allows us to determine if we need to reverse any channels in software. 
-
-        // Transition to Stage 3:
-        GreenLED.off();
-        delayWhilePolling(2000);            
-        PrintLine(_line_width);
-        Serial.println(F("STAGE 3 - STORE CHANNEL DIRECTIONS"));
-        PrintLine(_line_width);
-        Serial.println(F("Hold trigger down (full forward), hold steering wheel full right, set Channel 3 to ON"));
-        Serial.println();
-        GreenLED.Blink(2, 750, 500);    // Blink three times, 750mS on, 500mS off
-        delayWhilePolling(2000);                
-        
-        // Initialize some variables
-        TotThrottlePulse = 0;
-        TotTurnPulse = 0;                        
-        TotChannel3Pulse = 0;                
-        Count = 0;
-
-        // Clear reverse flag to start
-        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-        {
-            RC_Channel[0].reversed = false;
-        }
-
-        // Start green LED blinking for stage three: three blinks every 1200 ms
-        bs.interval[0] = 100;               // On
-        bs.interval[1] = 90;                // Off
-        bs.interval[2] = 100;               // On
-        bs.interval[3] = 90;                // Off
-        bs.interval[4] = 100;               // On
-        bs.interval[5] = 1200;              // Off
-        bs.repeat = true;
-        GreenLED.StreamBlink(bs, 6);        // 6 steps in the stream
-        
-        StartWaiting_sec(6); // For the first bit of time we don't take any readings, this lets the user get the sticks centered
-        Serial.println(F("Reading..."));
-        while (!TimeUp)
-        {    PerLoopUpdates(); }
-
-        StartWaiting_sec(4); // Now for the next four seconds we check the sticks
-        do
-        {    
-            delayWhilePolling(100);
-            TotThrottlePulse += RC_Channel[0].pulse;  
-            TotTurnPulse += RC_Channel[1].pulse;
-            TotChannel3Pulse += RC_Channel[2].pulse;
-            // Increment reading count
-            Count++;
-        }
-        while (!TimeUp);    // Keep looping until time's up
-        GreenLED.stopBlinking();
-
-        // Get the average of our readings
-        TotThrottlePulse /= Count;
-        TotTurnPulse /= Count;
-        TotChannel3Pulse /= Count;
-
-        /*
-        if (DEBUG) 
-        {                        
-            Serial.print(F("Throttle Avg: "));
-            Serial.println(TotThrottlePulse);
-            Serial.print(F("Turn Avg: "));
-            Serial.println(TotTurnPulse);
-            Serial.print(F("Channel3 Avg: "));
-            Serial.println(TotChannel3Pulse);
-        }
-        */
-        
-        // Decide if the channel is reversed, and do a sanity check as well
-        // Throttle stick was held up, should have been long pulse. If not, reverse
-        if ((TotThrottlePulse < 1300) && (TotThrottlePulse > PULSE_WIDTH_ABS_MIN))  { RC_Channel[0].reversed = true; }
-        // Turn stick was held right, should have been long pulse. If not, reverse
-        if ((TotTurnPulse < 1300) && (TotTurnPulse > PULSE_WIDTH_ABS_MIN))          { RC_Channel[1].reversed = true;     }
-        // We consider on to be high, should have been long pulse. If not, reverse
-        if ((TotChannel3Pulse < 1300) && (TotChannel3Pulse > PULSE_WIDTH_ABS_MIN))  { RC_Channel[2].reversed = true;        }
-        
-       // Save values to EEPROM
-        eeprom_write(RC_Channel[0].reversed, E_ThrottleChannelReverse);
-        eeprom_write(RC_Channel[1].reversed, E_TurnChannelReverse);
-        eeprom_write(RC_Channel[2].reversed, E_Channel3Reverse);     
-
-        Serial.println();
-        Serial.println(F("Stage 3 Results - Channel reversed"));
-        Serial.println(F("Channel       Reversed"));
-        PrintLine(_line_width);
-        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
-        {
-            PrintChannelName(i, true);  // True for padding after the word
-            PrintLineYesNo(RC_Channel[i].reversed);
-        }
-        Serial.println();
-        Serial.println();        
-        Serial.println();
-
-
-        // Transition to Stage End:
-        GreenLED.off();
-        delayWhilePolling(2000);
-        GreenLED.on();
-        delayWhilePolling(3000);
-        GreenLED.off();
-
-    // End Setup
-    Serial.println(F("--- END SETUP ---")); 
-    Serial.println();
-    Serial.println();
-    RedLED.off();       
+        if ((RC_Channel[i].pulseCenter < PULSE_WIDTH_TYP_MIN) || (RC_Channel[i].pulseCenter > PULSE_WIDTH_TYP_MAX))   {RC_Channel[i].pulseCenter = PULSE_WIDTH_TYP_CENTER; }
+    }
+
+    // Save values to EEPROM
+    SaveCalibration_To_EEPROM();
+
+    SetupPrintln(F(""));
+    SetupPrintln(F("Stage 2 Results - Pulse center values"));
+    SetupPrintln(F("Channel       Center"));
+    PrintLine(_line_width);
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        WaitForSerial(DEBUG_MESSAGE_MAX);
+        PrintChannelName(i, true);  // True for padding after the word
+        Serial.println(RC_Channel[i].pulseCenter);
+    }
+    SetupPrintln(F(""));
+    SetupPrintln(F(""));
+    SetupPrintln(F(""));
+}
+
+void FinishSetupStage3()
+{
+    int16_t average;
+
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        // Throttle stick was held up, turn stick was held right, and we consider Channel 3 ON to be high. All should have been long pulses. If not, reverse.
+        average = SetupReadingsMean(i);
+        RC_Channel[i].reversed = ((average < 1300) && (average > PULSE_WIDTH_ABS_MIN));
+    }
+
+    // Save values to EEPROM
+    SaveCalibration_To_EEPROM();
+
+    SetupPrintln(F(""));
+    SetupPrintln(F("Stage 3 Results - Channel reversed"));
+    SetupPrintln(F("Channel       Reversed"));
+    PrintLine(_line_width);
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        WaitForSerial(DEBUG_MESSAGE_MAX);
+        PrintChannelName(i, true);  // True for padding after the word
+        PrintLineYesNo(RC_Channel[i].reversed);
+    }
+    SetupPrintln(F(""));
+    SetupPrintln(F(""));
+    SetupPrintln(F(""));
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// READINGS - running min, max, mean and variance of each channel, updated one reading at a time
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+void ResetSetupStats()
+{
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        SetupStats[i].count = 0;
+        SetupStats[i].sum = 0;
+        SetupStats[i].sumSquares = 0;
+        SetupStats[i].minimum = PULSE_WIDTH_TYP_CENTER;     // Any real reading will move these away from center
+        SetupStats[i].maximum = PULSE_WIDTH_TYP_CENTER;
+    }
+}
+
+void AddSetupReadings()
+{
+    _pulse_stats *s;
+    int16_t pulse;
+    int16_t diff;
+
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        s = &SetupStats[i];
+        pulse = RC_Channel[i].pulse;
+        if (s->count == 0) s->first = pulse;
+        diff = pulse - s->first;
+        s->sum += diff;
+        s->sumSquares += (int32_t)diff * diff;      // Only used for the short windows of stages 2 and 3, it can overflow over the length of stage 1
+        if (s->count < 0xFFFF) s->count++;
+        if (pulse > s->maximum) s->maximum = pulse;
+        if (pulse > 0 && pulse < s->minimum) s->minimum = pulse;
+    }
+}
+
+int16_t SetupReadingsMean(uint8_t i)
+{
+    if (SetupStats[i].count == 0) return 0;
+    return SetupStats[i].first + (int16_t)lround((float)SetupStats[i].sum / (float)SetupStats[i].count);
+}
 
+boolean SetupReadingsStill()
+{
+    float mean;
+    float variance;
+
+    for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    {
+        if (SetupStats[i].count == 0) return false;
+        mean = (float)SetupStats[i].sum / (float)SetupStats[i].count;
+        variance = ((float)SetupStats[i].sumSquares / (float)SetupStats[i].count) - (mean * mean);
+        if (variance > SETUP_STILL_VARIANCE) return false;
+    }
+    return true;
+}
+
+void SetupPrintln(const __FlashStringHelper *str)
+{   // Keeps the other tasks running if the transmit buffer is full
+    PrintWaiting(str);
+    WaitForSerial(2);
+    Serial.println();
 }
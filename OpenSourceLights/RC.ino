@@ -41,23 +41,23 @@ void InitializeRCChannels(void)
     // Throttle
     RC_Channel[0].channel = 0;                      // Throttle
     RC_Channel[0].Digital = false;                  
-    RC_Channel[0].deadband = ThrottleDeadband;
+    RC_Channel[0].deadband = UserParams.throttleDeadband;
     RC_Channel[0].smooth = SmoothThrottle; 
     RC_Channel[0].smoothedValue = 1500;
-    eeprom_read(RC_Channel[0].pulseMin, E_ThrottlePulseMin);
-    eeprom_read(RC_Channel[0].pulseMax, E_ThrottlePulseMax);
-    eeprom_read(RC_Channel[0].pulseCenter, E_ThrottlePulseCenter);
-    eeprom_read(RC_Channel[0].reversed, E_ThrottleChannelReverse);    
+    RC_Channel[0].pulseMin = Config.channel[0].pulseMin;
+    RC_Channel[0].pulseMax = Config.channel[0].pulseMax;
+    RC_Channel[0].pulseCenter = Config.channel[0].pulseCenter;
+    RC_Channel[0].reversed = Config.channel[0].reversed;
     // Steering
     RC_Channel[1].channel = 1;                      // Steering
     RC_Channel[1].Digital = false;                  
-    RC_Channel[1].deadband = TurnDeadband;
+    RC_Channel[1].deadband = UserParams.turnDeadband;
     RC_Channel[1].smooth = SmoothSteering;
     RC_Channel[1].smoothedValue = 1500;
-    eeprom_read(RC_Channel[1].pulseMin, E_TurnPulseMin);    
-    eeprom_read(RC_Channel[1].pulseMax, E_TurnPulseMax);    
-    eeprom_read(RC_Channel[1].pulseCenter, E_TurnPulseCenter);
-    eeprom_read(RC_Channel[1].reversed, E_TurnChannelReverse); 
+    RC_Channel[1].pulseMin = Config.channel[1].pulseMin;
+    RC_Channel[1].pulseMax = Config.channel[1].pulseMax;
+    RC_Channel[1].pulseCenter = Config.channel[1].pulseCenter;
+    RC_Channel[1].reversed = Config.channel[1].reversed;
     // Channel 3
     RC_Channel[2].channel = 2;                      // Channel 3
     RC_Channel[2].Digital = true;                   // Channel 3 is treated as a switch
@@ -67,10 +67,10 @@ void InitializeRCChannels(void)
     RC_Channel[2].switchPos = Pos1;                 // Default to Position 1, which is the default position when no Channel 3 is attached
     RC_Channel[2].rawPulseWidth = 1000;             // Let's set the default pulse width to the equivalent of Pos1 just so it all matches
     RC_Channel[2].pulse = 1000;                     // idem
-    eeprom_read(RC_Channel[2].pulseMin, E_Channel3PulseMin);    
-    eeprom_read(RC_Channel[2].pulseMax, E_Channel3PulseMax);    
-    eeprom_read(RC_Channel[2].pulseCenter, E_Channel3PulseCenter);
-    eeprom_read(RC_Channel[2].reversed, E_Channel3Reverse); 
+    RC_Channel[2].pulseMin = Config.channel[2].pulseMin;
+    RC_Channel[2].pulseMax = Config.channel[2].pulseMax;
+    RC_Channel[2].pulseCenter = Config.channel[2].pulseCenter;
+    RC_Channel[2].reversed = Config.channel[2].reversed;
         
     
     // Now link some values from this array to discrete variables for ease of reference in code
@@ -79,6 +79,42 @@ void InitializeRCChannels(void)
     Channel3Command = RC_Channel[2].switchPos;
 }
 
+#if PCINT_TEMPLATE_DISPATCH
+// The RC pins and their handlers are fixed here, and the pin change vectors for ports 1 and 2 are defined from them (see PIN CHANGE INTERRUPTS in 
+// OSL_Settings.h). The handlers go straight into the vectors, with no lookup and no function call. 
+typedef PinChangeGroup< PinChangePin<pin_HW1_Throttle, RC0_Edge>, 
+                        PinChangePin<pin_HW1_Steering, RC1_Edge>, 
+                        PinChangePin<pin_HW1_Ch3,      RC2_Edge> > RCPins;
+static_assert(RCPins::mask(0) == 0, "Port 0 pin change vector belongs to the PinChangeInterrupt library");
+OSL_PINCHANGE_ISR(RCPins, 1, PCINT1_vect, PINC);
+OSL_PINCHANGE_ISR(RCPins, 2, PCINT2_vect, PIND);
+
+void EnableRCInterrupts(void)
+{
+    RCPins::enable();
+}
+
+void DisableRCInterrupts(void)
+{
+    RCPins::disable();
+}
+
+void RC0_Edge(uint32_t uS, boolean high)
+{
+    ProcessRCEdge(0, uS, high);
+}
+
+void RC1_Edge(uint32_t uS, boolean high)
+{
+    ProcessRCEdge(1, uS, high);
+}
+
+void RC2_Edge(uint32_t uS, boolean high)
+{
+    ProcessRCEdge(2, uS, high);
+}
+
+#else
 void EnableRCInterrupts(void)
 {   // Pin change interrupts
     attachPCINT(digitalPinToPCINT(RC_Channel[0].pin), RC0_ISR, CHANGE);
@@ -95,24 +131,22 @@ void DisableRCInterrupts(void)
 
 void RC0_ISR()
 {
-    ProcessRCPulse(0);
+    ProcessRCEdge(0, micros(), digitalRead(RC_Channel[0].pin));
 }
 
 void RC1_ISR()
 {
-    ProcessRCPulse(1);
+    ProcessRCEdge(1, micros(), digitalRead(RC_Channel[1].pin));
 }
 
 void RC2_ISR()
 {
-    ProcessRCPulse(2);
+    ProcessRCEdge(2, micros(), digitalRead(RC_Channel[2].pin));
 }
+#endif
 
-void ProcessRCPulse(uint8_t ch)
+inline void ProcessRCEdge(uint8_t ch, uint32_t uS, boolean high)
 {
-    uint32_t    uS;
-    uS =  micros();    
-
     // If an input voltage on one of the RC pins has changed, an interrupt is automaically generated and we end up here. 
     // We want to measure the length of a pulse, starting at the rising edge and ending at the falling edge. 
     // When a falling edge is detected we record the length of time and set a flag so that when the  main loop calls ProcessChannelPulses()
@@ -120,7 +154,7 @@ void ProcessRCPulse(uint8_t ch)
     // brief as possible, so we do the bare minimum and let the loop handle the rest outside of the ISR
     if (RC_Channel[ch].readyForUpdate == false)                 // Don't bother if we haven't yet processed the last pulse. 
     {
-        if (digitalRead(RC_Channel[ch].pin))
+        if (high)
         {   
             RC_Channel[ch].lastEdgeTime = uS;                   // Rising edge - save the time
         }
@@ -144,7 +178,10 @@ void ProcessChannelPulses(void)
         {
             if (RC_Channel[ch].rawPulseWidth >= PULSE_WIDTH_ABS_MIN && RC_Channel[ch].rawPulseWidth <= PULSE_WIDTH_ABS_MAX)
             {
-                // rawPulseWidth is valid, transfer it to actual pulse variable
+                // rawPulseWidth is valid. Learn from it before any smoothing if auto calibration is on (see the AUTOCAL tab)
+                if (EnableAutoCalibration && ch < AUTOCAL_CHANNELS && RC_Channel[ch].state == RC_SIGNAL_SYNCHED && !RadioSetupActive) AutoCalPulse(ch, RC_Channel[ch].rawPulseWidth);
+
+                // Transfer it to actual pulse variable
                 RC_Channel[ch].pulse = RC_Channel[ch].rawPulseWidth;
 
                 // Appply smoothing if specified on this channel
@@ -153,7 +190,7 @@ void ProcessChannelPulses(void)
                     // Smoothing code submitted by Wombii 
                     // https://www.rcgroups.com/forums/showthread.php?1539753-Open-Source-Lights-Arduino-based-RC-Light-Controller/page57#post41145245
                     // Takes difference between current and old value, divides difference by none/2/4/8/16 and adds difference to old value (a quick and simple way of averaging)
-                    RC_Channel[ch].smoothedValue = RC_Channel[ch].smoothedValue + ((RC_Channel[ch].pulse - RC_Channel[ch].smoothedValue) >> smoothingStrength);
+                    RC_Channel[ch].smoothedValue = RC_Channel[ch].smoothedValue + ((RC_Channel[ch].pulse - RC_Channel[ch].smoothedValue) >> UserParams.smoothing);
                     RC_Channel[ch].pulse = RC_Channel[ch].smoothedValue;
                 }
                 
@@ -169,12 +206,14 @@ void ProcessChannelPulses(void)
                     case RC_SIGNAL_LOST:
                         RC_Channel[ch].state = RC_SIGNAL_ACQUIRE;
                         RC_Channel[ch].acquireCount = 1;
+                        TRACE_EVENT(TRACE_CHANNEL_STATE, ch, RC_SIGNAL_ACQUIRE);
                         break;
                     
                     case RC_SIGNAL_ACQUIRE:
                         if (++RC_Channel[ch].acquireCount >= RC_PULSECOUNT_TO_ACQUIRE)
                         {
                             RC_Channel[ch].state = RC_SIGNAL_SYNCHED;
+                            TRACE_EVENT(TRACE_CHANNEL_STATE, ch, RC_SIGNAL_SYNCHED);
                             // if (DEBUG) Serial.print(F("Channel ")); Serial.print(ch+1); Serial.println(F(" acquired")); 
                         }
                         break;
@@ -183,8 +222,10 @@ void ProcessChannelPulses(void)
             else 
             {
                 // Invalid pulse. If we haven't had a good pulse for a while, set the state of this channel to SIGNAL_LOST. 
+                TRACE_EVENT(TRACE_PULSE_REJECT, ch, RC_Channel[ch].rawPulseWidth);
                 if (RC_Channel[ch].lastEdgeTime - RC_Channel[ch].lastGoodPulseTime > RC_TIMEOUT_US)
                 {
+                    if (RC_Channel[ch].state != RC_SIGNAL_LOST) TRACE_EVENT(TRACE_CHANNEL_STATE, ch, RC_SIGNAL_LOST);
                     RC_Channel[ch].state = RC_SIGNAL_LOST;
                     RC_Channel[ch].acquireCount = 0;
                 }            
@@ -223,40 +264,36 @@ void ProcessChannelPulses(void)
 void CheckRCStatus(void)
 {
     uint32_t        uS;                         // Temp variable to hold the current time in microseconds                        
-    static uint32_t TimeLastRCCheck = 0;        // Time we last did a watchdog check on the RC signal
     uint8_t         countOverdue = 0;           // How many channels are overdue (disconnected)
 
     // The RC pin change ISRs will try to determine the status of each channel, but of course if a channel becomes disconnected the ISR won't even trigger. 
-    // So we have the main loop poll this function to do an overt check once every so often (RC_TIMEOUT_MS) 
-    if (millis() - TimeLastRCCheck > RC_TIMEOUT_MS)
-    {
-        TimeLastRCCheck = millis();
-        uS = micros();                          // Current time
-        cli();                                  // We need to disable interrupts for this check, otherwise value of (uS - LastGoodPulseTime) could return very big number if channel updates in the middle of the check
-            for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+    // So the scheduler runs this function as its own task to do an overt check once every RC_TIMEOUT_MS (see TASK_STATUS in OSL_Settings.h)
+    uS = micros();                          // Current time
+    cli();                                  // We need to disable interrupts for this check, otherwise value of (uS - LastGoodPulseTime) could return very big number if channel updates in the middle of the check
+        for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
+        {
+            if ((uS - RC_Channel[i].lastGoodPulseTime) > RC_TIMEOUT_US) 
             {
-                if ((uS - RC_Channel[i].lastGoodPulseTime) > RC_TIMEOUT_US) 
+                countOverdue += 1;
+                // If this channel had previously been synched, set it now to lost
+                if (RC_Channel[i].state == RC_SIGNAL_SYNCHED)
                 {
-                    countOverdue += 1;
-                    // If this channel had previously been synched, set it now to lost
-                    if (RC_Channel[i].state == RC_SIGNAL_SYNCHED)
-                    {
-                        RC_Channel[i].state = RC_SIGNAL_LOST;
-                        RC_Channel[i].acquireCount = 0;
-                        // if (DEBUG) Serial.print(F("Channel ")); Serial.print(i+1); Serial.println(F(" lost!")); 
-                    }
+                    RC_Channel[i].state = RC_SIGNAL_LOST;
+                    RC_Channel[i].acquireCount = 0;
+                    TRACE_EVENT(TRACE_CHANNEL_STATE, i, RC_SIGNAL_LOST);
+                    // if (DEBUG) Serial.print(F("Channel ")); Serial.print(i+1); Serial.println(F(" lost!")); 
                 }
             }
-        sei();                                  // Resume interrupts
-        
-        if (countOverdue == NUM_RC_CHANNELS)
-        {   
-            RC_State = RC_SIGNAL_LOST;          // Ok, we've lost radio on all channels
         }
-
-        // If state has changed, update the LEDs
-        if (RC_State != Last_RC_State) ChangeRCState();
+    sei();                                  // Resume interrupts
+    
+    if (countOverdue == NUM_RC_CHANNELS)
+    {   
+        RC_State = RC_SIGNAL_LOST;          // Ok, we've lost radio on all channels
     }
+
+    // If state has changed, update the LEDs
+    if (RC_State != Last_RC_State) ChangeRCState();
 }
 
 void ChangeRCState(void)
@@ -285,14 +322,9 @@ void ChangeRCState(void)
     }
 
     Last_RC_State = RC_State;
+    TRACE_EVENT(TRACE_RC_STATE, RC_State, 0);
 
-    if (DEBUG) 
-    {
-        Serial.print(F("Radio state change: "));
-        Serial.print(printRadioState(RC_State));
-        if (RC_State == RC_SIGNAL_LOST) Serial.print(F("!"));
-        Serial.println();
-    }
+    if (DEBUG) QueueDebugMessage(DBG_RADIO_STATE, RC_State, 0);
 }
 
 void ProcessRCCommand(_rc_channel &ch)
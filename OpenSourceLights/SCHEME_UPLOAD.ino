@@ -0,0 +1,199 @@
+// SCHEME UPLOAD - receive light schemes over the serial port and store them in the EEPROM scheme bank
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Frames are parsed one byte at a time as they arrive, so this never holds up the main loop. The frame format and reply codes are described in
+// OSL_Settings.h, and tools/osl_scheme_upload.py is a host-side script that speaks the protocol.
+//
+// Nothing is written to EEPROM until a complete frame has been received and validated. The slot is then handed to the background EEPROM writer
+// (src/OSL_EEPROMWriter) as room comes free in its queue, so nothing waits on the 3.3 mS each byte takes to write. The slot's version byte is
+// marked empty before the first byte is written and only set again after the CRC has been stored, so a power loss part-way through a commit leaves
+// an empty slot - and the scheme from AA_LightSetup - rather than a half-written scheme. The slot's CRC is calculated from the bytes as they are
+// queued; the reply, which checks the slot over, waits until the writer has finished so reading it back doesn't wait on every byte.
+
+#define US_WAIT_SOF         0
+#define US_CMD              1
+#define US_SCHEME           2
+#define US_VERSION          3
+#define US_LENGTH           4
+#define US_PAYLOAD          5
+#define US_CRC_HI           6
+#define US_CRC_LO           7
+#define US_COMMIT           8
+#define US_VERIFY           9
+
+void ProcessSchemeUpload()
+{
+    static uint8_t  state = US_WAIT_SOF;
+    static uint8_t  cmd;
+    static uint8_t  scheme;
+    static uint8_t  version;
+    static uint8_t  length;
+    static uint8_t  count;
+    static uint16_t crc;
+    static uint16_t rxCRC;
+    static uint32_t lastByteTime;
+    static uint8_t  buffer[EEPROM_SCHEME_SLOTS ? EEPROM_SCHEME_DATA_SIZE : 1];     // Nothing can be uploaded with no slots, don't spend the RAM
+    uint16_t addr;
+    uint8_t  c;
+    uint8_t  i;
+    uint8_t  status;
+
+    // Commit a validated scheme to EEPROM, as much as there is room for in the write queue
+    if (state == US_COMMIT)
+    {
+        addr = SchemeSlotAddress(scheme);
+        for ( ; EEPROMWriter.room() > 0 && count<length; count++)
+        {
+            EEPROMWriter.write(addr + EEPROM_SCHEME_HEADER_SIZE + count, buffer[count]);
+            crc = _crc_xmodem_update(crc, buffer[count]);
+        }
+        if (count < length || EEPROMWriter.room() < 3) return;
+
+        // All settings queued, now the CRC and last of all the version byte, which is what makes the slot valid. The queue is written in order.
+        EEPROMWriter.writeBlock(&crc, addr + 2, sizeof(crc));
+        EEPROMWriter.write(addr, SCHEME_FORMAT_VERSION);
+        state = US_VERIFY;
+        return;
+    }
+
+    // Once it has all been written, check the slot and reply
+    if (state == US_VERIFY)
+    {
+        if (!EEPROMWriter.idle()) return;
+        SchemeUploadReply(UPLOAD_CMD_WRITE, SchemeSlotValid(scheme) ? UPLOAD_OK : UPLOAD_ERR_CRC);
+        SchemeUploadChanged(scheme);
+        state = US_WAIT_SOF;
+        return;
+    }
+
+    // Throw away a frame that has stalled part-way through
+    if (state != US_WAIT_SOF && (millis() - lastByteTime) > UPLOAD_TIMEOUT_MS) state = US_WAIT_SOF;
+
+    while (Serial.available())
+    {
+        c = Serial.read();
+        lastByteTime = millis();
+
+        switch (state)
+        {
+            case US_WAIT_SOF:
+                if (c == UPLOAD_SOF) { crc = 0; state = US_CMD; }
+                else SerialCommand(c);                                                      // Not an upload, maybe a command from the serial monitor
+                break;
+
+            case US_CMD:
+                cmd = c;
+                crc = _crc_xmodem_update(crc, c);
+                state = US_SCHEME;
+                break;
+
+            case US_SCHEME:
+                scheme = c;
+                crc = _crc_xmodem_update(crc, c);
+                state = US_VERSION;
+                break;
+
+            case US_VERSION:
+                version = c;
+                crc = _crc_xmodem_update(crc, c);
+                state = US_LENGTH;
+                break;
+
+            case US_LENGTH:
+                length = c;
+                count = 0;
+                crc = _crc_xmodem_update(crc, c);
+                if (length > sizeof(buffer))
+                {   // We can't hold it, and nothing good can come of trying to re-synch in the middle of a payload
+                    SchemeUploadReply(cmd, UPLOAD_ERR_LENGTH);
+                    state = US_WAIT_SOF;
+                }
+                else state = (length > 0) ? US_PAYLOAD : US_CRC_HI;
+                break;
+
+            case US_PAYLOAD:
+                buffer[count++] = c;
+                crc = _crc_xmodem_update(crc, c);
+                if (count >= length) state = US_CRC_HI;
+                break;
+
+            case US_CRC_HI:
+                rxCRC = (uint16_t)c << 8;
+                state = US_CRC_LO;
+                break;
+
+            case US_CRC_LO:
+                rxCRC |= c;
+                state = US_WAIT_SOF;
+
+                // Complete frame received, check it over
+                if (rxCRC != crc)                                                           status = UPLOAD_ERR_CRC;
+                else if (cmd == UPLOAD_CMD_INFO)                                            status = UPLOAD_OK;
+                else if (cmd != UPLOAD_CMD_WRITE && cmd != UPLOAD_CMD_ERASE)                status = UPLOAD_ERR_COMMAND;
+                else if (scheme < 1 || scheme > MIN(NumSchemes, EEPROM_SCHEME_SLOTS))       status = UPLOAD_ERR_SCHEME;
+                else if (cmd == UPLOAD_CMD_ERASE)                                           status = UPLOAD_OK;
+                else if (version != SCHEME_FORMAT_VERSION)                                  status = UPLOAD_ERR_VERSION;
+                else if (length != EEPROM_SCHEME_DATA_SIZE)                                 status = UPLOAD_ERR_LENGTH;
+                else
+                {
+                    status = UPLOAD_OK;
+                    for (i=0; i<length; i++)
+                    {
+                        if (buffer[i] >= LS_UNKNOWN) { status = UPLOAD_ERR_SETTING; break; }
+                    }
+                }
+
+                if (status != UPLOAD_OK)
+                {
+                    SchemeUploadReply(cmd, status);
+                }
+                else if (cmd == UPLOAD_CMD_INFO)
+                {
+                    SchemeUploadReply(cmd, status);
+                    Serial.write((uint8_t)SCHEME_FORMAT_VERSION);
+                    Serial.write((uint8_t)NumLights);
+                    Serial.write((uint8_t)NumStates);
+                    Serial.write((uint8_t)NumSchemes);
+                    Serial.write((uint8_t)EEPROM_SCHEME_SLOTS);
+                }
+                else if (cmd == UPLOAD_CMD_ERASE)
+                {
+                    EraseSchemeSlot(scheme);
+                    SchemeUploadReply(cmd, status);
+                    SchemeUploadChanged(scheme);
+                }
+                else
+                {   // Invalidate the slot first, then start the commit. The reply goes out once it is done.
+                    addr = SchemeSlotAddress(scheme);
+                    EEPROMWriter.write(addr, EEPROM_SCHEME_SLOT_EMPTY);
+                    EEPROMWriter.write(addr + 1, NumLights);
+                    crc = _crc_xmodem_update(0, SCHEME_FORMAT_VERSION);                     // The slot CRC, see SchemeSlotCRC()
+                    crc = _crc_xmodem_update(crc, NumLights);
+                    count = 0;
+                    state = US_COMMIT;
+                    return;                                                                 // Leave any further bytes in the serial buffer until we're done
+                }
+                break;
+
+            default:
+                state = US_WAIT_SOF;
+        }
+    }
+}
+
+void SchemeUploadReply(uint8_t cmd, uint8_t status)
+{
+    Serial.write((uint8_t)UPLOAD_SOF);
+    Serial.write(cmd);
+    Serial.write(status);
+}
+
+void SchemeUploadChanged(uint8_t WhatScheme)
+{   // If the scheme that was just written or erased is the one in use, reload it. Clearing CurrentLightSetting forces SetLights to re-apply
+    // every light on the next pass even if its setting number hasn't changed. Shelf-queen mode is left alone, it only sets the lights once.
+    if (WhatScheme == CurrentScheme && !shelfQueenMode)
+    {
+        SetLightScheme(CurrentScheme);
+        for (uint8_t i=0; i<NumLights; i++) CurrentLightSetting[i] = LS_UNKNOWN;
+    }
+    if (DEBUG) QueueDebugMessage(DBG_SCHEME_CHANGED, WhatScheme, SchemeSlotValid(WhatScheme));
+}
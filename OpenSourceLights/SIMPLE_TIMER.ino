@@ -4,7 +4,7 @@
 unsigned int StartWaiting_mS(int mS)
 {
     TimeUp = false;
-    return timer.setTimeout(mS, SetTimeUp);    // will call function once after ms duration
+    return timer.setTimeout(mS, TimerSetFlag, &TimeUp);    // will set TimeUp once after ms duration
 }
 
 
@@ -14,15 +14,17 @@ unsigned int StartWaiting_sec(int seconds)
 }
 
 
-void SetTimeUp()
+// Generic callbacks for timers that only need to set or clear a flag when they expire. Pass the address of the flag as the timer parameter, 
+// eg: timer.setTimeout(500, TimerClearFlag, &Overtaking); Any single-byte variable works (boolean, int8_t, uint8_t). 
+void TimerSetFlag(void *flag)
 {
-    TimeUp = true;
+    *(uint8_t *)flag = true;
 }
 
 
-void ExitChangeSchemeMode()
+void TimerClearFlag(void *flag)
 {
-    ChangeSchemeMode = false;    // As soon as this gets set to false, Change-Scheme-Mode exits
+    *(uint8_t *)flag = 0;
 }
 
 
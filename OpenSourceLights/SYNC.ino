@@ -0,0 +1,96 @@
+// MULTI-BOARD SYNC - one board reads the radio and sends the vehicle state to the others
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Only runs if SyncRole is SYNC_MASTER or SYNC_FOLLOWER in AA_UserConfig.h. The frame is described in src/OSL_SyncLink, the state word and timings
+// under MULTI-BOARD SYNC in OSL_Settings.h
+
+// The master's frames should use no more than a quarter of what the serial port can carry (BaudRate / 10 bytes per second)
+static_assert(SYNC_FRAME_BYTES * (1000UL / SYNC_INTERVAL_MS) <= (BaudRate / 10) / 4, "SYNC_INTERVAL_MS is too short for the serial port's baud rate");
+// Anything else the master sends out its serial port goes to the followers too, and breaks up the frames
+static_assert(!(SyncRole == SYNC_MASTER && (EnableTelemetry || DEBUG)), "Set DEBUG and EnableTelemetry to false on a sync master, the link uses its serial port");
+
+void Task_Sync()
+{
+    static OSL_SyncLink link;
+    static uint32_t     phaseStart = 0;
+    static uint8_t      phase = 0;
+    static uint32_t     lastFrame = 0;
+    static boolean      heard = false;
+    uint16_t            period = UserParams.blinkInterval * 2;      // One BLINK cycle
+
+    if (SyncRole == SYNC_MASTER)
+    {
+        // Start a new phase every blink cycle, and restart our own blinks on it. The followers do the same when they see it.
+        if ((millis() - phaseStart) >= period)
+        {
+            phaseStart = millis();
+            phase++;
+            SyncBlinks(period);
+        }
+        link.send(Serial, PackSyncState(), phase);                  // Skipped if the transmit buffer is too full, there'll be another shortly
+    }
+    else
+    {
+        while (Serial.available())
+        {
+            if (!link.receive(Serial.read())) continue;
+            if (heard && link.phase() != phase) SyncBlinks(period);
+            phase = link.phase();
+            UnpackSyncState(link.state());
+            lastFrame = millis();
+            heard = true;
+        }
+        // Until we hear from the master our RC state stays uninitialized, just as if we had our own radio and it wasn't on yet
+        if (heard && (millis() - lastFrame) > SYNC_TIMEOUT_MS) RC_State = RC_SIGNAL_LOST;
+        if (RC_State != Last_RC_State) ChangeRCState();
+    }
+}
+
+void SyncBlinks(uint16_t period)
+{
+    for (uint8_t i=0; i<NumLights; i++) LightOutput[i].syncBlink(period);
+}
+
+uint8_t EncodeSyncTurn(int8_t turn)
+{
+    if (turn > 0) return 1;
+    if (turn < 0) return 2;
+    return 0;
+}
+
+int8_t DecodeSyncTurn(uint8_t bits)
+{
+    if (bits == 1) return RIGHT_TURN;
+    if (bits == 2) return LEFT_TURN;
+    return NO_TURN;
+}
+
+uint16_t PackSyncState()
+{   // Everything SetLights looks at on a follower. Turns only need their direction.
+    uint16_t state;
+
+    state  = (uint16_t)(Drive.mode() & 0x03)                << SYNC_DRIVE_MODE_SHIFT;
+    state |= (uint16_t)(Channel3Command & 0x07)             << SYNC_CHANNEL3_SHIFT;
+    state |= (uint16_t)EncodeSyncTurn(TurnCommand)          << SYNC_TURN_SHIFT;
+    state |= (uint16_t)EncodeSyncTurn(TurnSignalOverride)   << SYNC_OVERRIDE_SHIFT;
+    state |= (uint16_t)(RC_State & 0x03)                    << SYNC_RC_STATE_SHIFT;
+    if (Braking)            state |= SYNC_BRAKING;
+    if (StoppedLongTime)    state |= SYNC_STOPPED_LONG;
+    if (TurnSignal_Enable)  state |= SYNC_TURN_SIGNAL_ENABLE;
+    if (canBackfire)        state |= SYNC_BACKFIRE;
+    if (Overtaking)         state |= SYNC_OVERTAKING;
+    return state;
+}
+
+void UnpackSyncState(uint16_t state)
+{
+    SyncDriveMode      = (state >> SYNC_DRIVE_MODE_SHIFT) & 0x03;
+    Channel3Command    = (state >> SYNC_CHANNEL3_SHIFT) & 0x07;
+    TurnCommand        = DecodeSyncTurn((state >> SYNC_TURN_SHIFT) & 0x03);
+    TurnSignalOverride = DecodeSyncTurn((state >> SYNC_OVERRIDE_SHIFT) & 0x03);
+    RC_State           = (state >> SYNC_RC_STATE_SHIFT) & 0x03;
+    Braking            = state & SYNC_BRAKING;
+    StoppedLongTime    = state & SYNC_STOPPED_LONG;
+    TurnSignal_Enable  = state & SYNC_TURN_SIGNAL_ENABLE;
+    canBackfire        = state & SYNC_BACKFIRE;
+    Overtaking         = state & SYNC_OVERTAKING;
+}
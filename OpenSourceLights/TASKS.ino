@@ -0,0 +1,91 @@
+// TASKS - everything the firmware does, split up by how often it needs to happen
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// These are run by the OSL_Scheduler object "Scheduler" (see PerLoopUpdates). The task numbers, periods and time budgets are defined in OSL_Settings.h
+// under TASK SCHEDULER. The scheduler checks them in task-number order, so the most urgent come first.
+
+void StartTasks()
+{
+    Scheduler.setTask(TASK_RC,      Task_RC,        TASK_RC_PERIOD_US,      TASK_RC_BUDGET_US);
+    Scheduler.setTask(TASK_SERIAL,  Task_Serial,    TASK_SERIAL_PERIOD_US,  TASK_SERIAL_BUDGET_US);
+    Scheduler.setTask(TASK_LIGHTS,  Task_Lights,    TASK_LIGHTS_PERIOD_US,  TASK_LIGHTS_BUDGET_US);
+    Scheduler.setTask(TASK_VEHICLE, VehicleLogic,   TASK_VEHICLE_PERIOD_US, TASK_VEHICLE_BUDGET_US);     // VehicleLogic is on the main tab
+    Scheduler.setTask(TASK_STATUS,  Task_Status,    TASK_STATUS_PERIOD_US,  TASK_STATUS_BUDGET_US);
+    if (EnableTelemetry) 
+    Scheduler.setTask(TASK_TELEMETRY, Task_Telemetry, TASK_TELEMETRY_PERIOD_US, TASK_TELEMETRY_BUDGET_US);     // On the TELEMETRY tab
+    Scheduler.setTask(TASK_SETUP,   Task_RadioSetup, TASK_SETUP_PERIOD_US,  TASK_SETUP_BUDGET_US);       // On the RADIO_SETUP tab
+    if (SyncRole != SYNC_OFF)
+    Scheduler.setTask(TASK_SYNC,    Task_Sync,      TASK_SYNC_PERIOD_US,    TASK_SYNC_BUDGET_US);        // On the SYNC tab
+    if (PixelCount > 0)
+    Scheduler.setTask(TASK_PIXELS,  Task_Pixels,    TASK_PIXELS_PERIOD_US,  TASK_PIXELS_BUDGET_US);      // On the PIXELS tab
+}
+
+void Task_RC()
+{
+    // RC signals are measured through pin change ISRs (interrupt service routines). The signal starts on a rising edge and ends on a falling edge, the time between them is recorded 
+    // and a flag is then set. ProcessChannelPulses checks each channel for the presence of this flag, checks the pulse width and if valid takes whatever action is required. 
+    PROFILE_START(PROF_RC_PULSES);
+    ProcessChannelPulses();
+    PROFILE_END(PROF_RC_PULSES);
+}
+
+void Task_Serial()
+{
+    // Light schemes can be uploaded over the serial port and stored in EEPROM. Bytes are read as they arrive, nothing here waits on the port.
+    // Anything that isn't part of an upload goes to the console (see the CONSOLE tab), which also saves parameters to EEPROM a few bytes per pass.
+    // On a follower the port belongs to the sync link, which reads it in its own task.
+    if (SyncRole != SYNC_FOLLOWER)
+    {
+        if (EnableSchemeUpload) ProcessSchemeUpload();
+        else while (Serial.available()) SerialCommand(Serial.read());
+    }
+    SaveUserParams(false);
+    // Print any debug messages that are waiting, as long as there is room in the transmit buffer (see the DEBUG_QUEUE tab)
+    DrainDebugQueue();
+}
+
+void Task_Lights()
+{
+    PROFILE_START(PROF_TIMER);
+    timer.run();                            // SimpleTimer object, used for various timing tasks. Must be polled. 
+    PROFILE_END(PROF_TIMER);
+    PROFILE_START(PROF_LEDS);
+    RedLED.update();                        // Led handlers must be polled
+    GreenLED.update();                      // " "
+    for (uint8_t i=0; i<NumLights; i++)    // " "
+    {
+        LightOutput[i].update();
+    }
+    PROFILE_END(PROF_LEDS);
+}
+
+void Task_Status()
+{
+    // The RC pin change ISRs will try to determine the status of each channel, but of course if a channel becomes disconnected its ISR won't even trigger. 
+    // So we also force a check every so often, but only if we are not in shelf-queen mode
+    PROFILE_START(PROF_RC_CHECK);
+    if (!shelfQueenMode && SyncRole != SYNC_FOLLOWER) CheckRCStatus();     // A follower's RC state comes from the master
+    PROFILE_END(PROF_RC_CHECK);
+    if (EnableAutoCalibration) UpdateAutoCalibration();     // Apply what's been learned about the channel endpoints and centers, about once a second
+}
+
+void PrintTaskStats()
+{
+    Serial.println();
+    PrintLine(80);
+    Serial.println(F("TASK        Runs        Max uS  Budget  Overruns  Skipped"));
+    PrintLine(80);
+    for (uint8_t i=0; i<=LAST_TASK; i++)
+    {
+        const SchedulerTask &t = Scheduler.get(i);
+        Serial.print(printTaskName(i));
+        PrintSpaces(12 - strlen_P((const char *)printTaskName(i)));
+        Serial.print(t.runs);       PrintSpaces(4);
+        Serial.print(t.maxTime);    PrintSpaces(4);
+        Serial.print(t.budget);     PrintSpaces(4);
+        Serial.print(t.overruns);   PrintSpaces(4);
+        Serial.println(t.skipped);
+    }
+    PrintLine(80);
+    if (PixelCount > 0) { Serial.print(F("Pixel frames sent again: ")); Serial.println(PixelOutput.restarts()); }     // See ADDRESSABLE PIXELS in OSL_Settings.h
+    Scheduler.resetStats();
+}
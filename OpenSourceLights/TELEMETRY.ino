@@ -0,0 +1,33 @@
+// TELEMETRY - a binary snapshot of the radio inputs, drive mode and light outputs, sent every TelemetryInterval_mS
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Only runs if EnableTelemetry = true in AA_UserConfig.h. The frame layout and encoding are described in src/OSL_Telemetry, tools/osl_telemetry.py 
+// decodes and plots the stream. 
+
+// Telemetry should never take more than half of what the serial port can carry (BaudRate / 10 bytes per second), leave the rest for replies and debug text. The frame grows with NumLights.
+static_assert(!EnableTelemetry || TELEMETRY_WIRE_BYTES * (1000UL / TelemetryInterval_mS) <= (BaudRate / 10) / 2, "TelemetryInterval_mS is too short for the serial port's baud rate");
+// A frame is only sent when it fits in the serial transmit buffer (64 bytes, at most 63 free), so a longer one would never go out
+static_assert(!EnableTelemetry || TELEMETRY_WIRE_BYTES <= 63, "The telemetry frame is too long for the serial transmit buffer, there are too many lights");
+
+void Task_Telemetry()
+{
+    static OSL_Telemetry telemetry;
+    TelemetryFrame &f = telemetry.frame;
+    uint8_t i;
+
+    f.time = millis();
+    for (i=0; i<NUM_RC_CHANNELS; i++) f.pulse[i] = RC_Channel[i].pulse;
+    f.throttle = ThrottleCommand;
+    f.turn = TurnCommand;
+    f.channel3 = Channel3Command;
+    f.rcState = RC_State;
+    f.driveMode = Drive.mode();
+    f.flags = (Braking ? TELEM_BRAKING : 0) | (Accelerating ? TELEM_ACCELERATING : 0) | (Decelerating ? TELEM_DECELERATING : 0) | 
+              (StoppedLongTime ? TELEM_STOPPED_LONG : 0) | (Failsafe ? TELEM_FAILSAFE : 0);
+    for (i=0; i<NumLights; i++)
+    {
+        f.setting[i] = CurrentLightSetting[i];
+        f.level[i] = LightOutput[i].level();
+    }
+
+    telemetry.send(Serial);                 // Skipped if the transmit buffer is too full, we'll catch up on the next one
+}
@@ -1,26 +1,11 @@
 
 void PerLoopUpdates()
 {
-    // Handle any radio pulses that have come in
-    // ------------------------------------------------------------------------------------------------------------------------------------------------>  
-        // RC signals are measured through pin change ISRs (interrupt service routines). The signal starts on a rising edge and ends on a falling edge, the time between them is recorded 
-        // and a flag is then set. ProcessChannelPulses checks each channel for the presence of this flag, checks the pulse width and if valid takes whatever action is required. 
-        ProcessChannelPulses();
-        // The RC pin change ISRs will try to determine the status of each channel, but of course if a channel becomes disconnected its ISR won't even trigger. 
-        // So we also force a check from the main loop, but only if we are not in shelf-queen mode
-        if (!shelfQueenMode) CheckRCStatus();
-
-    
-    // Per loop updates that have to be polled
-    // ------------------------------------------------------------------------------------------------------------------------------------------------>      
-        timer.run();                            // SimpleTimer object, used for various timing tasks. Must be polled. 
-        InputButton.read();                     // Button must be polled
-        RedLED.update();                        // Led handlers must be polled
-        GreenLED.update();                      // " "
-        for (uint8_t i=0; i<NumLights; i++)    // " "
-        {
-            LightOutput[i].update();
-        }
+    // One pass of the task scheduler. Anything that has to wait for something calls this so the radio, lights and timers keep running while it does. 
+    // The task doing the waiting is skipped until it returns, the others run as normal. The tasks themselves are on the TASKS tab.
+    PROFILE_START(PROF_PERLOOP);                // The PROFILE macros do nothing unless PROFILER is set to true in AA_UserConfig.h
+    Scheduler.run();
+    PROFILE_END(PROF_PERLOOP);
 }
 
 void delayWhilePolling(uint16_t waitTime)
@@ -31,6 +16,92 @@ void delayWhilePolling(uint16_t waitTime)
     } while (wait < waitTime);
 }
 
+void IdleUntilNextEvent()
+{
+    // Sleep until the next task, timer or light effect is due, or until a radio pulse or serial data arrives. See IDLE SLEEP in OSL_Settings.h
+    static uint32_t statsStart = 0;
+    static uint32_t asleep_uS = 0;
+    uint32_t        wait;
+    uint32_t        next;
+    uint32_t        startTime;
+    uint32_t        sleepStart;
+    boolean         wake = false;
+
+    if (!EnableIdleSleep) return;
+
+    // Find the nearest deadline
+    wait = timer.msUntilNextTimer();
+    next = RedLED.msUntilNextUpdate();                              if (next < wait) wait = next;
+    next = GreenLED.msUntilNextUpdate();                            if (next < wait) wait = next;
+    for (uint8_t i=0; i<NumLights; i++)
+    {   next = LightOutput[i].msUntilNextUpdate();                  if (next < wait) wait = next; }
+    // The lights task runs every millisecond but only has real work to do when a timer or light effect (above) is due, so we can sleep through it
+    next = Scheduler.timeUntilNextTask(TASK_LIGHTS);
+    if (next != OSL_Scheduler::NO_TASK_DUE) 
+    {   next = (next + 999) / 1000;                                 if (next < wait) wait = next; }
+
+    if (wait > 0)
+    {
+        sleepStart = micros();
+        startTime = millis();
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        do {
+            // Interrupts are disabled while we check for work so that a pulse or byte arriving between the check and the sleep instruction can't 
+            // leave us asleep with it unhandled. sei() takes effect only after the following instruction, so sleep_cpu() is reached before any ISR runs.
+            cli();
+            for (uint8_t i=0; i<NUM_RC_CHANNELS; i++) { if (RC_Channel[i].readyForUpdate) wake = true; }
+            if (Serial.available()) wake = true;
+            if (wake) { sei(); break; }
+            sleep_enable();
+            sei();
+            sleep_cpu();
+            sleep_disable();
+        } while ((millis() - startTime) < wait);
+        asleep_uS += micros() - sleepStart;
+    }
+
+    if (DEBUG && (millis() - statsStart) >= IDLE_STATS_INTERVAL_MS)
+    {   // Time asleep includes the brief wake-ups for the millis() interrupt, so this slightly overstates it
+        QueueDebugMessage(DBG_IDLE_STATS, 0, (int16_t)((float)asleep_uS / ((float)(millis() - statsStart)) + 0.5));
+        statsStart = millis();
+        asleep_uS = 0;
+    }
+}
+
+#if PROFILER
+void PrintProfile()
+{
+    Serial.println();
+    PrintLine(80);
+    Serial.println(F("PROFILE (uS)        Count       Min     Avg     Max"));
+    PrintLine(80);
+    for (uint8_t i=0; i<PROFILE_SECTIONS; i++)
+    {
+        const ProfileSection &s = Profiler.get(i);
+        Serial.print(printProfileSection(i));
+        PrintSpaces(20 - strlen_P((const char *)printProfileSection(i)));
+        Serial.print(s.count);      PrintSpaces(4);
+        if (s.count == 0) { Serial.println(F("-")); continue; }
+        Serial.print(s.min);        PrintSpaces(4);
+        Serial.print(s.total / s.count); PrintSpaces(4);
+        Serial.println(s.max);
+    }
+    Serial.println();
+    Serial.print(F("Histogram (counts of samples under "));
+    for (uint8_t b=0; b<PROFILE_BUCKETS-1; b++) { Serial.print(Profiler.bucketLimit(b)); Serial.print(F(", ")); }
+    Serial.println(F("or more uS)"));
+    for (uint8_t i=0; i<PROFILE_SECTIONS; i++)
+    {
+        const ProfileSection &s = Profiler.get(i);
+        Serial.print(printProfileSection(i));
+        PrintSpaces(20 - strlen_P((const char *)printProfileSection(i)));
+        for (uint8_t b=0; b<PROFILE_BUCKETS; b++) { Serial.print(s.bucket[b]); Serial.print(F(" ")); }
+        Serial.println();
+    }
+    PrintLine(80);
+}
+#endif
+
 void DumpSystemInfo()
 {
     // Give the radio some time to detect channels
@@ -51,7 +122,7 @@ void DumpSystemInfo()
     Serial.println();
     Serial.println(F("CHANNEL SETTINGS"));
     PrintLine(80);
-    Serial.println(F("Channel       Min       Center    Max       Reversed    Smoothed    Status"));
+    PrintWaiting(F("Channel       Min       Center    Max       Reversed    Smoothed    Status")); Serial.println();
     PrintLine(80);
     for (uint8_t i=0; i<NUM_RC_CHANNELS; i++)
     {
@@ -86,44 +157,33 @@ void DumpLightSchemeToSerial(int WhatScheme)
     uint8_t j;
     uint8_t whatSetting;
     uint8_t padding;
+    boolean fromEEPROM;
     
     if (WhatScheme <= NumSchemes)
-    {   // Schemes are zero-based, so if they pass Scheme 1 what we really want to show is Scheme 0
-        WhatScheme -= 1;
+    {
+        fromEEPROM = SchemeSlotValid(WhatScheme);
         Serial.print(F("Active Scheme: "));
-        Serial.print(WhatScheme+1);
+        Serial.print(WhatScheme);
+        if (fromEEPROM) Serial.print(F(" (uploaded)"));
         Serial.println();
         PrintLine(80);
-        Serial.print(F("Light   ")); 
-        Serial.print(F("Pos 1           Pos 2           Pos 3           Pos 4           Pos 5           "));
-        PerLoopUpdates();
-        Serial.print(F("Forward         Reverse         Stop            StopDelay       Brake           "));
-        PerLoopUpdates();
-        Serial.print(F("Right Turn      Left Turn       No Turn         Accelerating    Decelerating    "));
-        PerLoopUpdates();
+        // This line is much longer than the transmit buffer, PrintWaiting and PrintLine keep the radio and lights going while it goes out
+        PrintWaiting(F("Light   ")); 
+        PrintWaiting(F("Pos 1           Pos 2           Pos 3           Pos 4           Pos 5           "));
+        PrintWaiting(F("Forward         Reverse         Stop            StopDelay       Brake           "));
+        PrintWaiting(F("Right Turn      Left Turn       No Turn         Accelerating    Decelerating    "));
         Serial.println();
-        // If we try to print the full line all at once, we will lose track of the radio. 
-        // This is kind of silly but we break it up. Would be better to program the ability to temporarily suspend radio
-        // reads without changing RC_State but I'm too lazy.
-        PrintLineWOLineBreak(50);
-        PerLoopUpdates();
-        PrintLineWOLineBreak(50);
-        PerLoopUpdates();
-        PrintLineWOLineBreak(50);
-        PerLoopUpdates();
-        PrintLineWOLineBreak(50);
-        PerLoopUpdates();
-        PrintLine(44);      // We want 244 dashes
+        PrintLine(244);
         for (i=0; i<NumLights; i++)
         {
-            PerLoopUpdates();
+            WaitForSerial(10);
             Serial.print(F(" "));
             Serial.print(i+1);
             Serial.print(F("      "));
             for (j=0; j<NumStates; j++)
             {
-                PerLoopUpdates();
-                whatSetting = pgm_read_word_near(&(Schemes[WhatScheme][i][j]));
+                WaitForSerial(DEBUG_MESSAGE_MAX);
+                whatSetting = ReadSchemeSetting(WhatScheme, i, j, fromEEPROM);
                 padding = pgm_read_word_near(&(_SettingNamesPadding[whatSetting]));
                 // Serial.print(whatSetting,DEC);
                 // Serial.print(padding, DEC);
@@ -169,6 +229,7 @@ void PrintSpaces(uint8_t spaces)
 {
     for (uint8_t i=0; i<spaces; i++)
     {
+        WaitForSerial(1);
         PrintSpace();
     }
 }
@@ -178,6 +239,7 @@ void PrintLineWOLineBreak(uint8_t len)
 {
     for (uint8_t i=0; i<len; i++)
     {
+        WaitForSerial(1);
         Serial.print(F("-"));
     }    
 }
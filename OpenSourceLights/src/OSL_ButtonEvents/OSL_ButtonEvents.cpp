@@ -0,0 +1,120 @@
+/* OSL_ButtonEvents.cpp Button Events - debounces the setup button in a timer interrupt and queues clicks, double clicks and long presses
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "OSL_ButtonEvents.h"
+#include <avr/interrupt.h>
+
+OSL_ButtonEvents InputButton;
+
+
+ISR(TIMER2_OVF_vect)
+{
+    InputButton.tick();
+}
+
+void OSL_ButtonEvents::begin(uint8_t pin, boolean puEnable, boolean invert)
+{
+    uint8_t oldSREG;
+
+    pinMode(pin, puEnable ? INPUT_PULLUP : INPUT);
+    oldSREG = SREG;
+    cli();
+    _port = portInputRegister(digitalPinToPort(pin));
+    _mask = digitalPinToBitMask(pin);
+    _invert = invert;
+    _pressed = false;
+    _debounce = 0;
+    _ticks = 0;
+    _clicks = 0;
+    _long = false;
+    _head = 0;
+    _count = 0;
+    TIMSK2 |= _BV(TOIE2);                                                           // Timer2 is already running, Arduino set it up for PWM
+    SREG = oldSREG;
+}
+
+void OSL_ButtonEvents::tick(void)
+{   // Runs with interrupts off, once every BUTTON_TICK_US
+    boolean pin;
+
+    if (_port == 0) return;
+    pin = ((*_port & _mask) != 0) != _invert;
+    if (_ticks < 0xFFFF) _ticks++;
+
+    // Debounce: the pin has to read the other way for the whole debounce time before the state changes
+    if (pin == _pressed) _debounce = 0;
+    else if (++_debounce >= BUTTON_TICKS(BUTTON_DEBOUNCE_MS))
+    {
+        _debounce = 0;
+        _pressed = pin;
+        _ticks = 0;
+        if (_pressed) _long = false;
+        else if (!_long && ++_clicks >= 2)                                          // Let go after a short press
+        {
+            post(BUTTON_DOUBLE_CLICK);
+            _clicks = 0;
+        }
+        return;
+    }
+
+    // Time the press or the gap since the last click
+    if (_pressed)
+    {
+        if (!_long && _ticks >= BUTTON_TICKS(BUTTON_LONG_PRESS_MS))
+        {
+            post(BUTTON_LONG_PRESS);
+            _long = true;
+            _clicks = 0;                                                            // A click just before a long press is dropped
+            _ticks = 0;
+        }
+        else if (_long && _ticks >= BUTTON_TICKS(BUTTON_REPEAT_MS))
+        {
+            post(BUTTON_HOLD_REPEAT);
+            _ticks = 0;
+        }
+    }
+    else if (_clicks > 0 && _ticks >= BUTTON_TICKS(BUTTON_DOUBLE_CLICK_MS))
+    {
+        post(BUTTON_CLICK);
+        _clicks = 0;
+    }
+}
+
+void OSL_ButtonEvents::post(uint8_t event)
+{
+    if (_count >= BUTTON_EVENT_QUEUE_LENGTH) return;                                // Full, the main loop hasn't been keeping up
+    _queue[(_head + _count) % BUTTON_EVENT_QUEUE_LENGTH] = event;
+    _count++;
+}
+
+uint8_t OSL_ButtonEvents::getEvent(void)
+{
+    uint8_t oldSREG;
+    uint8_t event = BUTTON_NONE;
+
+    if (_count == 0) return BUTTON_NONE;
+    oldSREG = SREG;
+    cli();
+    event = _queue[_head];
+    _head = (_head + 1) % BUTTON_EVENT_QUEUE_LENGTH;
+    _count--;
+    SREG = oldSREG;
+    return event;
+}
@@ -0,0 +1,68 @@
+/* OSL_ButtonEvents.h   Button Events - debounces the setup button in a timer interrupt and queues clicks, double clicks and long presses
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * The button is read once per Timer2 overflow, which on the Nano happens every BUTTON_TICK_US (2.04 mS) because Arduino runs Timer2 for PWM.
+ * begin() only turns on the overflow interrupt, the timer itself is left alone. The interrupt debounces the pin, times each press and gap,
+ * and posts one of these events when it recognizes it:
+ *
+ *      BUTTON_CLICK            pressed and let go, and not pressed again within BUTTON_DOUBLE_CLICK_MS
+ *      BUTTON_DOUBLE_CLICK     two clicks within BUTTON_DOUBLE_CLICK_MS
+ *      BUTTON_LONG_PRESS       held for BUTTON_LONG_PRESS_MS. Letting go afterwards isn't a click.
+ *      BUTTON_HOLD_REPEAT      still held, every BUTTON_REPEAT_MS after the long press
+ *
+ * getEvent() takes the oldest event from the queue, or returns BUTTON_NONE. All the timings are under SETUP BUTTON in OSL_Settings.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OSL_ButtonEvents_h
+#define OSL_ButtonEvents_h
+
+#include <Arduino.h>
+#include "../OSL_Settings/OSL_Settings.h"
+
+#define BUTTON_TICKS(ms)    ((uint16_t)(((ms) * 1000UL + BUTTON_TICK_US - 1) / BUTTON_TICK_US))
+
+
+class OSL_ButtonEvents
+{   public:
+        OSL_ButtonEvents() : _port(0), _head(0), _count(0) {}
+
+        void    begin(uint8_t pin, boolean puEnable, boolean invert);   // pin, pull-up enable, inverted (low = pressed)
+        uint8_t getEvent(void);                                         // Oldest waiting event, or BUTTON_NONE
+        boolean isPressed(void) { return _pressed; }                    // Debounced state
+
+        void    tick(void);                                             // Called by the interrupt, not by you
+
+    private:
+        void    post(uint8_t event);
+
+        volatile uint8_t   *_port;                                      // Input register and bit of the pin, quicker than digitalRead
+        uint8_t             _mask;
+        boolean             _invert;
+        volatile boolean    _pressed;
+        uint8_t             _debounce;                                  // Ticks the pin has read differently from _pressed
+        uint16_t            _ticks;                                     // Ticks since the last press or release, stops at the longest time we care about
+        uint8_t             _clicks;                                    // Clicks waiting to see if they make a double click
+        boolean             _long;                                      // This press has already been a long press
+        uint8_t             _queue[BUTTON_EVENT_QUEUE_LENGTH];
+        uint8_t             _head;                                      // Oldest event
+        volatile uint8_t    _count;
+};
+
+extern OSL_ButtonEvents InputButton;
+
+#endif
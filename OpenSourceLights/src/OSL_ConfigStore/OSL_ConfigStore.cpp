@@ -0,0 +1,127 @@
+/* OSL_ConfigStore.cpp  Config Store - settings kept in EEPROM as a log of records spread over a ring of slots
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_ConfigStore.h"
+#include "../OSL_EEPROMWriter/OSL_EEPROMWriter.h"
+#include <util/crc16.h>
+
+
+void OSL_ConfigStore::begin(uint16_t start, uint8_t slots, uint8_t slotSize)
+{
+    _start = start;
+    _slots = slots;
+    _slotSize = slotSize;
+    _next = 0;
+    _sequence = 0;
+    _length = 0;
+}
+
+uint16_t OSL_ConfigStore::readWord(uint16_t address)
+{
+    return EEPROMWriter.read(address) | ((uint16_t)EEPROMWriter.read(address + 1) << 8);
+}
+
+uint16_t OSL_ConfigStore::slotCRC(uint8_t slot, uint8_t length)
+{
+    uint16_t addr = slotAddress(slot);
+    uint16_t crc = 0;
+    for (uint16_t i=0; i<CONFIG_STORE_HEADER_SIZE + length; i++)
+    {
+        crc = _crc_xmodem_update(crc, EEPROMWriter.read(addr + i));
+    }
+    return crc;
+}
+
+boolean OSL_ConfigStore::slotValid(uint8_t slot)
+{
+    uint16_t addr = slotAddress(slot);
+    uint8_t  version = EEPROMWriter.read(addr + 2);
+    uint8_t  length = EEPROMWriter.read(addr + 3);
+
+    if (version == 0 || version == 0xFF) return false;
+    if (length > _slotSize - CONFIG_STORE_OVERHEAD) return false;
+    return (readWord(addr + CONFIG_STORE_HEADER_SIZE + length) == slotCRC(slot, length));
+}
+
+uint8_t OSL_ConfigStore::load(void *data, uint8_t size)
+{
+    uint16_t addr;
+    uint16_t sequence;
+    uint16_t newest = 0;
+    int16_t  found = -1;
+    uint8_t  version;
+
+    for (uint8_t slot=0; slot<_slots; slot++)
+    {
+        if (!slotValid(slot)) continue;
+        sequence = readWord(slotAddress(slot));
+        // Sequence numbers wrap around, the difference tells us which is newer as long as they are within 32767 saves of each other
+        if (found < 0 || (int16_t)(sequence - newest) > 0)
+        {
+            found = slot;
+            newest = sequence;
+        }
+    }
+
+    _length = 0;
+    if (found < 0) return 0;                                                // Nothing saved yet, start at the first slot
+
+    addr = slotAddress(found);
+    version = EEPROMWriter.read(addr + 2);
+    _length = EEPROMWriter.read(addr + 3);
+    EEPROMWriter.readBlock(data, addr + CONFIG_STORE_HEADER_SIZE, min(_length, size));
+    _next = (found + 1) % _slots;
+    _sequence = newest + 1;
+    return version;
+}
+
+boolean OSL_ConfigStore::save(const void *data, uint8_t size, uint8_t version)
+{
+    uint16_t addr;
+    uint16_t crc = 0;
+    uint8_t  header[CONFIG_STORE_HEADER_SIZE];
+    uint8_t  slot = _next;
+
+    if (size > _slotSize - CONFIG_STORE_OVERHEAD) return false;
+
+    // The CRC goes in last (the EEPROM writer keeps the order). Until it does, the slot can't pass as a valid record, so the one before it stays the newest.
+    // It is worked out from the bytes in RAM as they are queued - reading them back would wait until the writer had written every one of them.
+    addr = slotAddress(slot);
+    header[0] = lowByte(_sequence);
+    header[1] = highByte(_sequence);
+    header[2] = version;
+    header[3] = size;
+    EEPROMWriter.writeBlock(header, addr, CONFIG_STORE_HEADER_SIZE);
+    EEPROMWriter.writeBlock(data, addr + CONFIG_STORE_HEADER_SIZE, size);
+    for (uint8_t i=0; i<CONFIG_STORE_HEADER_SIZE; i++) crc = _crc_xmodem_update(crc, header[i]);
+    for (uint8_t i=0; i<size; i++) crc = _crc_xmodem_update(crc, ((const uint8_t *)data)[i]);
+    EEPROMWriter.write(addr + CONFIG_STORE_HEADER_SIZE + size, lowByte(crc));
+    EEPROMWriter.write(addr + CONFIG_STORE_HEADER_SIZE + size + 1, highByte(crc));
+
+    _next = (slot + 1) % _slots;
+    _sequence++;
+    _length = size;
+    return true;
+}
+
+boolean OSL_ConfigStore::saved(void)
+{
+    return slotValid((_next + _slots - 1) % _slots);
+}
@@ -0,0 +1,70 @@
+/* OSL_ConfigStore.h    Config Store - settings kept in EEPROM as a log of records spread over a ring of slots
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Each save writes a complete new record into the next slot of the ring instead of rewriting the same bytes, so the wear is spread over 
+ * every slot. A record carries a sequence number, the schema version of the data, the data length and a CRC. On load, the valid record with 
+ * the highest sequence number wins. If power is lost part-way through a save, the half-written slot fails its CRC and the previous record 
+ * is used instead - nothing is ever erased first. 
+ *
+ * Writes go through the background EEPROM writer (OSL_EEPROMWriter), so save() returns as soon as the record is queued. To check it was 
+ * written, call saved() once the writer is idle - any sooner and reading it back waits for the writing to finish.
+ *
+ * The store doesn't know what the data means. load() reports the schema version and length of what it found, and it is up to the caller 
+ * to bring data written by older firmware up to date (see MigrateConfig on the EEPROM tab). 
+ *
+ * Slot layout:     bytes 0-1   sequence number, low byte first
+ *                  byte  2     schema version (0 and 0xFF are never valid)
+ *                  byte  3     data length
+ *                  bytes 4...  data
+ *                  last 2      CRC-16/XMODEM over everything before it, low byte first
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+#ifndef OSL_ConfigStore_h
+#define OSL_ConfigStore_h
+
+#include <Arduino.h>
+
+
+#define CONFIG_STORE_HEADER_SIZE    4
+#define CONFIG_STORE_OVERHEAD       (CONFIG_STORE_HEADER_SIZE + 2)      // Header plus CRC
+
+class OSL_ConfigStore
+{   public:
+        OSL_ConfigStore() {}
+
+        void    begin(uint16_t start, uint8_t slots, uint8_t slotSize);     // Where the ring is in EEPROM, how many slots and how big each one is
+        uint8_t load(void *data, uint8_t size);                             // Copy the newest valid record into data. Returns its schema version, 0 if there is none.
+        uint8_t length(void)    { return _length; }                         // Data length of the record found by load()
+        boolean save(const void *data, uint8_t size, uint8_t version);      // Queue a new record for the next slot. Returns false if it doesn't fit.
+        boolean saved(void);                                                // The last record saved reads back correctly. Wait for EEPROMWriter.idle() first.
+
+    private:
+        uint16_t slotAddress(uint8_t slot)  { return _start + ((uint16_t)slot * _slotSize); }
+        boolean  slotValid(uint8_t slot);
+        uint16_t slotCRC(uint8_t slot, uint8_t length);
+        uint16_t readWord(uint16_t address);
+
+        uint16_t _start;
+        uint8_t  _slots;
+        uint8_t  _slotSize;
+        uint8_t  _next;                                                     // Slot the next save goes into
+        uint16_t _sequence;                                                 // Sequence number of the next save
+        uint8_t  _length;
+};
+
+#endif
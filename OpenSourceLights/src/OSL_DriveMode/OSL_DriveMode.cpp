@@ -0,0 +1,172 @@
+/* OSL_DriveMode.cpp    Drive Mode - works out what the vehicle is doing from the throttle channel
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_DriveMode.h"
+
+
+// Handler tables. Rows are STOP, FWD, REV. Columns are "same as last step" and "changed since last step".
+const OSL_DriveMode::Handler OSL_DriveMode::_commandTable[3][2] = 
+{
+    { &OSL_DriveMode::stopHeld,     &OSL_DriveMode::stopStart   },      // STOP
+    { &OSL_DriveMode::forward,      &OSL_DriveMode::forward     },      // FWD
+    { &OSL_DriveMode::reverseHeld,  &OSL_DriveMode::reverseTap  }       // REV
+};
+
+const OSL_DriveMode::Handler OSL_DriveMode::_modeTable[3][2] = 
+{
+    { &OSL_DriveMode::stoppedStill, &OSL_DriveMode::stoppedNow  },      // STOP
+    { &OSL_DriveMode::nothing,      &OSL_DriveMode::nothing     },      // FWD - the sketch checks startedMoving() for the turn signal override
+    { &OSL_DriveMode::nothing,      &OSL_DriveMode::nothing     }       // REV
+};
+
+
+void OSL_DriveMode::begin(const DriveModeConfig &config, uint32_t now)
+{
+    _config = config;
+    _now = now;
+    _throttle = _throttlePrevious = 0;
+    _command = _commandPrevious = STOP;
+    _mode = _modePrevious = STOP;
+    _reverseTaps = 0;
+    _lastForwardTime = 0;
+    _timeStopped = now;
+    _braking = false;
+    _canBrake = false;
+    _accelerating = false;
+    _decelerating = false;
+    _stoppedLongTime = false;
+    _turnSignalEnable = false;
+    _canChangeScheme = false;
+}
+
+void OSL_DriveMode::step(int8_t throttle, uint32_t now)
+{
+    _now = now;
+    _throttlePrevious = _throttle;
+    _commandPrevious = _command;
+    _modePrevious = _mode;
+    _throttle = throttle;
+
+    // What is the throttle asking for
+    if      (throttle >  (int8_t)_config.throttleDeadband) _command = FWD;
+    else if (throttle < -(int8_t)_config.throttleDeadband) _command = REV;
+    else                                                   _command = STOP;
+
+    // Work out the actual drive mode from the command (they are not always the same if doubleTapReverse is set) 
+    (this->*_commandTable[_command - STOP][_command != _commandPrevious])();
+
+    // Now we know the drive mode, take care of stop length
+    (this->*_modeTable[_mode - STOP][_mode != _modePrevious])();
+
+    // Sharp deceleration - still moving in the same direction but the throttle has dropped back by decelPct
+    _decelerating = ((_mode == FWD) && (_throttle >= 0) && (_throttle < _throttlePrevious - _config.decelPct)) ||
+                    ((_mode == REV) && (_throttle <= 0) && (_throttle > _throttlePrevious + _config.decelPct));
+
+    // Sharp acceleration - forward only
+    _accelerating = (_mode == FWD) && (_throttle >= 0) && (_throttle > _throttlePrevious + _config.accelPct);
+}
+
+
+// Command handlers
+// ------------------------------------------------------------------------------------------------------------------------------------------------>
+void OSL_DriveMode::forward(void)
+{
+    _mode = FWD;                                        // Pretty much all ESCs allow us to go directly into forward
+    _reverseTaps = 0;
+    _lastForwardTime = _now;                            // Used to decide if a reverse tap is braking
+    setMoving();
+}
+
+void OSL_DriveMode::reverseTap(void)
+{
+    if (!_config.doubleTapReverse) { reverseHeld(); return; }
+
+    // We have just started commanding reverse from something else. Count taps. 
+    if (++_reverseTaps >= 2)
+    {
+        _reverseTaps = 2;
+        _mode = REV;
+    }
+    else if (_now - _lastForwardTime < _config.fwdToRevBrakeTime)
+    {   // The first tap straight after forward only brakes
+        _mode = STOP;
+        _braking = true;
+    }
+    reverseHeld();
+}
+
+void OSL_DriveMode::reverseHeld(void)
+{
+    if (!_config.doubleTapReverse) _mode = REV;
+    if (_mode == REV) setMoving();                      // With doubleTapReverse we may only be commanding reverse, not actually in it yet
+}
+
+void OSL_DriveMode::stopStart(void)
+{
+    _braking = false;
+    _canBrake = false;
+    _mode = STOP;
+}
+
+void OSL_DriveMode::stopHeld(void)
+{
+    _mode = STOP;
+}
+
+void OSL_DriveMode::setMoving(void)
+{
+    _stoppedLongTime = false;                           // No longer stopped
+    _canChangeScheme = false;                           // We don't want to enter change-scheme mode while moving
+    checkBrakeThreshold();
+}
+
+void OSL_DriveMode::checkBrakeThreshold(void)
+{   // If brakeAtThrottlePctBelow is set, once we have gone above it, dropping back down below it counts as braking
+    uint8_t t = abs(_throttle);
+    if (_config.brakeAtThrottlePctBelow == 0) return;
+    if (!_canBrake && t > _config.brakeAtThrottlePctBelow)
+    {
+        _braking = false;
+        _canBrake = true;
+    }
+    if (_canBrake && t <= _config.brakeAtThrottlePctBelow)
+    {
+        _braking = true;
+        _canBrake = false;                              // Going back over the threshold will clear the brake state again
+    }
+}
+
+
+// Mode handlers
+// ------------------------------------------------------------------------------------------------------------------------------------------------>
+void OSL_DriveMode::stoppedNow(void)
+{   // Only just come to a stop. Turn signals (if restricted to when stopped) and change-scheme mode wait a while from here.
+    _turnSignalEnable = false;
+    _canChangeScheme = false;
+    _timeStopped = _now;
+}
+
+void OSL_DriveMode::stoppedStill(void)
+{
+    uint32_t stopped = _now - _timeStopped;
+    if (_config.turnSignalDelay > 0 && stopped >= _config.turnSignalDelay) _turnSignalEnable = true;
+    if (stopped >= _config.changeSchemeDelay) _canChangeScheme = true;
+    if (stopped >= _config.longStopTime) _stoppedLongTime = true;
+}
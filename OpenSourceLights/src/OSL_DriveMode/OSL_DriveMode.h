@@ -0,0 +1,110 @@
+/* OSL_DriveMode.h      Drive Mode - works out what the vehicle is doing from the throttle channel
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Given a throttle command (-100 to 100) and the time, this class decides the actual drive mode (which is not always the same as the 
+ * commanded one if the ESC needs reverse tapped twice), and whether we are braking, accelerating or decelerating, how long we have been 
+ * stopped, and from that whether turn signals and change-scheme mode are allowed. 
+ *
+ * It is a state machine driven by two small tables of handler functions. The first is indexed by the commanded direction and whether 
+ * that command is new this step, the second by the resulting drive mode and whether that mode is new. Each step runs exactly one handler 
+ * from each table, so a step always takes the same short time. Everything it needs is either in the DriveModeConfig passed to begin() 
+ * or held in the object itself, and the time is passed in rather than read from millis(), so it doesn't depend on anything in the sketch.
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+#ifndef OSL_DriveMode_h
+#define OSL_DriveMode_h
+
+#include <Arduino.h>
+#include "../OSL_Settings/OSL_Settings.h"                   // For the STOP, FWD and REV drive mode definitions
+
+
+typedef struct
+{
+    uint8_t         throttleDeadband;                       // Throttle commands within +/- this amount are treated as stop
+    boolean         doubleTapReverse;                       // The ESC needs reverse tapped twice before the car actually reverses (the first tap brakes)
+    uint8_t         brakeAtThrottlePctBelow;                // If not 0, dropping back below this throttle percent while moving also counts as braking
+    uint16_t        fwdToRevBrakeTime;                      // mS - the longest gap between forward and the first reverse tap that still counts as braking
+    uint16_t        turnSignalDelay;                        // mS stopped before turn signals are enabled (0 = never)
+    uint16_t        changeSchemeDelay;                      // mS stopped before change-scheme mode may be entered
+    uint32_t        longStopTime;                           // mS stopped before the Stop Delay state applies
+    uint8_t         accelPct;                               // Throttle increase in one step that counts as sharp acceleration
+    uint8_t         decelPct;                               // Throttle decrease in one step that counts as sharp deceleration
+} DriveModeConfig;
+
+class OSL_DriveMode
+{   public:
+        OSL_DriveMode() {}
+
+        void begin(const DriveModeConfig &config, uint32_t now);           // Start out stopped
+        void step(int8_t throttle, uint32_t now);                           // Process one throttle command, now is the time in mS
+        void setConfig(const DriveModeConfig &config) { _config = config; } // Change the settings without disturbing the current state
+
+        uint8_t command(void)           { return _command; }                // Drive mode the throttle is commanding (STOP, FWD or REV)
+        uint8_t commandPrevious(void)   { return _commandPrevious; }        // ... and what it was before the last step
+        uint8_t mode(void)              { return _mode; }                   // Actual drive mode
+        uint8_t modePrevious(void)      { return _modePrevious; }           // ... and what it was before the last step
+        boolean startedMoving(void)     { return _mode != _modePrevious && _mode != STOP; }    // True for the one step where we move off in either direction
+        boolean braking(void)           { return _braking; }
+        boolean accelerating(void)      { return _accelerating; }
+        boolean decelerating(void)      { return _decelerating; }
+        boolean stoppedLongTime(void)   { return _stoppedLongTime; }
+        boolean turnSignalEnabled(void) { return _turnSignalEnable; }
+        boolean canChangeScheme(void)   { return _canChangeScheme; }
+
+    private:
+        typedef void (OSL_DriveMode::*Handler)(void);
+        static const Handler _commandTable[3][2];                           // [command - STOP][0 = command held, 1 = command just changed]
+        static const Handler _modeTable[3][2];                              // [mode - STOP][0 = mode held, 1 = mode just changed]
+
+        // Command handlers
+        void forward(void);
+        void reverseTap(void);
+        void reverseHeld(void);
+        void stopStart(void);
+        void stopHeld(void);
+
+        // Mode handlers
+        void nothing(void) {}
+        void stoppedNow(void);
+        void stoppedStill(void);
+
+        void setMoving(void);
+        void checkBrakeThreshold(void);
+
+        DriveModeConfig _config;
+        uint32_t        _now;
+        int8_t          _throttle;
+        int8_t          _throttlePrevious;
+        uint8_t         _command;
+        uint8_t         _commandPrevious;
+        uint8_t         _mode;
+        uint8_t         _modePrevious;
+        uint8_t         _reverseTaps;
+        uint32_t        _lastForwardTime;
+        uint32_t        _timeStopped;
+        boolean         _braking;
+        boolean         _canBrake;
+        boolean         _accelerating;
+        boolean         _decelerating;
+        boolean         _stoppedLongTime;
+        boolean         _turnSignalEnable;
+        boolean         _canChangeScheme;
+};
+
+
+#endif 
@@ -0,0 +1,120 @@
+/* OSL_EEPROMWriter.cpp EEPROM Writer - writes EEPROM in the background from the EEPROM ready interrupt
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_EEPROMWriter.h"
+#include <avr/interrupt.h>
+
+OSL_EEPROMWriter EEPROMWriter;
+
+
+ISR(EE_READY_vect)
+{
+    EEPROMWriter.service();
+}
+
+void OSL_EEPROMWriter::service(void)
+{   // Runs with interrupts off, whenever the EEPROM isn't busy and the interrupt is enabled. Starts writing the oldest byte that actually 
+    // needs it, or turns the interrupt off if there are none left. 
+    EEPROMWrite *w;
+
+    while (_count > 0)
+    {
+        w = &_queue[_head];
+        _head = (_head + 1) % EEPROM_WRITE_QUEUE_LENGTH;
+        _count--;
+
+        EEAR = w->address;
+        EECR |= _BV(EERE);
+        if (EEDR == w->value) continue;                                             // Already there, save the wear and the time
+
+        EEDR = w->value;
+        EECR |= _BV(EEMPE);                                                         // EEPE has to be set within four clock cycles of EEMPE
+        EECR |= _BV(EEPE);
+        return;
+    }
+    EECR &= ~_BV(EERIE);
+}
+
+void OSL_EEPROMWriter::write(uint16_t address, uint8_t value)
+{
+    uint8_t oldSREG;
+
+    while (_count >= EEPROM_WRITE_QUEUE_LENGTH) yield();                            // Full, wait for the interrupt to make room
+
+    oldSREG = SREG;
+    cli();
+    _queue[(_head + _count) % EEPROM_WRITE_QUEUE_LENGTH].address = address;
+    _queue[(_head + _count) % EEPROM_WRITE_QUEUE_LENGTH].value = value;
+    _count++;
+    EECR |= _BV(EERIE);                                                             // Fires straight away if the EEPROM is free
+    SREG = oldSREG;
+}
+
+void OSL_EEPROMWriter::writeBlock(const void *src, uint16_t address, uint16_t length)
+{
+    for (uint16_t i=0; i<length; i++) write(address + i, ((const uint8_t *)src)[i]);
+}
+
+uint8_t OSL_EEPROMWriter::read(uint16_t address)
+{
+    uint8_t oldSREG = SREG;
+    uint8_t value;
+    int8_t  i;
+
+    while (true)
+    {
+        cli();
+        // Newest first, in case the same byte has been queued more than once
+        for (i=_count-1; i>=0; i--)
+        {
+            if (_queue[(_head + i) % EEPROM_WRITE_QUEUE_LENGTH].address == address)
+            {
+                value = _queue[(_head + i) % EEPROM_WRITE_QUEUE_LENGTH].value;
+                SREG = oldSREG;
+                return value;
+            }
+        }
+        // Not queued. If a write is under way it may be this byte, and the address can't be changed until it's done anyway. 
+        // Wait with interrupts back on so the radio isn't held up, then look again. 
+        if (!(EECR & _BV(EEPE))) break;
+        SREG = oldSREG;
+        yield();
+    }
+    EEAR = address;
+    EECR |= _BV(EERE);
+    value = EEDR;
+    SREG = oldSREG;
+    return value;
+}
+
+void OSL_EEPROMWriter::readBlock(void *dst, uint16_t address, uint16_t length)
+{
+    for (uint16_t i=0; i<length; i++) ((uint8_t *)dst)[i] = read(address + i);
+}
+
+boolean OSL_EEPROMWriter::idle(void)
+{   // Nothing queued and the last byte finished, so read() won't have to wait
+    return (_count == 0 && !(EECR & _BV(EEPE)));
+}
+
+void OSL_EEPROMWriter::flush(void)
+{
+    while (!idle()) yield();
+}
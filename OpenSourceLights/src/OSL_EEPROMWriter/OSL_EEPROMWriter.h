@@ -0,0 +1,69 @@
+/* OSL_EEPROMWriter.h   EEPROM Writer - writes EEPROM in the background from the EEPROM ready interrupt
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Writing a byte of EEPROM takes 3.3 mS, and the avr-libc eeprom_write/update functions wait for each one to finish. Here write() only 
+ * puts the address and value in a queue and returns. The EE_READY interrupt, which fires whenever the EEPROM is free, takes the oldest 
+ * entry and starts writing it (or skips it if the byte already holds that value). Bytes are written in the order they were queued, so 
+ * code that relies on writing a CRC or a "valid" marker last still can. 
+ *
+ * read() checks the queue first, so a byte that is still waiting to be written reads back as its new value. A byte that isn't in the queue
+ * can't be read while another is being written, so reading back a block straight after queuing it waits 3.3 mS on most of its bytes - 
+ * wait until idle() before checking what was written. If the queue is full, write() waits for room, and flush() waits until everything 
+ * has been written. Neither can be used with interrupts turned off. 
+ *
+ * Once this is in use, all EEPROM access should go through it - an avr-libc read or write could have the address register changed 
+ * underneath it by the interrupt. The queue length is EEPROM_WRITE_QUEUE_LENGTH in OSL_Settings.h, each entry takes 3 bytes of RAM. 
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+#ifndef OSL_EEPROMWriter_h
+#define OSL_EEPROMWriter_h
+
+#include <Arduino.h>
+#include "../OSL_Settings/OSL_Settings.h"
+
+
+typedef struct
+{
+    uint16_t        address;
+    uint8_t         value;
+} EEPROMWrite;
+
+class OSL_EEPROMWriter
+{   public:
+        OSL_EEPROMWriter() : _head(0), _count(0) {}
+
+        void    write(uint16_t address, uint8_t value);                             // Queue one byte
+        void    writeBlock(const void *src, uint16_t address, uint16_t length);      // Queue several
+        uint8_t read(uint16_t address);                                             // Read one byte, including any still in the queue
+        void    readBlock(void *dst, uint16_t address, uint16_t length);
+        uint8_t pending(void)   { return _count; }                                  // Bytes waiting to be written
+        uint8_t room(void)      { return EEPROM_WRITE_QUEUE_LENGTH - _count; }      // Bytes that can be queued without waiting
+        boolean idle(void);                                                         // Everything has been written
+        void    flush(void);                                                        // Wait until everything has been written
+
+        void    service(void);                                                      // Called by the interrupt, not by you
+
+    private:
+        EEPROMWrite         _queue[EEPROM_WRITE_QUEUE_LENGTH];
+        uint8_t             _head;                                                  // Oldest entry
+        volatile uint8_t    _count;
+};
+
+extern OSL_EEPROMWriter EEPROMWriter;
+
+#endif
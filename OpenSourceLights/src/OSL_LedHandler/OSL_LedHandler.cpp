@@ -19,11 +19,13 @@
 
 
 #include "OSL_LedHandler.h"
+#include "../OSL_ShiftOutput/OSL_ShiftOutput.h"
 
 
 void OSL_LedHandler::begin(byte p, boolean i /*=false*/, boolean w /*=false*/)
 {
     _pin = p;                   // Save pin number
+    _shiftOutput = 0;           // Not on a shift register
     _invert = i;                // Save invert status
 	_pwmable = w;				// Can we analog-write to this pin (pwm-able)
 	_fadeType = FADE_TYPE_EXP;	// Default fade type
@@ -34,6 +36,19 @@ void OSL_LedHandler::begin(byte p, boolean i /*=false*/, boolean w /*=false*/)
 	this->off();                // Start with Led off, this also will call clearUpdateProcess()
 }
 
+void OSL_LedHandler::begin(OSL_ShiftOutput &s, uint8_t o, boolean i /*=false*/)
+{
+    _pin = o;                   // Save output number
+    _shiftOutput = &s;
+    _invert = i;
+	_pwmable = true;			// Shift register outputs are always dimmable
+	_fadeType = FADE_TYPE_EXP;
+	_blinkToDim = false;
+    _ledPriorState = LED_STATE_OFF;
+	_ledCurState = LED_STATE_OFF;
+	this->off();
+}
+
 void OSL_LedHandler::clearUpdateProcess()
 {
     _curProcessStep = 0;
@@ -118,25 +133,39 @@ void OSL_LedHandler::offWithExtra(boolean includeExtra /* = false */)
 
 void OSL_LedHandler::pinOn(void)
 {
-    _invert ? digitalWrite(_pin, LOW) : digitalWrite(_pin, HIGH);
+    _level = MAX_PWM;
+    if (_shiftOutput) writePin(MAX_PWM);
+    else _invert ? digitalWrite(_pin, LOW) : digitalWrite(_pin, HIGH);
 }
 
 void OSL_LedHandler::pinOff(void)
 {
-    _invert ? digitalWrite(_pin, HIGH) : digitalWrite(_pin, LOW);
+    _level = MIN_PWM;
+    if (_shiftOutput) writePin(MIN_PWM);
+    else _invert ? digitalWrite(_pin, HIGH) : digitalWrite(_pin, LOW);
 }
 
 void OSL_LedHandler::toggle(void)
 {
 	// This does nothing to the state, it just toggles the pin
-	digitalWrite(_pin, !digitalRead(_pin)); 
+	if (_shiftOutput) writePin(_level ? MIN_PWM : MAX_PWM);
+	else digitalWrite(_pin, !digitalRead(_pin)); 
+	_level = _level ? MIN_PWM : MAX_PWM;
 }
     
 void OSL_LedHandler::setPWM(float level)
 {
 	// Assumed you have already done a check to see if this pin is pwm-able
 	_pwm = level;
-	analogWrite(_pin, (uint8_t)_pwm);
+	_level = (uint8_t)_pwm;
+	if (_shiftOutput) writePin(_level);
+	else analogWrite(_pin, (uint8_t)_pwm);
+}
+
+void OSL_LedHandler::writePin(uint8_t level)
+{
+	// Shift register outputs only. There is no pin to invert, so we invert the level instead.
+	_shiftOutput->set(_pin, _invert ? MAX_PWM - level : level);
 }
 	
 void OSL_LedHandler::dim(uint8_t level)
@@ -231,6 +260,25 @@ void OSL_LedHandler::StreamBlink(BlinkStream bs, uint8_t numSteps)
 	changeLEDState(LED_STATE_BLINK);
 }
 
+// Restarts a continuous on/off blink (startBlinking) from the beginning of its cycle, if its cycle (on + off time) divides evenly into period. 
+// Calling this every period on lights that are meant to blink together, on however many boards, keeps them in step. If they already are, the 
+// light is at the start of a cycle anyway and nothing changes. Returns true if the light was restarted. 
+boolean OSL_LedHandler::syncBlink(uint16_t period)
+{
+    uint16_t cycle;
+
+    if (_ledCurState != LED_STATE_BLINK || !_blinkStream.repeat || _numSteps != 2) return false;
+    cycle = _blinkStream.interval[0] + _blinkStream.interval[1];
+    if (cycle == 0 || (period % cycle) != 0) return false;
+
+    _curStep = 0;
+    _nextWait = _blinkStream.interval[0];
+    if (_blinkStream.altBlink)	this->pinOff();
+	else						this->pinOn();
+    _time = 0;
+    return true;
+}
+
 // Will fade a LED in or out (use FADE_IN or FADE_OUT for dir)
 // Span is in milliseconds and is the length of time the fade will take,
 void OSL_LedHandler::Fade(uint8_t dir, uint16_t span, char fadeType)
@@ -450,6 +498,17 @@ void OSL_LedHandler::softBlinkWithStartFlag(boolean start /* =false */)
 	}
 }
 
+uint16_t OSL_LedHandler::msUntilNextUpdate(void)
+{
+	unsigned long t;
+	
+	// Every effect that needs updating sets _nextWait, and update() acts once _time exceeds it. A steady LED has no wait.
+	if (_nextWait == 0) return LED_NO_UPDATE_DUE;
+	t = _time;
+	if (t > _nextWait) return 0;
+	return (_nextWait - t) + 1;
+}
+
 void OSL_LedHandler::update(void)
 {
 static boolean skipme = true;
@@ -24,6 +24,8 @@
 #include "../elapsedMillis/elapsedMillis.h"
 #include "../../AA_UserConfig.h"
 
+class OSL_ShiftOutput;
+
 
 // These are all the possible states the light can be in, within this class. These are not always strictly the same thing as the states within the sketch,
 // and an output may go though multiple states to get to the state the sketch wants (transition states)
@@ -48,6 +50,7 @@ typedef struct                                          	// This struct holds an
 } BlinkStream;
 
 #define DEFAULT_BLINK_INTERVAL              378				// Used when an interval is not specified, though OSL always will
+#define LED_NO_UPDATE_DUE                0xFFFF				// Returned by msUntilNextUpdate() when the LED is on, off or dim and needs no further updates
 
 #define MIN_PWM							      0				// PWM value at Off
 #define MIN_PWM_FLOAT					    0.0
@@ -93,17 +96,21 @@ class OSL_LedHandler
         OSL_LedHandler() {}; 
         
         void begin (byte p, boolean i=false, boolean w=false); 					// p = pin, i = invert, w = pwm-able
+        void begin (OSL_ShiftOutput &s, uint8_t o, boolean i=false);			// Overload - output o of a shift register chain (always pwm-able)
         void on(void);
 		boolean isOn(void);
         void off(void);
         void toggle(void);
 		void dim(uint8_t level);												// Level should be between 0-MAX_PWM
         void update(void);                                                      // Update blinking effect
+		uint16_t msUntilNextUpdate(void);										// How long until update() next has something to do, LED_NO_UPDATE_DUE if the LED is steady
+		uint8_t level(void) { return _level; }									// Brightness last written to the pin, MIN_PWM to MAX_PWM (before any inversion)
         void Blink(uint16_t interval=DEFAULT_BLINK_INTERVAL);                   // Blinks once at interval specified
         void Blink(uint8_t times, uint16_t interval=DEFAULT_BLINK_INTERVAL);    // Overload - Blinks N times at interval specified (on and off interval will be the same)
 		void Blink(uint8_t times, uint16_t on_interval=DEFAULT_BLINK_INTERVAL, uint16_t off_interval=DEFAULT_BLINK_INTERVAL);   // Overload - Blinks N times at intervals specified (on and off time individually set)
         void startBlinking(uint16_t on_interval=DEFAULT_BLINK_INTERVAL, uint16_t off_interval=DEFAULT_BLINK_INTERVAL, boolean alt=false);   // Starts a continuous blink at the set intervals
 		void stopBlinking(void);
+		boolean syncBlink(uint16_t period);										// Restarts a continuous blink whose cycle divides period, see the cpp
 		void softBlink(void);
         void StreamBlink(BlinkStream bs, uint8_t numSteps);
 		void randomBlink(void);
@@ -118,14 +125,17 @@ class OSL_LedHandler
 		void clearUpdateProcess(void);
         void pinOn(void);
         void pinOff(void);
+		void writePin(uint8_t level);
 		void offWithExtra(boolean includeExtra=false);
 		void setPWM(float level);
 		void changeLEDState(uint8_t changeState);
 		void softBlinkWithStartFlag(boolean start=false);
         elapsedMillis   _time;
-        byte            _pin;
+        byte            _pin;													// Or the output number, if _shiftOutput is set
+		OSL_ShiftOutput *_shiftOutput;
 		boolean			_pwmable;
 		float			_pwm;
+		uint8_t			_level;
 		boolean			_fadeToTarget; 
 		int16_t			_pwmTarget;
         boolean         _invert;
@@ -0,0 +1,125 @@
+/* OSL_PinChangeDispatch.h  Pin Change Dispatch - pin change interrupt vectors with their handlers fixed when compiling
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * The PinChangeInterrupt library finds the handler for each pin in a table at run time. Calling a function through a pointer from inside an
+ * interrupt means the compiler can't see what it does, so it has to save and restore every call-clobbered register first. Here the pins and
+ * their handlers are template parameters instead. A group of pins is declared once:
+ *
+ *      typedef PinChangeGroup< PinChangePin<2, Throttle_Edge>, PinChangePin<17, Steering_Edge> > RCPins;
+ *
+ * and then OSL_PINCHANGE_ISR(RCPins, 2, PCINT2_vect, PIND) defines the vector for port 2. The vector reads the port and the time once, and
+ * calls the handler of each pin in the group that is on that port and has changed. The handlers are ordinary functions taking the time in uS
+ * and the new level of the pin. If they are in the same file as the vector the compiler puts them straight into it.
+ *
+ * Only the ATmega328 pin numbering is handled (port 2 = pins 0-7, port 0 = pins 8-13, port 1 = pins 14-19). Use enable() and disable() to
+ * turn the group's pins on and off. Any vector you define here can't also be used by the library, see PCINT_TEMPLATE_DISPATCH in OSL_Settings.h
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OSL_PinChangeDispatch_h
+#define OSL_PinChangeDispatch_h
+
+#include <Arduino.h>
+#include <avr/interrupt.h>
+
+#define PINCHANGE_PORT(pin)     ((pin) < 8 ? 2 : ((pin) < 14 ? 0 : 1))
+#define PINCHANGE_BIT(pin)      ((pin) < 8 ? (pin) : ((pin) < 14 ? (pin) - 8 : (pin) - 14))
+
+typedef void (*PinChangeHandler)(uint32_t uS, boolean high);
+
+extern volatile unsigned long timer0_overflow_count;                   // In the Arduino core (wiring.c)
+
+static inline uint32_t pinChangeMicros(void) __attribute__((always_inline));
+static inline uint32_t pinChangeMicros(void)
+{   // micros() without the function call or the interrupt save and restore, for use inside an interrupt only
+    uint32_t m = timer0_overflow_count;
+    uint8_t  t = TCNT0;
+    if ((TIFR0 & _BV(TOV0)) && (t < 255)) m++;
+    return ((m << 8) + t) * (64 / clockCyclesPerMicrosecond());
+}
+
+
+template <uint8_t PIN, PinChangeHandler HANDLER>
+struct PinChangePin
+{
+    static const uint8_t port = PINCHANGE_PORT(PIN);
+    static const uint8_t mask = 1 << PINCHANGE_BIT(PIN);
+
+    static inline void dispatch(uint8_t p, uint8_t changed, uint8_t now, uint32_t uS) __attribute__((always_inline))
+    {
+        if (p == port && (changed & mask)) HANDLER(uS, now & mask);
+    }
+};
+
+
+template <typename... PINS> struct PinChangeGroup;
+
+template <> struct PinChangeGroup<>
+{
+    static constexpr uint8_t mask(uint8_t) { return 0; }
+    static inline void dispatch(uint8_t, uint8_t, uint8_t, uint32_t) { }
+};
+
+template <typename FIRST, typename... REST> struct PinChangeGroup<FIRST, REST...>
+{
+    // Bits of the pins in this group on port p
+    static constexpr uint8_t mask(uint8_t p) { return (FIRST::port == p ? FIRST::mask : 0) | PinChangeGroup<REST...>::mask(p); }
+
+    static inline void dispatch(uint8_t p, uint8_t changed, uint8_t now, uint32_t uS) __attribute__((always_inline))
+    {
+        FIRST::dispatch(p, changed, now, uS);
+        PinChangeGroup<REST...>::dispatch(p, changed, now, uS);
+    }
+
+    static void enable(void)
+    {
+        uint8_t oldSREG = SREG;
+        cli();
+        PCMSK0 |= mask(0);
+        PCMSK1 |= mask(1);
+        PCMSK2 |= mask(2);
+        PCIFR = (mask(0) ? _BV(PCIF0) : 0) | (mask(1) ? _BV(PCIF1) : 0) | (mask(2) ? _BV(PCIF2) : 0);      // Forget anything from before
+        PCICR |= (mask(0) ? _BV(PCIE0) : 0) | (mask(1) ? _BV(PCIE1) : 0) | (mask(2) ? _BV(PCIE2) : 0);
+        SREG = oldSREG;
+    }
+
+    static void disable(void)
+    {   // The port stays enabled in PCICR, other pins on it may still be in use
+        uint8_t oldSREG = SREG;
+        cli();
+        PCMSK0 &= ~mask(0);
+        PCMSK1 &= ~mask(1);
+        PCMSK2 &= ~mask(2);
+        SREG = oldSREG;
+    }
+};
+
+
+// Defines the interrupt vector for one port of a group. PORT is 0, 1 or 2, VECTOR and PINREG must match it (PCINT0_vect/PINB, PCINT1_vect/PINC,
+// PCINT2_vect/PIND). The time is taken first so it is as close to the edge as we can get.
+#define OSL_PINCHANGE_ISR(GROUP, PORT, VECTOR, PINREG)                                  \
+    ISR(VECTOR)                                                                         \
+    {                                                                                   \
+        static uint8_t last;                                                            \
+        uint32_t uS = pinChangeMicros();                                                \
+        uint8_t  now = PINREG;                                                          \
+        uint8_t  changed = (now ^ last) & GROUP::mask(PORT);                            \
+        last = now;                                                                     \
+        GROUP::dispatch(PORT, changed, now, uS);                                        \
+    }
+
+#endif
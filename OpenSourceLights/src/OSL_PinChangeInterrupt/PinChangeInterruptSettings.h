@@ -39,6 +39,20 @@ Same for the port if you deactivate all 8 pins.
 You dont have to deactivate pins/ports that dont exist.
 That is done by the macros. */
 
+// OSL: if the RC inputs use the template dispatch (PCINT_TEMPLATE_DISPATCH in OSL_Settings.h), ports 1 and 2 are left out
+// so that their interrupt vectors aren't defined twice
+#include "../OSL_Settings/OSL_Settings.h"
+#if PCINT_TEMPLATE_DISPATCH
+#define PCINT_ENABLE_MANUAL
+#define PCINT_ENABLE_PORT0
+#define PCINT_ENABLE_PCINT0
+#define PCINT_ENABLE_PCINT1
+#define PCINT_ENABLE_PCINT2
+#define PCINT_ENABLE_PCINT3
+#define PCINT_ENABLE_PCINT4
+#define PCINT_ENABLE_PCINT5
+#endif
+
 #ifndef PCINT_ENABLE_MANUAL
 
 #define PCINT_ENABLE_PORT0
@@ -0,0 +1,142 @@
+/* OSL_PixelOutput.cpp  Pixel Output - a strip of WS2812 addressable LEDs, sent a few pixels at a time
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "OSL_PixelOutput.h"
+#include <avr/interrupt.h>
+
+OSL_PixelOutput PixelOutput;
+
+
+void OSL_PixelOutput::begin(uint8_t pin, uint8_t pixels, uint8_t pixelsPerBurst)
+{
+    if (pixels > PixelCount) pixels = PixelCount;
+    if (pixelsPerBurst == 0 || pixelsPerBurst > pixels) pixelsPerBurst = pixels;
+
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);
+    _port = portOutputRegister(digitalPinToPort(pin));
+    _mask = digitalPinToBitMask(pin);
+    _pixels = pixels;
+    _burstBytes = pixelsPerBurst * 3;
+    memset(_frame, 0, sizeof(_frame));
+    _changed = true;                                                            // Clear whatever the strip powered up with
+}
+
+void OSL_PixelOutput::set(uint8_t pixel, uint8_t red, uint8_t green, uint8_t blue, uint8_t level)
+{
+    uint8_t *p;
+    uint8_t  g, r, b;
+
+    if (pixel >= _pixels) return;
+    g = ((uint16_t)green * level + 255) >> 8;                                   // Rounded up, so 255 at full level stays 255 and level 0 is always off
+    r = ((uint16_t)red * level + 255) >> 8;
+    b = ((uint16_t)blue * level + 255) >> 8;
+
+    p = &_frame[pixel * 3];
+    if (p[0] != g || p[1] != r || p[2] != b)
+    {
+        p[0] = g;
+        p[1] = r;
+        p[2] = b;
+        _changed = true;
+    }
+}
+
+boolean OSL_PixelOutput::show(void)
+{
+    uint8_t  oldSREG;
+    uint8_t  hi, lo;
+    uint8_t  burst;
+    uint16_t sent = 0;
+    uint16_t bytes = _pixels * 3;
+    uint32_t burstEnd = 0;
+
+    if (!_changed || bytes == 0) return true;
+
+    while (sent < bytes)
+    {
+        burst = (bytes - sent) < _burstBytes ? (bytes - sent) : _burstBytes;
+        oldSREG = SREG;
+        cli();
+        if (sent > 0 && (micros() - burstEnd) > PIXEL_GAP_MAX_US)
+        {   // Something kept us away long enough that the strip may have latched what it had so far. It will look right again next frame.
+            SREG = oldSREG;
+            _restarts += 1;
+            return false;
+        }
+        hi = *_port | _mask;                                                    // The other pins on the port can't change while interrupts are off
+        lo = *_port & ~_mask;
+        send(_port, hi, lo, &_frame[sent], burst);
+        burstEnd = micros();
+        SREG = oldSREG;                                                         // Anything that came in during the burst runs now
+        sent += burst;
+    }
+    _changed = false;
+    return true;
+}
+
+void OSL_PixelOutput::send(volatile uint8_t *port, uint8_t hi, uint8_t lo, const uint8_t *data, uint16_t bytes)
+{   // 20 cycles (1.25 uS) per bit at 16 MHz, most significant bit first. The line goes high at T = 0 and low at T = 5 (0.31 uS) for a 0 or at T = 13
+    // (0.81 uS) for a 1. The cycle counts below are checked by tools/osl_pixel_timing.py, which reads them from this file, so if you change anything
+    // here run its self-test. Reads one byte past the end of data.
+#if defined(__AVR__)
+    uint8_t b = *data++;
+    uint8_t bit = 8;
+    uint8_t next = lo;
+
+    asm volatile(
+        "1:"                                "\n\t"  // Cycles   T
+        "st   %a[port], %[hi]"              "\n\t"  // 2        0   High
+        "sbrc %[b], 7"                      "\n\t"  // 1/2      2
+        "mov  %[next], %[hi]"               "\n\t"  // 1        3   Stays high for a 1
+        "lsl  %[b]"                         "\n\t"  // 1        4
+        "st   %a[port], %[next]"            "\n\t"  // 2        5   Low for a 0
+        "mov  %[next], %[lo]"               "\n\t"  // 1        7
+        "dec  %[bit]"                       "\n\t"  // 1        8
+        "breq 2f"                           "\n\t"  // 1/2      9
+        "rjmp .+0"                          "\n\t"  // 2        10
+        "nop"                               "\n\t"  // 1        12
+        "st   %a[port], %[lo]"              "\n\t"  // 2        13  Low for a 1
+        "rjmp .+0"                          "\n\t"  // 2        15
+        "nop"                               "\n\t"  // 1        17
+        "rjmp 1b"                           "\n\t"  // 2        18
+        "2:"                                "\n\t"  //          11  Last bit of the byte
+        "ld   %[b], %a[data]+"              "\n\t"  // 2        11
+        "st   %a[port], %[lo]"              "\n\t"  // 2        13  Low for a 1
+        "ldi  %[bit], 8"                    "\n\t"  // 1        15
+        "sbiw %[bytes], 1"                  "\n\t"  // 2        16
+        "brne 1b"                           "\n\t"  // 1/2      18
+        : [b] "+r" (b), [bit] "+d" (bit), [next] "+r" (next), [data] "+e" (data), [bytes] "+w" (bytes)
+        : [port] "e" (port), [hi] "r" (hi), [lo] "r" (lo)
+        : "memory");
+#else
+    // Host build (see host/README): the same levels in the same order, without the timing
+    while (bytes--)
+    {
+        uint8_t b = *data++;
+        for (uint8_t bit = 0; bit < 8; bit++, b <<= 1)
+        {
+            *port = hi;
+            if (!(b & 0x80)) *port = lo;
+            *port = lo;
+        }
+    }
+#endif
+}
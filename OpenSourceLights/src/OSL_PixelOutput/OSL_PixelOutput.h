@@ -0,0 +1,62 @@
+/* OSL_PixelOutput.h    Pixel Output - a strip of WS2812 addressable LEDs, sent a few pixels at a time
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * The frame buffer holds 3 bytes per pixel, already scaled to the brightness and in the order the strip reads them (green, red, blue). set() only
+ * changes the buffer, show() sends it if anything changed.
+ *
+ * WS2812s read one bit every 1.25 uS, high for about 0.4 uS for a 0 and 0.8 uS for a 1, so send() clocks them out by hand with interrupts off.
+ * show() turns interrupts off for no more than a burst of pixels at a time (see ADDRESSABLE PIXELS in OSL_Settings.h). The pixels only latch
+ * once the line has been low for their reset time, so the bursts run together into one frame as long as the interrupts in between are short.
+ * If the gap gets too long the strip may have latched part way, and show() returns false so the whole frame can be sent again.
+ *
+ * tools/osl_pixel_timing.py --selftest runs the instructions in send() cycle by cycle and checks the waveform against the WS2812 timings. On real
+ * hardware, or under simavr, the same can be checked by watching pin 12 (PB4) with a logic analyzer or a VCD trace of PORTB.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OSL_PixelOutput_h
+#define OSL_PixelOutput_h
+
+#include <Arduino.h>
+#include "../../AA_UserConfig.h"
+#include "../OSL_Settings/OSL_Settings.h"
+
+
+class OSL_PixelOutput
+{   public:
+        OSL_PixelOutput() : _pixels(0), _changed(false), _restarts(0) {}
+
+        void    begin(uint8_t pin, uint8_t pixels, uint8_t pixelsPerBurst);    // No more than PixelCount pixels, pixelsPerBurst 0 sends them all at once
+        void    set(uint8_t pixel, uint8_t red, uint8_t green, uint8_t blue, uint8_t level=255);   // Color scaled by level, 0-255
+        boolean show(void);                                                     // Returns false if the frame has to be sent again
+        uint16_t restarts(void) { return _restarts; }                           // Frames sent again because the gap between bursts was too long
+
+        static void send(volatile uint8_t *port, uint8_t hi, uint8_t lo, const uint8_t *data, uint16_t bytes);  // Interrupts must be off, bytes at least 1
+
+    private:
+        volatile uint8_t   *_port;
+        uint8_t             _mask;
+        uint8_t             _pixels;
+        uint8_t             _burstBytes;
+        boolean             _changed;
+        uint16_t            _restarts;
+        uint8_t             _frame[PIXEL_BUFFER_BYTES];                         // Green, red, blue for each pixel
+};
+
+extern OSL_PixelOutput PixelOutput;
+
+#endif
@@ -0,0 +1,65 @@
+/* OSL_Profiler.cpp     Profiler - measures how long sections of the main loop take
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_Profiler.h"
+
+#if PROFILER
+
+OSL_Profiler Profiler;
+
+
+void OSL_Profiler::reset(void)
+{
+    for (uint8_t i=0; i<PROFILE_SECTIONS; i++)
+    {
+        _section[i].count = 0;
+        _section[i].total = 0;
+        _section[i].min = 0xFFFF;
+        _section[i].max = 0;
+        for (uint8_t b=0; b<PROFILE_BUCKETS; b++) _section[i].bucket[b] = 0;
+    }
+}
+
+void OSL_Profiler::record(uint8_t section, uint32_t uS)
+{
+    ProfileSection *s;
+    uint8_t b = 0;
+    uint32_t limit = PROFILE_FIRST_BUCKET_US;
+    
+    if (section >= PROFILE_SECTIONS) return;
+    s = &_section[section];
+
+    if (uS > 0xFFFF) uS = 0xFFFF;
+    if (s->count == 0xFFFFFFFF) return;     // Full - stop rather than wrap and give a nonsense average
+    s->count++;
+    s->total += uS;
+    if (uS < s->min) s->min = uS;
+    if (uS > s->max) s->max = uS;
+    
+    while (b < PROFILE_BUCKETS-1 && uS >= limit) { b++; limit <<= 1; }
+    if (s->bucket[b] < 0xFFFF) s->bucket[b]++;
+}
+
+uint32_t OSL_Profiler::bucketLimit(uint8_t bucket)
+{
+    return (uint32_t)PROFILE_FIRST_BUCKET_US << bucket;
+}
+
+#endif // PROFILER
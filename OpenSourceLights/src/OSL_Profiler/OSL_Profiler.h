@@ -0,0 +1,74 @@
+/* OSL_Profiler.h       Profiler - measures how long sections of the main loop take
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Each section is timed with micros() (Timer0, 4 uS resolution on a 16 MHz board) and the results are kept in a fixed block of RAM: 
+ * the number of samples, minimum, maximum, running total (for the average) and a histogram with one bucket per power of two. 
+ * 
+ * The whole thing is only compiled if PROFILER is set to true in AA_UserConfig.h. Otherwise the PROFILE_START and PROFILE_END macros 
+ * expand to nothing and no RAM or flash is used. Sections are defined in OSL_Settings.h under the PROFILER heading. 
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+#ifndef OSL_Profiler_h
+#define OSL_Profiler_h
+
+#include <Arduino.h>
+#include "../../AA_UserConfig.h"
+#include "../OSL_Settings/OSL_Settings.h"
+
+
+#if PROFILER
+
+typedef struct
+{
+    uint32_t        count;                                  // Number of samples
+    uint32_t        total;                                  // Sum of all samples in uS, for the average
+    uint16_t        min;                                    // Shortest sample in uS
+    uint16_t        max;                                    // Longest sample in uS (samples longer than 65 mS are recorded as 65535)
+    uint16_t        bucket[PROFILE_BUCKETS];                // Histogram. Bucket 0 counts samples under PROFILE_FIRST_BUCKET_US, each bucket after that doubles, the last catches everything longer
+} ProfileSection;
+
+class OSL_Profiler
+{   public:
+        OSL_Profiler() { reset(); }
+
+        void reset(void);
+        void record(uint8_t section, uint32_t uS);
+        const ProfileSection & get(uint8_t section) { return _section[section]; }
+        uint32_t bucketLimit(uint8_t bucket);                   // Upper limit in uS of a histogram bucket (the last bucket has no limit)
+
+    private:
+        ProfileSection  _section[PROFILE_SECTIONS];
+};
+
+extern OSL_Profiler Profiler;
+
+// Wrap the code to be measured: 
+//     PROFILE_START(PROF_TIMER);
+//     timer.run();
+//     PROFILE_END(PROF_TIMER);
+#define PROFILE_START(s)        uint32_t _profileStart_##s = micros()
+#define PROFILE_END(s)          Profiler.record(s, micros() - _profileStart_##s)
+
+#else
+
+#define PROFILE_START(s)
+#define PROFILE_END(s)
+
+#endif // PROFILER
+
+#endif 
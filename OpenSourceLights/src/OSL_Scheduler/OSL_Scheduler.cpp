@@ -0,0 +1,105 @@
+/* OSL_Scheduler.cpp    Scheduler - a small cooperative, fixed-rate task scheduler
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_Scheduler.h"
+
+
+OSL_Scheduler::OSL_Scheduler()
+{
+    for (uint8_t i=0; i<MAX_SCHEDULER_TASKS; i++)
+    {
+        _task[i].callback = NULL;
+        _task[i].running = false;
+    }
+    resetStats();
+}
+
+void OSL_Scheduler::setTask(uint8_t task, task_callback f, uint32_t period, uint32_t budget)
+{
+    if (task >= MAX_SCHEDULER_TASKS) return;
+    _task[task].callback = f;
+    _task[task].period = period;
+    _task[task].budget = budget;
+    _task[task].next = micros() + period;
+    _task[task].running = false;
+}
+
+void OSL_Scheduler::resetStats(void)
+{
+    for (uint8_t i=0; i<MAX_SCHEDULER_TASKS; i++)
+    {
+        _task[i].runs = 0;
+        _task[i].overruns = 0;
+        _task[i].skipped = 0;
+        _task[i].maxTime = 0;
+    }
+}
+
+void OSL_Scheduler::run(void)
+{
+    SchedulerTask *t;
+    uint32_t now;
+    uint32_t took;
+
+    for (uint8_t i=0; i<MAX_SCHEDULER_TASKS; i++)
+    {
+        t = &_task[i];
+        if (t->callback == NULL || t->running) continue;
+
+        now = micros();
+        if (t->period > 0)
+        {
+            if ((int32_t)(now - t->next) < 0) continue;         // Not due yet (signed difference so this keeps working when micros() rolls over)
+
+            // Keep to a fixed rate by scheduling from the due time rather than from now, unless we have fallen a whole period behind
+            t->next += t->period;
+            if ((int32_t)(now - t->next) >= 0) 
+            {   
+                t->next = now + t->period;
+                if (t->skipped < 0xFFFF) t->skipped++;
+            }
+        }
+
+        t->running = true;
+        t->callback();
+        t->running = false;
+
+        took = micros() - now;
+        t->runs++;
+        if (took > t->maxTime) t->maxTime = took;
+        if (took > t->budget && t->overruns < 0xFFFF) t->overruns++;
+    }
+}
+
+uint32_t OSL_Scheduler::timeUntilNextTask(uint8_t exclude)
+{
+    uint32_t soonest = NO_TASK_DUE;
+    uint32_t now = micros();
+    long remaining;
+
+    for (uint8_t i=0; i<MAX_SCHEDULER_TASKS; i++)
+    {
+        if (i == exclude || _task[i].callback == NULL || _task[i].running || _task[i].period == 0) continue;
+        remaining = (int32_t)(_task[i].next - now);
+        if (remaining <= 0) return 0;
+        if ((uint32_t)remaining < soonest) soonest = remaining;
+    }
+    return soonest;
+}
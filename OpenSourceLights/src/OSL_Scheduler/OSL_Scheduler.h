@@ -0,0 +1,74 @@
+/* OSL_Scheduler.h      Scheduler - a small cooperative, fixed-rate task scheduler
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Each task is a plain function with a period and a time budget, both in microseconds. A period of 0 makes it an event task that is 
+ * given a chance on every pass, for work that is triggered by interrupts (a new RC pulse, a byte on the serial port) and should be 
+ * handled as soon as possible. Other tasks run once their period has elapsed. Tasks are checked in order of their task number, so 
+ * give the lowest numbers to the fastest tasks (rate-monotonic order). 
+ *
+ * This is cooperative: a task runs until it returns. If a task takes longer than its budget, its overrun count goes up. Some of OSL's 
+ * tasks wait on things (radio setup, change-scheme mode) and keep the other tasks going by calling run() themselves. That is allowed - a 
+ * task that is already running is skipped, so nothing is ever re-entered.
+ *
+ * A periodic task that falls more than one full period behind is not run repeatedly to catch up. It runs once and its schedule starts 
+ * again from the current time (counted in "skipped"). 
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+#ifndef OSL_Scheduler_h
+#define OSL_Scheduler_h
+
+#include <Arduino.h>
+#include "../OSL_Settings/OSL_Settings.h"
+
+
+// Note: MAX_SCHEDULER_TASKS is defined in OSL_Settings.h
+
+typedef void (*task_callback)(void);
+
+typedef struct
+{
+    task_callback   callback;                               // Function to run, NULL if this task number is unused
+    uint32_t        period;                                 // uS between runs, 0 for an event task (every pass)
+    uint32_t        budget;                                 // uS the task is expected to finish within
+    uint32_t        next;                                   // micros() time the task is next due
+    uint32_t        runs;                                   // How many times it has run
+    uint16_t        overruns;                               // How many times it took longer than its budget
+    uint16_t        skipped;                                // How many times it fell a whole period or more behind
+    uint32_t        maxTime;                                // Longest it has taken, in uS
+    boolean         running;                                // True while the task is executing
+} SchedulerTask;
+
+class OSL_Scheduler
+{   public:
+        OSL_Scheduler();
+
+        const static uint32_t NO_TASK_DUE = 0xFFFFFFFF;
+        const static uint8_t  NO_TASK = 0xFF;
+
+        void setTask(uint8_t task, task_callback f, uint32_t period, uint32_t budget);     // Define task number "task", any existing task with that number is replaced
+        void run(void);                                                                 // Run every task that is due. Call this from loop() (and from anything that waits)
+        uint32_t timeUntilNextTask(uint8_t exclude = NO_TASK);                          // uS until the next periodic task is due, NO_TASK_DUE if none. Event tasks and running tasks are ignored.
+        const SchedulerTask & get(uint8_t task) { return _task[task]; }
+        void resetStats(void);
+
+    private:
+        SchedulerTask   _task[MAX_SCHEDULER_TASKS];
+};
+
+
+#endif 
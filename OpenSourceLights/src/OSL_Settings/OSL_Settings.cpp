@@ -51,4 +51,29 @@ const __FlashStringHelper *printRadioState(char rcstate) {
 	if (rcstate>LAST_RC_STATE) rcstate = RC_SIGNAL_UNINITIALIZED;
 	const __FlashStringHelper *StateNames[LAST_RC_STATE+1]={F("UNINITIALIZED"),F("Acquiring"),F("Connected"),F("Disconnected")};
 	return StateNames[rcstate];
-};
\ No newline at end of file
+};
+
+// Function to print the names of the profiler sections
+const __FlashStringHelper *printProfileSection(char section) {
+	if (section>LAST_PROFILE_SECTION) section = PROF_LOOP;
+	const __FlashStringHelper *Names[LAST_PROFILE_SECTION+1]={F("Vehicle Logic"),F("PerLoopUpdates"),F("RC Pulses"),F("RC Check"),F("Timer"),F("LED Updates"),F("SetLights"),F("EEPROM Save")};
+	return Names[section];
+};
+
+// Function to print the names of the scheduler tasks
+const __FlashStringHelper *printTaskName(char task) {
+	if (task>LAST_TASK) task = TASK_RC;
+	const __FlashStringHelper *Names[TASK_PIXELS+1]={F("RC"),F("Serial"),F("Lights"),F("Vehicle"),F("Status"),F("Telemetry"),F("Setup"),F("Sync"),F("Pixels")};
+	return Names[task];
+};
+
+// Function to print the names of the user parameters that can be changed from the serial console. These match the names in AA_UserConfig.h
+const __FlashStringHelper *printParamName(char param) {
+	if (param>=NUM_PARAMS) param = PARAM_THROTTLE_DEADBAND;
+	const __FlashStringHelper *Names[NUM_PARAMS]={F("ThrottleDeadband"),F("TurnDeadband"),F("smoothingStrength"),F("DoubleTapReverse"),
+												  F("LongStopTime_mS"),F("BrakeAtThrottlePctBelow"),F("BlinkTurnOnlyAtStop"),F("TurnSignalDelay_mS"),
+												  F("TurnFromStartContinue_mS"),F("AccelPct"),F("OvertakeTime"),F("DecelPct"),F("BF_Time_Short"),
+												  F("BF_Time_Long"),F("BlinkInterval"),F("FastBlinkInterval"),F("DimLevel"),F("FadeOutTime"),
+												  F("FadeInTime"),F("SafetyBlinkRate"),F("SafetyBlinkCount"),F("SafetyBlink_Pause")};
+	return Names[param];
+};
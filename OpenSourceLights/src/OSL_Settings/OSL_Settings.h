@@ -11,6 +11,7 @@
 #define OSL_SETTINGS_H
 
 #include <Arduino.h>
+#include "../../AA_UserConfig.h"							// For ShiftRegisters, which sets NumLights
 
 
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->>
@@ -23,7 +24,7 @@
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->>
 // PINS & HARDWARE DEFINITIONS
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->>	
-	#define NumLights				      8					// How many light outputs do we have on this board
+	#define NumLights	(8 + (8 * ShiftRegisters))			// How many light outputs do we have: 8 on the board, and 8 on each shift register (see SHIFT REGISTER OUTPUTS below)
 
 
 
@@ -219,14 +220,108 @@
         #define pin_HW2_RedLED           19       			// Output   - on-board Red LED (this is the same as saying pin A5) 
 		#define pin_HW2_SetupButton      14       			// Input    - on-board push button (this is the same as saying pin A0) 
 
+	// SHIFT REGISTERS
+	// --------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Only used if ShiftRegisters in AA_UserConfig.h is more than 0, on either hardware version. The hardware SPI pins are taken by lights 2 and 3, so 
+	// the registers are clocked by hand from two free pins, which must be on the same port. The latch uses version check pin A, which is not connected 
+	// on any board so far and is only read once at startup, before the registers are started. 
+		#define pin_ShiftData            12					// Output   - 74HC595 SER (pin 14) of the first register
+		#define pin_ShiftClock           13					// Output   - SRCLK (pin 11) of every register
+		#define pin_ShiftLatch           pin_VCHECK_A		// Output   - RCLK (pin 12) of every register. Tie OE low and SRCLR high.
+
+	// ADDRESSABLE PIXELS
+	// --------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Only used if PixelCount in AA_UserConfig.h is more than 0. It takes the shift register data pin, so the two can't be used together. 
+		#define pin_Pixels               12					// Output   - DIN of the first WS2812 pixel, through a 330 ohm resistor
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// PIN CHANGE INTERRUPTS
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// The RC inputs are measured with pin change interrupts. If PCINT_TEMPLATE_DISPATCH is true, the RC tab defines the port 1 and port 2 interrupt vectors 
+	// itself with the templates in src/OSL_PinChangeDispatch, which call the channel handlers directly. The pins are then fixed when compiling, so 
+	// both hardware versions must use the same RC pins. If false, the vectors come from the PinChangeInterrupt library, which looks the handlers up 
+	// through a table at run time. Either way the library keeps port 0 (pins 8-13) for anything else. 
+	#define PCINT_TEMPLATE_DISPATCH    true
+
+	#if PCINT_TEMPLATE_DISPATCH && (pin_HW1_Throttle != pin_HW2_Throttle || pin_HW1_Steering != pin_HW2_Steering || pin_HW1_Ch3 != pin_HW2_Ch3)
+	#error "PCINT_TEMPLATE_DISPATCH needs the same RC pins on every hardware version"
+	#endif
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// SHIFT REGISTER OUTPUTS
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Lights 9 and up are on 74HC595 shift registers, dimmed by the bit angle modulation in src/OSL_ShiftOutput. Timer1 runs it, so lights 1 and 2 
+	// lose their hardware PWM and are dimmed by the same interrupt instead. The shortest period has to be long enough to clock a byte into every 
+	// register, so it grows with the number of registers. Each frame is 255 of those, and the interrupt is busy for about 8 of them, or 3% of the CPU.
+	// Each register adds 8 lights of about 82 bytes of RAM each (see Extra Lights in AA_UserConfig.h). SHIFT_MAX_REGISTERS is as many as would fit 
+	// if nothing but the lights and the serial port used RAM, so it is a ceiling: check "Global variables use" when compiling.
+	#define SHIFT_RAM_PER_REGISTER      660					// 8 lights at 82 bytes
+	#define SHIFT_RAM_FREE             (2048 - 300 - (8 * 82) - 157)		// ATmega328 RAM, less 300 for the stack, the 8 lights on the board and the serial buffers
+	#define SHIFT_MAX_REGISTERS        (SHIFT_RAM_FREE / SHIFT_RAM_PER_REGISTER)	// 1, 8 + 8 = 16 lights
+	// From the cycle counts of OSL_ShiftOutput::shift and tick at 16 MHz: 
+	#define SHIFT_MAX_PINS                2					// Arduino pins dimmed along with the registers (lights 1 and 2)
+	#define SHIFT_NO_OUTPUT            0xFF					// Returned by addPin() when there is no room
+	#define SHIFT_BAM_BITS                8					// Brightness is 0-255
+	#define SHIFT_BYTE_US                 5					// Clocking one byte out by hand
+	#define SHIFT_TICK_OVERHEAD_US        6					// Getting in and out of the interrupt, the latch, the Arduino pins and the timer
+	#define SHIFT_BAM_TICK_US          (SHIFT_TICK_OVERHEAD_US + (ShiftRegisters * SHIFT_BYTE_US))		// Shortest period (1 register = 11 uS)
+	#define SHIFT_FRAME_US             (SHIFT_BAM_TICK_US * 255UL)										// Whole frame (1 register = 2.8 mS)
+	#define SHIFT_MIN_REFRESH_HZ         80					// Slower than this and the dimmed lights start to flicker
+	#define SHIFT_PLANE_BYTES          (ShiftRegisters > 0 ? ShiftRegisters : 1)
+
+	#if ShiftRegisters > SHIFT_MAX_REGISTERS
+	#error "No more than SHIFT_MAX_REGISTERS shift registers, there isn't RAM for the lights on any more"
+	#endif
+	#if ShiftRegisters > 0 && (1000000UL / SHIFT_FRAME_US) < SHIFT_MIN_REFRESH_HZ
+	#error "Too many shift registers for a flicker-free refresh, each one makes the frame longer"
+	#endif
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// ADDRESSABLE PIXELS
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// WS2812 pixels are written by OSL_PixelOutput::send, which clocks each bit out by hand in exactly 20 cycles at 16 MHz, so interrupts have to be 
+	// off while it runs. An RC edge that comes in meanwhile is timestamped late by up to the length of the burst, which makes that pulse read long 
+	// or short by as much. So the strip is sent PixelsPerBurst pixels at a time, letting any waiting interrupts run in between. The pixels don't latch 
+	// until the line has been low for their reset time, and if an interrupt keeps it low longer than PIXEL_GAP_MAX_US the whole frame is sent again 
+	// on the next pass. Run tools/osl_pixel_timing.py for the numbers at every burst size. 
+	#define PIXEL_MAX_COUNT              64					// 3 bytes of RAM each
+	#define PIXEL_US                     30					// 24 bits at 800 kHz
+	#define PIXEL_BURST_OVERHEAD_US       2					// Reading the port and loading the first byte, with interrupts off
+	#define PIXEL_BURST_PIXELS         (PixelsPerBurst == 0 || PixelsPerBurst > PixelCount ? PixelCount : PixelsPerBurst)
+	#define PIXEL_BURST_US             ((PIXEL_BURST_PIXELS * PIXEL_US) + PIXEL_BURST_OVERHEAD_US)		// Longest time interrupts are off (1 pixel = 32 uS)
+	#define PIXEL_MAX_BURST_US          500					// Longer than this and bytes coming in on the serial port are lost (the UART holds two, 520 uS at 38400 baud)
+	#define PIXEL_GAP_MAX_US             40					// Longest the line can stay low between bursts without latching. The WS2812B datasheet gives 50 uS, SK6812 80 uS, 
+															// WS2812B-V5 and WS2813 280 uS. Some older WS2812B latch after only 6 uS, with those set PixelsPerBurst to 0.
+	#define PIXEL_FRAME_MS               10					// How often the strip is updated, if anything has changed
+	#define PIXEL_BUFFER_BYTES         (PixelCount > 0 ? PixelCount * 3 : 1)
+
+	#if PixelCount > PIXEL_MAX_COUNT
+	#error "No more than PIXEL_MAX_COUNT pixels"
+	#endif
+	#if PixelCount > 0 && ShiftRegisters > 0
+	#error "Pixels and shift registers both use pin 12, only one of them can be used"
+	#endif
+	#if PixelCount > 0 && PIXEL_BURST_US > PIXEL_MAX_BURST_US
+	#error "Interrupts would be off too long for the serial port, set PixelsPerBurst lower"
+	#endif
+
 
 
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->>
 // EEPROM macros
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->>
-    #define eeprom_read_to(dst_p, eeprom_field, dst_size) eeprom_read_block(dst_p, (void *)offsetof(__eeprom_data, eeprom_field), MIN(dst_size, sizeof((__eeprom_data*)0)->eeprom_field))
+	// All EEPROM reads and writes go through the EEPROMWriter object (src/OSL_EEPROMWriter), which writes in the background from the EEPROM ready 
+	// interrupt instead of waiting 3.3 mS for each byte. Its queue should be at least as long as a config store slot, so a save never has to wait.
+	#define EEPROM_WRITE_QUEUE_LENGTH    32					// Bytes, 3 bytes of RAM each. No more than 127.
+    #define eeprom_read_to(dst_p, eeprom_field, dst_size) EEPROMWriter.readBlock(dst_p, offsetof(__eeprom_data, eeprom_field), MIN(dst_size, sizeof((__eeprom_data*)0)->eeprom_field))
     #define eeprom_read(dst, eeprom_field) eeprom_read_to(&dst, eeprom_field, sizeof(dst))
-    #define eeprom_write_from(src_p, eeprom_field, src_size) eeprom_write_block(src_p, (void *)offsetof(__eeprom_data, eeprom_field), MIN(src_size, sizeof((__eeprom_data*)0)->eeprom_field))
+    #define eeprom_write_from(src_p, eeprom_field, src_size) EEPROMWriter.writeBlock(src_p, offsetof(__eeprom_data, eeprom_field), MIN(src_size, sizeof((__eeprom_data*)0)->eeprom_field))
     #define eeprom_write(src, eeprom_field) { typeof(src) x = src; eeprom_write_from(&x, eeprom_field, sizeof(x)); }
     #define MIN(x,y) ( x > y ? y : x )
     #define MAX(x,y) ( x > y ? x : y )
@@ -239,7 +334,8 @@
     // We use the OSL_SimpleTimer class for convenient timing functions throughout the project, it is a modified and improved version 
     // of SimpleTimer: http://playground.arduino.cc/Code/SimpleTimer
     // The class needs to know how many simultaneous timers may be active at any one time. We don't want this number too low or operation will be eratic, 
-    // but setting it too high will waste RAM. Each additional slot costs 19 bytes of global RAM. 
+    // but setting it too high will waste RAM. Each additional slot costs 23 bytes of global RAM. Timers are kept ordered by deadline, so the number 
+    // of slots has no effect on how long timer.run() takes when nothing is due, and only a small (logarithmic) effect when starting or stopping a timer. 
 	// Timers used by this project: 
 	// - Turn from start continue (used for both forward and reverse, but will not occur at the same time) = 1 timer (no timer ID)
 	// - BackfireTimerID, OvertakeTimerID - by definition will never occur at the same time = 1 timer
@@ -255,11 +351,312 @@
 
 
 
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// EEPROM CONFIG STORE
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Radio calibration and the selected scheme (the Config struct) are saved by the OSL_ConfigStore object, which writes each save as a new record 
+	// in the next of EEPROM_CONFIG_SLOTS slots, so no one byte of EEPROM is rewritten every time. Firmware before the config store kept these in the 
+	// __eeprom_data struct at address 0, which is read once to carry the calibration over and otherwise left alone. 
+	#define CONFIG_SCHEMA_VERSION         1					// Change this any time the Config struct changes, and add a migration from the old version to MigrateConfig
+	#define EEPROM_CONFIG_START          32					// First EEPROM address of the ring, after the old __eeprom_data struct
+	#define EEPROM_CONFIG_SLOTS           7
+	#define EEPROM_CONFIG_SLOT_SIZE      32					// Each slot holds up to 26 bytes of data plus 6 of header and CRC
+
+	#if EEPROM_CONFIG_SLOT_SIZE > EEPROM_WRITE_QUEUE_LENGTH
+	#error "A config store save would have to wait for room in the EEPROM write queue"
+	#endif
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// EEPROM SCHEME BANK
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Schemes uploaded over the serial port are kept in fixed-size slots at the top of EEPROM, one slot per scheme number. A valid slot takes
+	// precedence over the scheme of the same number in AA_LightSetup. Each slot starts with a small header (format version, number of lights, CRC)
+	// followed by the NumLights x NumStates table of settings, in the same order as the Schemes array.
+	// Slot header: 	byte 0 		SCHEME_FORMAT_VERSION 	(0xFF = empty/erased slot)
+	//					byte 1 		NumLights
+	//					byte 2-3	CRC-16/XMODEM over bytes 0-1 and the settings, low byte first
+	#define SCHEME_FORMAT_VERSION         1					// Change this any time the layout or meaning of a scheme table changes (number of states, setting numbers, etc.)
+	#define EEPROM_SCHEME_BANK_START    512					// First EEPROM address of the bank. Everything below is the config store and the user parameters.
+	#define EEPROM_SCHEME_HEADER_SIZE     4
+	#define EEPROM_SCHEME_DATA_SIZE     (NumLights * NumStates)
+	#define EEPROM_SCHEME_SLOT_SIZE     (EEPROM_SCHEME_HEADER_SIZE + EEPROM_SCHEME_DATA_SIZE)
+	#define EEPROM_SCHEME_SLOTS_FIT     ((1024 - EEPROM_SCHEME_BANK_START) / EEPROM_SCHEME_SLOT_SIZE)
+	// Number of schemes that can be stored in EEPROM (schemes 1 through 4). With shift registers there are fewer slots, and none once a scheme 
+	// is too big for the length byte of an upload frame (more than 17 lights). 
+	#define EEPROM_SCHEME_SLOTS         (EEPROM_SCHEME_DATA_SIZE > 255 ? 0 : MIN(4, EEPROM_SCHEME_SLOTS_FIT))
+	#define EEPROM_SCHEME_SLOT_EMPTY   0xFF
+
+	#if (EEPROM_SCHEME_BANK_START + (EEPROM_SCHEME_SLOTS * EEPROM_SCHEME_SLOT_SIZE)) > 1024
+	#error "EEPROM scheme bank does not fit in the 1024 bytes of EEPROM on the ATmega328"
+	#endif
+
+	// Upload protocol. Every frame in either direction starts with UPLOAD_SOF, a byte that never occurs in the text we print, so uploads
+	// can share the serial port with debugging output.
+	// Host -> OSL: 	SOF  cmd  scheme  version  length  payload[length]  crc_hi  crc_lo		(CRC-16/XMODEM over cmd through the end of the payload)
+	// OSL  -> Host: 	SOF  cmd  status  [for UPLOAD_CMD_INFO: SCHEME_FORMAT_VERSION, NumLights, NumStates, NumSchemes, EEPROM_SCHEME_SLOTS]
+	#define UPLOAD_SOF                 0xA5
+	#define UPLOAD_CMD_INFO             'I'					// Report the scheme format this firmware expects
+	#define UPLOAD_CMD_WRITE            'W'					// Store the payload in the EEPROM slot for "scheme"
+	#define UPLOAD_CMD_ERASE            'E'					// Erase the EEPROM slot for "scheme" (the AA_LightSetup scheme is used again)
+	#define UPLOAD_OK                     0
+	#define UPLOAD_ERR_CRC                1
+	#define UPLOAD_ERR_VERSION            2
+	#define UPLOAD_ERR_SCHEME             3
+	#define UPLOAD_ERR_LENGTH             4
+	#define UPLOAD_ERR_SETTING            5
+	#define UPLOAD_ERR_COMMAND            6
+	#define UPLOAD_TIMEOUT_MS           500					// A frame that stalls for this long is thrown away
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// USER PARAMETERS AND SERIAL CONSOLE
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Most of the timing and threshold settings in AA_UserConfig.h can be changed while the car is running by typing commands into the serial monitor 
+	// (see the CONSOLE tab). The values in AA_UserConfig.h are the defaults, the working copy is kept in RAM (the UserParams struct) and can be saved 
+	// to a block of EEPROM between the config store and the scheme bank. 
+	// Block header: 	byte 0 		PARAMS_FORMAT_VERSION 	(0xFF = never saved)
+	//					byte 1 		Number of bytes of data that follow the header
+	//					byte 2-3	CRC-16/XMODEM over bytes 0-1 and the data, low byte first
+	#define PARAMS_FORMAT_VERSION         1					// Change this any time parameters are added, removed or re-ordered, and add a migration from the old version to MigrateUserParams
+	#define EEPROM_PARAMS_START         256					// First EEPROM address of the block
+	#define EEPROM_PARAMS_HEADER_SIZE     4
+	#define EEPROM_PARAMS_EMPTY        0xFF
+	#define CONSOLE_LINE_LENGTH          32					// Longest command line the console will accept, anything longer is thrown away
+
+	#if (EEPROM_CONFIG_START + (EEPROM_CONFIG_SLOTS * EEPROM_CONFIG_SLOT_SIZE)) > EEPROM_PARAMS_START
+	#error "EEPROM config store runs into the user parameter block"
+	#endif
+
+	// Parameter numbers, in the order they are listed. The names printed are the same as the #define names in AA_UserConfig.h
+	#define PARAM_THROTTLE_DEADBAND       0
+	#define PARAM_TURN_DEADBAND           1
+	#define PARAM_SMOOTHING_STRENGTH      2
+	#define PARAM_DOUBLE_TAP_REVERSE      3
+	#define PARAM_LONG_STOP_TIME          4
+	#define PARAM_BRAKE_AT_THROTTLE_PCT   5
+	#define PARAM_BLINK_TURN_ONLY_AT_STOP 6
+	#define PARAM_TURN_SIGNAL_DELAY       7
+	#define PARAM_TURN_FROM_START         8
+	#define PARAM_ACCEL_PCT               9
+	#define PARAM_OVERTAKE_TIME          10
+	#define PARAM_DECEL_PCT              11
+	#define PARAM_BF_TIME_SHORT          12
+	#define PARAM_BF_TIME_LONG           13
+	#define PARAM_BLINK_INTERVAL         14
+	#define PARAM_FAST_BLINK_INTERVAL    15
+	#define PARAM_DIM_LEVEL              16
+	#define PARAM_FADE_OUT_TIME          17
+	#define PARAM_FADE_IN_TIME           18
+	#define PARAM_SAFETY_BLINK_RATE      19
+	#define PARAM_SAFETY_BLINK_COUNT     20
+	#define PARAM_SAFETY_BLINK_PAUSE     21
+	#define NUM_PARAMS                   22
+	const __FlashStringHelper *printParamName(char param);		// Returns a character string that is the name of the parameter
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// TASK SCHEDULER
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Everything the firmware does is split into tasks that OSL_Scheduler runs at a fixed rate (see the TASKS tab). Task numbers are also priorities, 
+	// lowest number first. Periods and budgets are in microseconds. A period of 0 means the task is checked on every pass because it responds to 
+	// an interrupt. Budgets are how long a task should normally take. Send "s" over the serial port to see how often each one has gone over. 
+	#define MAX_SCHEDULER_TASKS      (PixelCount > 0 ? 9 : 8)		// Each slot takes 27 bytes of RAM, the pixel task only gets one if it's used
+	
+	#define TASK_RC                       0					// Process new RC pulses as soon as the pin change interrupts have measured them
+	#define TASK_RC_PERIOD_US             0
+	#define TASK_RC_BUDGET_US           300
+	
+	#define TASK_SERIAL                   1					// Serial commands and scheme uploads. Uploaded schemes are queued for the background EEPROM writer as room comes free
+	#define TASK_SERIAL_PERIOD_US         0
+	#define TASK_SERIAL_BUDGET_US      2000					// Longest measured by host/tests/test_eeprom_stall is 1.6 mS, a console reply waiting for room to send. The long 
+															// printouts (help, "s") wait much longer and go over.
+	
+	#define TASK_LIGHTS                   2					// Light effects and SimpleTimer at 1 kHz (the setup button is read by the Timer2 interrupt)
+	#define TASK_LIGHTS_PERIOD_US      1000
+	#define TASK_LIGHTS_BUDGET_US       500
+	
+	#define TASK_VEHICLE                  3					// Drive mode, turn signals, change-scheme mode and setting the lights at 100 Hz
+	#define TASK_VEHICLE_PERIOD_US    10000
+	#define TASK_VEHICLE_BUDGET_US     2000
+	
+	#define TASK_STATUS                   4					// RC signal watchdog at 10 Hz (once every RC_TIMEOUT_MS), and auto calibration
+	#define TASK_STATUS_PERIOD_US    (RC_TIMEOUT_MS * 1000UL)
+	#define TASK_STATUS_BUDGET_US       300
+	
+	#define TASK_TELEMETRY                5					// Telemetry snapshot every TelemetryInterval_mS, only if EnableTelemetry = true (see AA_UserConfig.h)
+	#define TASK_TELEMETRY_PERIOD_US (TelemetryInterval_mS * 1000UL)
+	#define TASK_TELEMETRY_BUDGET_US    300
+	
+	#define TASK_SETUP                    6					// Radio setup, only does anything while a setup is under way (see RADIO_SETUP)
+	#define TASK_SETUP_PERIOD_US      10000
+	#define TASK_SETUP_BUDGET_US       2000
+	
+	#define TASK_SYNC                     7					// Multi-board sync link at 100 Hz, only if SyncRole isn't SYNC_OFF (see AA_UserConfig.h)
+	#define TASK_SYNC_PERIOD_US      (SYNC_INTERVAL_MS * 1000UL)
+	#define TASK_SYNC_BUDGET_US         500
+	
+	#define TASK_PIXELS                   8					// Addressable pixels at 100 Hz, only if PixelCount is more than 0 (see AA_UserConfig.h)
+	#define TASK_PIXELS_PERIOD_US    (PIXEL_FRAME_MS * 1000UL)
+	#define TASK_PIXELS_BUDGET_US    (100 + (PixelCount * 45UL))	// Sending each pixel, the gap after it and working out its color
+	
+	#define LAST_TASK                (MAX_SCHEDULER_TASKS - 1)
+	const __FlashStringHelper *printTaskName(char task);		// Returns a character string that is the name of the task
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// RADIO SETUP
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Radio setup is started by holding the setup button for two seconds, and runs as a task alongside everything else. Each stage reads the channels 
+	// once per run of the task. Stage 1 keeps the lowest and highest pulse seen. Stages 2 and 3 look at the readings a window at a time, and take the 
+	// average of the first window in which every channel was held still (its variance was no more than SETUP_STILL_VARIANCE). 
+	#define SETUP_MINMAX_TIME_MS      15000					// How long stage 1 reads the extremes for
+	#define SETUP_SETTLE_MS            2000					// Stages 2 and 3: time for the user to get the sticks in place before we start checking
+	#define SETUP_WINDOW_MS            1000					// Stages 2 and 3: length of each window of readings
+	#define SETUP_STILL_VARIANCE         36					// uS squared. Sticks held still typically vary by only a few uS. 
+	#define SETUP_READ_TIMEOUT_MS     10000					// Stages 2 and 3: if nothing is still by now, use the last window anyway
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// SETUP BUTTON
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// The setup button is read by the InputButton object (src/OSL_ButtonEvents) from the Timer2 overflow interrupt. Timer2 is already running for PWM 
+	// on Lights 3 and 6 and overflows every 2.04 mS (16 MHz / 64 / 510), we just turn its overflow interrupt on. The interrupt debounces the button 
+	// and turns presses into the events below, which VehicleLogic takes from a small queue. If the queue is full, new events are dropped. 
+	#define BUTTON_TICK_US             2040					// Time between Timer2 overflows
+	#define BUTTON_DEBOUNCE_MS           25					// The pin has to read the same for this long before a press or release counts
+	#define BUTTON_DOUBLE_CLICK_MS      400					// A second click within this long of the first makes a double click
+	#define BUTTON_LONG_PRESS_MS       2000					// Held this long is a long press (starts Radio Setup)...
+	#define BUTTON_REPEAT_MS            500					// ...and after that, one hold-repeat event this often until it's let go
+	#define BUTTON_EVENT_QUEUE_LENGTH     4
+
+	#define BUTTON_NONE                   0					// Nothing waiting
+	#define BUTTON_CLICK                  1
+	#define BUTTON_DOUBLE_CLICK           2
+	#define BUTTON_LONG_PRESS             3
+	#define BUTTON_HOLD_REPEAT            4
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// MULTI-BOARD SYNC
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Boards can be chained so that one reads the radio (the master) and the others (followers) show the same vehicle state with their own schemes. 
+	// The master's TX pin goes to every follower's RX pin, with the grounds joined. Every SYNC_INTERVAL_MS the master sends a 5 byte frame 
+	// (src/OSL_SyncLink): a start byte, the vehicle state word below, a phase counter and a CRC-8. The phase counter goes up once per BLINK cycle 
+	// (twice the blink interval), and master and followers restart their continuous blinks on it so they stay in step. 
+	#define SYNC_OFF                      0					// Values for SyncRole in AA_UserConfig.h
+	#define SYNC_MASTER                   1
+	#define SYNC_FOLLOWER                 2
+	#define SYNC_INTERVAL_MS             10					// How often the master sends the vehicle state (100 Hz)
+	#define SYNC_TIMEOUT_MS             250					// A follower that hears nothing for this long goes into failsafe
+
+	// The vehicle state word
+	#define SYNC_DRIVE_MODE_SHIFT         0					// 2 bits - STOP, FWD, REV
+	#define SYNC_CHANNEL3_SHIFT           2					// 3 bits - Pos1 to Pos5
+	#define SYNC_TURN_SHIFT               5					// 2 bits - turn command, 0 = none, 1 = right, 2 = left
+	#define SYNC_OVERRIDE_SHIFT           7					// 2 bits - turn signal override, same
+	#define SYNC_BRAKING               0x0200
+	#define SYNC_STOPPED_LONG          0x0400
+	#define SYNC_TURN_SIGNAL_ENABLE    0x0800
+	#define SYNC_BACKFIRE              0x1000
+	#define SYNC_OVERTAKING            0x2000
+	#define SYNC_RC_STATE_SHIFT          14					// 2 bits - RC_SIGNAL_UNINITIALIZED to RC_SIGNAL_LOST, so followers also go into shelf-queen mode and failsafe with the master
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// AUTO CALIBRATION
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// When EnableAutoCalibration is set in AA_UserConfig.h, every good pulse on a synched throttle or steering channel is checked against the learned
+	// extremes, and counted toward the center if the stick is resting near the saved center. That is all that happens per pulse. Once every 
+	// AUTOCAL_UPDATE_MS the extremes are shrunk by AUTOCAL_DECAY_US and the center is moved to the average resting pulse, if the stick rested for long 
+	// enough. The results go straight into RC_Channel. The extremes are saved to the config store at most once every AUTOCAL_SAVE_INTERVAL_MS, both 
+	// channels together. The learned center is never saved and never more than AUTOCAL_CENTER_WINDOW_US from the one Radio Setup saved.
+	#define AUTOCAL_CHANNELS              2					// Throttle and steering. Channel 3 is a switch, Radio Setup's calibration of it is left alone.
+	#define AUTOCAL_UPDATE_MS          1000					// How often the learned values are applied
+	#define AUTOCAL_STILL_US              4					// A pulse within this much of the one before counts as resting...
+	#define AUTOCAL_CENTER_WINDOW_US     60					// ...if it is also within this much of the saved center, which is also as far as the center can move
+	#define AUTOCAL_DWELL_PULSES         40					// Resting pulses needed in one update to move the center (about 50 pulses a second arrive per channel)
+	#define AUTOCAL_DECAY_US              1					// How much the extremes shrink per update when the sticks don't reach them
+	#define AUTOCAL_MIN_SPAN_US         350					// The extremes never shrink to closer than this to the center
+	#define AUTOCAL_SAVE_INTERVAL_MS 300000UL				// At most one save every five minutes...
+	#define AUTOCAL_SAVE_THRESHOLD_US    10					// ...and only if a value has moved by more than this since it was last saved
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// IDLE SLEEP
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// When EnableIdleSleep is set in AA_UserConfig.h, the processor is put into idle sleep whenever nothing is due. Idle mode stops the CPU but leaves the 
+	// timers (so PWM and millis), the UART and the pin change interrupts running. The millis() interrupt still wakes the processor every 1.024 mS, so we 
+	// go back to sleep each time until the next timer, light effect or task is due. Nothing is polled: the setup button is read by the Timer2 interrupt, 
+	// and a radio pulse or serial data wakes us early. The RC task has no period, so it doesn't count, but the status task always runs every RC_TIMEOUT_MS 
+	// and that is the longest we stay asleep.
+	#define IDLE_STATS_INTERVAL_MS    10000					// If DEBUG is true, how often to print the percentage of time spent asleep
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// PROFILER
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Sections of the main loop timed by OSL_Profiler when PROFILER is set to true in AA_UserConfig.h. Send "p" over the serial port to print 
+	// the results, "r" to reset them. 
+	#define PROF_LOOP                     0					// One pass through VehicleLogic()
+	#define PROF_PERLOOP                  1					// PerLoopUpdates() - one pass of the task scheduler
+	#define PROF_RC_PULSES                2					// ProcessChannelPulses()
+	#define PROF_RC_CHECK                 3					// CheckRCStatus()
+	#define PROF_TIMER                    4					// timer.run(), including any callbacks that come due
+	#define PROF_LEDS                     5					// update() for the two onboard LEDs and all NumLights outputs
+	#define PROF_SETLIGHTS                6					// SetLights()
+	#define PROF_EEPROM                   7					// SaveConfig() - saving the radio calibration or the selected scheme
+	#define PROFILE_SECTIONS              8
+	#define LAST_PROFILE_SECTION    PROF_EEPROM
+	const __FlashStringHelper *printProfileSection(char section);	// Returns a character string that is the name of the profiler section
+	
+	#define PROFILE_BUCKETS               8					// Histogram buckets per section: <16, <32, <64, <128, <256, <512, <1024, and 1024 uS or more
+	#define PROFILE_FIRST_BUCKET_US      16					// Upper limit of the first bucket. Don't go below 8, micros() only counts in 4 uS steps.
+
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+// TRACE
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->>
+	// Events logged by OSL_Trace when TRACE is set to true in AA_UserConfig.h. Send "t" over the serial port to dump the buffer, tools/osl_trace_decode.py 
+	// decodes it. If you add or change an event here, change the decoder to match. 
+	#define TRACE_PULSE_REJECT            1					// A pulse outside PULSE_WIDTH_ABS_MIN/MAX was thrown away. arg = channel, value = pulse width in uS
+	#define TRACE_CHANNEL_STATE           2					// A channel changed state. arg = channel, value = new state (RC_SIGNAL_ACQUIRE, etc.)
+	#define TRACE_RC_STATE                3					// The overall radio state changed. arg = new state
+	#define TRACE_DRIVE_MODE              4					// The drive mode or braking changed. arg = drive mode (STOP, FWD, REV), value = 1 if braking
+	#define TRACE_LIGHT_SETTING           5					// A light changed setting. arg = light (0 to NumLights-1), value = setting (ON, OFF, etc.)
+
+	#define TRACE_RECORDS                32					// Number of events kept, must be a power of two. Each takes 8 bytes of RAM. 
+	#define TRACE_FORMAT_VERSION          1					// Change this if the dump or record layout changes
+	#define TRACE_DUMP_MAGIC      "OSLT"					// Marks the start of a dump
+
+
+
 // ------------------------------------------------------------------------------------------------------------------------------------------------------->>
 // SERIAL
 // ------------------------------------------------------------------------------------------------------------------------------------------------>
     #define BaudRate                 38400          // This is the default baud rate for communication with the computer. 
 
+	// At 38400 baud each character takes 260 uS to send and the Arduino's transmit buffer only holds 64, after that Serial.print() waits. So debug messages 
+	// printed while driving are queued as short records instead and printed by the serial task only when there is room for the whole message. The 
+	// long dumps (DumpSystemInfo, etc.) keep the other tasks running while they wait for room, see WaitForSerial().
+	#define DEBUG_QUEUE_LENGTH            8					// Messages waiting to be printed. If it fills up, messages are dropped (and counted).
+	#define DEBUG_MESSAGE_MAX            40					// Room needed in the transmit buffer before printing a message, must be at least as long as the longest message
+	#define DBG_LIGHT_SETTING             1					// "Light 1: Fade Off"                  arg = light, value = setting
+	#define DBG_DRIVE_MODE                2					// "Drive Mode: Forward"                arg = drive mode
+	#define DBG_RADIO_STATE               3					// "Radio state change: Lost!"          arg = radio state
+	#define DBG_SCHEME_CHANGED            4					// "Scheme 1 loaded from EEPROM"        arg = scheme, value = 1 if from EEPROM
+	#define DBG_IDLE_STATS                5					// "Idle: 85.2% asleep"                 value = percent asleep x 10
+	#define DBG_SCHEME_SELECTED           6					// "Scheme changed to: 2"               arg = scheme
+	#define DBG_CHANGE_SCHEME_MODE        7					// "Exit Change-Scheme-Mode, scheme 2"  arg = scheme, value = 1 entering, 0 leaving
+
 
 
 #endif
@@ -0,0 +1,172 @@
+/* OSL_ShiftOutput.cpp  Shift Output - extra light outputs on a chain of 74HC595 shift registers, dimmed with bit angle modulation
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "OSL_ShiftOutput.h"
+#include <avr/interrupt.h>
+
+OSL_ShiftOutput ShiftOutput;
+
+#define SHIFT_TIMER_COUNTS(us)  ((uint16_t)((us) * (F_CPU / 8000000UL)))    // Timer1 runs at F_CPU / 8
+#define PERIOD_COUNTS(bit)      ((SHIFT_TIMER_COUNTS(SHIFT_BAM_TICK_US) << (bit)) - 1)
+
+
+#if ShiftRegisters > 0
+ISR(TIMER1_COMPA_vect)
+{
+    ShiftOutput.tick();
+}
+#endif
+
+boolean OSL_ShiftOutput::begin(uint8_t dataPin, uint8_t clockPin, uint8_t latchPin, uint8_t registers)
+{
+    uint8_t oldSREG;
+
+    if (ShiftRegisters == 0) return false;                                         // No interrupt to run them
+    if (digitalPinToPort(dataPin) != digitalPinToPort(clockPin)) return false;
+    if (registers > SHIFT_PLANE_BYTES) registers = SHIFT_PLANE_BYTES;
+
+    pinMode(dataPin, OUTPUT);
+    pinMode(clockPin, OUTPUT);
+    pinMode(latchPin, OUTPUT);
+    digitalWrite(dataPin, LOW);
+    digitalWrite(clockPin, LOW);
+    digitalWrite(latchPin, LOW);
+    _shiftPort = portOutputRegister(digitalPinToPort(dataPin));
+    _dataMask = digitalPinToBitMask(dataPin);
+    _clockMask = digitalPinToBitMask(clockPin);
+    _latchPort = portOutputRegister(digitalPinToPort(latchPin));
+    _latchMask = digitalPinToBitMask(latchPin);
+    _registers = registers;
+    _bit = 0;
+    memset(_planes, 0, sizeof(_planes));
+    memset(_pinPlanes, 0, sizeof(_pinPlanes));
+
+    // Everything off before the first frame, the registers power up with anything in them
+    shift(0);
+    *_latchPort |= _latchMask;
+    *_latchPort &= ~_latchMask;
+
+    // Fast PWM with OCR1A as the top. Unlike CTC, OCR1A is double buffered in this mode, so the interrupt sets the length of the period after
+    // the one that has just started and it doesn't matter how late it gets to it. The first period's length is written before the timer starts.
+    oldSREG = SREG;
+    cli();
+    TCCR1B = 0;                                                                     // Stopped, and in normal mode OCR1A isn't buffered
+    TCCR1A = 0;                                                                     // Pins 9 and 10 back to ordinary outputs
+    TCNT1 = 0;
+    OCR1A = PERIOD_COUNTS(0);
+    TCCR1A = _BV(WGM11) | _BV(WGM10);
+    TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS11);                                  // Mode 15, prescaler 8
+    OCR1A = PERIOD_COUNTS(1);                                                       // Goes in at the end of period 0
+    TIFR1 = _BV(OCF1A);
+    TIMSK1 = _BV(OCIE1A);
+    SREG = oldSREG;
+    return true;
+}
+
+uint8_t OSL_ShiftOutput::addPin(uint8_t pin)
+{
+    uint8_t oldSREG;
+    uint8_t n = _pins;
+
+    if (n >= SHIFT_MAX_PINS) return SHIFT_NO_OUTPUT;
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, LOW);                                                         // Also disconnects the pin from its PWM timer
+    oldSREG = SREG;
+    cli();
+    _pinPort[n] = portOutputRegister(digitalPinToPort(pin));
+    _pinMask[n] = digitalPinToBitMask(pin);
+    for (uint8_t b=0; b<SHIFT_BAM_BITS; b++) _pinPlanes[b] &= ~(1 << n);
+    _pins = n + 1;
+    SREG = oldSREG;
+    return (_registers * 8) + n;
+}
+
+void OSL_ShiftOutput::set(uint8_t output, uint8_t level)
+{
+    uint8_t *plane;
+    uint8_t  stride;
+    uint8_t  mask;
+
+    if (output < (_registers * 8))
+    {
+        plane = &_planes[0][output >> 3];
+        stride = SHIFT_PLANE_BYTES;
+        mask = 1 << (output & 7);
+    }
+    else if ((output - (_registers * 8)) < _pins)
+    {
+        plane = &_pinPlanes[0];
+        stride = 1;
+        mask = 1 << (output - (_registers * 8));
+    }
+    else return;
+
+    // One bit of the level goes in each period. The interrupt only reads these, so changing a bit at a time is safe.
+    for (uint8_t b=0; b<SHIFT_BAM_BITS; b++)
+    {
+        if (level & 1) *plane |= mask;
+        else           *plane &= ~mask;
+        level >>= 1;
+        plane += stride;
+    }
+}
+
+void OSL_ShiftOutput::tick(void)
+{   // Runs at the start of each period, with interrupts off
+    uint8_t bit = (_bit + 1) % SHIFT_BAM_BITS;
+
+    // Show the bits for the new period. They were shifted in during the last one.
+    *_latchPort |= _latchMask;
+    *_latchPort &= ~_latchMask;
+    for (uint8_t i=0; i<_pins; i++)
+    {
+        if (_pinPlanes[bit] & (1 << i)) *_pinPort[i] |= _pinMask[i];
+        else                            *_pinPort[i] &= ~_pinMask[i];
+    }
+    OCR1A = PERIOD_COUNTS((bit + 1) % SHIFT_BAM_BITS);                            // The timer has already started this period, this is for the next
+    _bit = bit;
+
+    // Shift in the bits for the next period. Our own interrupt stays off until they're done, but the RC pin change interrupts can run meanwhile
+    // so their timing isn't held up. If that makes us late the next latch is a little late, but the timer keeps time.
+    TIMSK1 &= ~_BV(OCIE1A);
+    sei();
+    shift((bit + 1) % SHIFT_BAM_BITS);
+    cli();
+    TIMSK1 |= _BV(OCIE1A);
+}
+
+void OSL_ShiftOutput::shift(uint8_t bit)
+{   // The last register in the chain goes first, and each byte goes most significant bit first so bit 7 ends up in Q7. Nothing else writes to
+    // this port from an interrupt, so the other pins on it can be read once and written back with every bit.
+    uint8_t low = *_shiftPort & ~(_dataMask | _clockMask);
+    uint8_t high = low | _dataMask;
+
+    for (uint8_t r=_registers; r>0; r--)
+    {
+        uint8_t b = _planes[bit][r - 1];
+        for (uint8_t m=0x80; m; m >>= 1)
+        {
+            uint8_t out = (b & m) ? high : low;
+            *_shiftPort = out;
+            *_shiftPort = out | _clockMask;                                         // The register reads the data on the rising edge
+        }
+    }
+    *_shiftPort = low;
+}
@@ -0,0 +1,75 @@
+/* OSL_ShiftOutput.h    Shift Output - extra light outputs on a chain of 74HC595 shift registers, dimmed with bit angle modulation
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Each register adds 8 outputs. Output 0 is Q0 of the register nearest the Arduino, output 8 is Q0 of the next one, and so on. Each output
+ * has a brightness from 0 to 255, set with set(). Up to SHIFT_MAX_PINS ordinary Arduino pins can be added with addPin() and are dimmed the
+ * same way, which is how lights 1 and 2 keep their PWM when Timer1 is taken over (see below).
+ *
+ * Brightness is made with bit angle modulation (BAM). A frame is split into 8 periods, one for each bit of the brightness, and the period for
+ * bit n is 2^n times as long as the period for bit 0. During each period the outputs are on if that bit of their brightness is set. Timer1
+ * interrupts at the start of every period, latches the bits for that period (they were shifted in during the one before), sets the pins
+ * added with addPin(), and then clocks the bits for the next period into the registers. So each frame takes 8 interrupts, whatever the
+ * brightness of the lights, and there is no SPI burst per output. The length of the shortest period, SHIFT_BAM_TICK_US, is set in
+ * OSL_Settings.h from the number of registers so that the bits for the next period always fit in it.
+ *
+ * set() only changes the bits of one output, in a table of 8 bytes per register that the interrupt reads directly. If the interrupt reads
+ * the table part way through a change the light shows a brightness in between for one frame, which can't be seen.
+ *
+ * begin() takes over Timer1, so analogWrite() no longer works on pins 9 and 10. The interrupt is only compiled if ShiftRegisters in
+ * AA_UserConfig.h is more than 0.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OSL_ShiftOutput_h
+#define OSL_ShiftOutput_h
+
+#include <Arduino.h>
+#include "../../AA_UserConfig.h"
+#include "../OSL_Settings/OSL_Settings.h"
+
+
+class OSL_ShiftOutput
+{   public:
+        OSL_ShiftOutput() : _registers(0), _pins(0) {}
+
+        boolean begin(uint8_t dataPin, uint8_t clockPin, uint8_t latchPin, uint8_t registers);  // Data and clock must be on the same port. Returns false if they aren't.
+        uint8_t addPin(uint8_t pin);                                            // Returns the output number to use with set()
+        void    set(uint8_t output, uint8_t level);                             // Level between MIN_PWM and MAX_PWM
+        uint8_t outputs(void) { return (_registers * 8) + _pins; }
+
+        void    tick(void);                                                     // Called by the interrupt, not by you
+
+    private:
+        void    shift(uint8_t bit);
+
+        uint8_t             _registers;
+        uint8_t             _bit;                                               // Period the outputs are showing now, 0 to SHIFT_BAM_BITS-1
+        volatile uint8_t   *_shiftPort;                                         // Port register and bits of the data and clock pins
+        uint8_t             _dataMask;
+        uint8_t             _clockMask;
+        volatile uint8_t   *_latchPort;
+        uint8_t             _latchMask;
+        uint8_t             _planes[SHIFT_BAM_BITS][SHIFT_PLANE_BYTES];         // For each period, one byte per register, bit 0 = Q0
+        uint8_t             _pins;
+        volatile uint8_t   *_pinPort[SHIFT_MAX_PINS];
+        uint8_t             _pinMask[SHIFT_MAX_PINS];
+        uint8_t             _pinPlanes[SHIFT_BAM_BITS];                         // For each period, bit n = pin n
+};
+
+extern OSL_ShiftOutput ShiftOutput;
+
+#endif
@@ -9,6 +9,9 @@
  * 
  * The library has also been re-named to OSL_SimpleTimer to avoid conflicts with other libraries. 
  *
+ * Timers are also kept in a binary min-heap ordered by deadline, and callbacks can take a 
+ * parameter, see OSL_SimpleTimer.h
+ *
  * The rest of the library remains as written by Marcello Romani. 
  * For the Arduino page on his original version, see: http://playground.arduino.cc/Code/SimpleTimer
  * 
@@ -35,86 +38,162 @@ static inline unsigned long elapsed() { return millis(); }
 
 
 OSL_SimpleTimer::OSL_SimpleTimer() {
-    unsigned long current_millis = elapsed();
-
     NextID = 1; // Initialize Next ID
 
     for (int i = 0; i < MAX_TIMERS; i++) {
         enabled[i] = false;
         callbacks[i] = 0;                   // if the callback pointer is zero, the slot is free, i.e. doesn't "contain" any timer
-        prev_millis[i] = current_millis;
+        params[i] = 0;
+        hasParam[i] = false;
+        deadlines[i] = 0;
         numRuns[i] = 0;
         timerID[i] = 0;                     // Initialize IDs to Zero, which is an invalid ID
+        toBeCalled[i] = DEFCALL_DONTRUN;
+        heapPos[i] = NOT_IN_HEAP;
     }
 
     numTimers = 0;
+    heapSize = 0;
 }
 
 
 void OSL_SimpleTimer::run() {
-    int i;
+    uint8_t i;
+    uint8_t numDue = 0;
+    uint8_t due[MAX_TIMERS];
+    int dueID;
     unsigned long current_millis;
 
-    // get current time
+    // Nothing to do until the earliest deadline has passed. This is the only work done on most calls.
+    if (heapSize == 0) return;
     current_millis = elapsed();
-
-    for (i = 0; i < MAX_TIMERS; i++) {
-
+    if ((int32_t)(current_millis - deadlines[heap[0]]) < 0) return;
+
+    // Take every due timer off the heap. A timer that has fallen more than one period behind is still only
+    // processed once per call, as before: its deadline is advanced by a single period, so it will catch up
+    // over the following calls. 
+    // see http://arduino.cc/forum/index.php/topic,124048.msg932592.html#msg932592
+    while (heapSize > 0 && (int32_t)(current_millis - deadlines[heap[0]]) >= 0) {
+        i = heap[0];
+        heapRemove(i);
+        due[numDue++] = i;
+
+        deadlines[i] += delays[i];
         toBeCalled[i] = DEFCALL_DONTRUN;
 
-        // no callback == no timer, i.e. jump over empty slots
-        if (callbacks[i]) {
-
-            // is it time to process this timer ?
-            // see http://arduino.cc/forum/index.php/topic,124048.msg932592.html#msg932592
-
-            if (current_millis - prev_millis[i] >= delays[i]) {
-
-                // update time
-                //prev_millis[i] = current_millis;
-                prev_millis[i] += delays[i];
-
-                // check if the timer callback has to be executed
-                if (enabled[i]) {
-
-                    // "run forever" timers must always be executed
-                    if (maxNumRuns[i] == RUN_FOREVER) {
-                        toBeCalled[i] = DEFCALL_RUNONLY;
-                    }
-                    // other timers get executed the specified number of times
-                    else if (numRuns[i] < maxNumRuns[i]) {
-                    
-                        toBeCalled[i] = DEFCALL_RUNONLY;
-                        numRuns[i]++;
-                        
-                        // after the last run, delete the timer
-                        if (numRuns[i] >= maxNumRuns[i]) {
-                            toBeCalled[i] = DEFCALL_RUNANDDEL;
-                        }
-                    }
+        // check if the timer callback has to be executed
+        if (enabled[i]) {
+
+            // "run forever" timers must always be executed
+            if (maxNumRuns[i] == RUN_FOREVER) {
+                toBeCalled[i] = DEFCALL_RUNONLY;
+            }
+            // other timers get executed the specified number of times
+            else if (numRuns[i] < maxNumRuns[i]) {
+            
+                toBeCalled[i] = DEFCALL_RUNONLY;
+                numRuns[i]++;
+                
+                // after the last run, delete the timer
+                if (numRuns[i] >= maxNumRuns[i]) {
+                    toBeCalled[i] = DEFCALL_RUNANDDEL;
                 }
             }
         }
     }
 
-    for (i = 0; i < MAX_TIMERS; i++) {
-        switch(toBeCalled[i]) {
+    // Put back everything that will still be running, before any callbacks get a chance to add, delete or restart timers
+    for (i = 0; i < numDue; i++) {
+        if (toBeCalled[due[i]] != DEFCALL_RUNANDDEL) heapInsert(due[i]);
+    }
+
+    for (i = 0; i < numDue; i++) {
+        switch(toBeCalled[due[i]]) {
             case DEFCALL_DONTRUN:
                 break;
 
             case DEFCALL_RUNONLY:
-                (*callbacks[i])();
+                toBeCalled[due[i]] = DEFCALL_DONTRUN;
+                callback(due[i]);
                 break;
 
             case DEFCALL_RUNANDDEL:
-                (*callbacks[i])();
-                deleteTimer(timerID[i]);    // Pass the unique ID, not the Timer Number
+                dueID = timerID[due[i]];    // Save the ID first, the callback may delete this timer and start another in the same slot
+                toBeCalled[due[i]] = DEFCALL_DONTRUN;
+                callback(due[i]);
+                deleteTimer(dueID);         // Pass the unique ID, not the Timer Number
                 break;
         }
     }
 }
 
 
+void OSL_SimpleTimer::callback(uint8_t timerNum) {
+    if (hasParam[timerNum]) (*(timer_callback_p)callbacks[timerNum])(params[timerNum]);
+    else                    (*callbacks[timerNum])();
+}
+
+
+// Deadlines wrap along with millis(), so they are compared by signed difference rather than directly
+boolean OSL_SimpleTimer::before(uint8_t a, uint8_t b) {
+    return (int32_t)(deadlines[a] - deadlines[b]) < 0;
+}
+
+
+void OSL_SimpleTimer::heapSwap(uint8_t i, uint8_t j) {
+    uint8_t t = heap[i];
+    heap[i] = heap[j];
+    heap[j] = t;
+    heapPos[heap[i]] = i;
+    heapPos[heap[j]] = j;
+}
+
+
+void OSL_SimpleTimer::siftUp(uint8_t i) {
+    while (i > 0 && before(heap[i], heap[(i - 1) / 2])) {
+        heapSwap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+
+void OSL_SimpleTimer::siftDown(uint8_t i) {
+    uint8_t smallest;
+    for (;;) {
+        smallest = i;
+        if (2*i + 1 < heapSize && before(heap[2*i + 1], heap[smallest])) smallest = 2*i + 1;
+        if (2*i + 2 < heapSize && before(heap[2*i + 2], heap[smallest])) smallest = 2*i + 2;
+        if (smallest == i) return;
+        heapSwap(i, smallest);
+        i = smallest;
+    }
+}
+
+
+void OSL_SimpleTimer::heapInsert(uint8_t timerNum) {
+    if (heapPos[timerNum] != NOT_IN_HEAP) return;
+    heap[heapSize] = timerNum;
+    heapPos[timerNum] = heapSize;
+    heapSize++;
+    siftUp(heapSize - 1);
+}
+
+
+void OSL_SimpleTimer::heapRemove(uint8_t timerNum) {
+    uint8_t i = heapPos[timerNum];
+    if (i == NOT_IN_HEAP) return;
+
+    // Move the last entry into the hole, then let it find its place in whichever direction it needs to go
+    heapSize--;
+    if (i != heapSize) {
+        heapSwap(i, heapSize);
+        siftDown(i);
+        siftUp(i);
+    }
+    heapPos[timerNum] = NOT_IN_HEAP;
+}
+
+
 // find the first available slot
 // return -1 if none found
 int OSL_SimpleTimer::findFirstFreeSlot() {
@@ -138,6 +217,17 @@ int OSL_SimpleTimer::findFirstFreeSlot() {
 
 
 int OSL_SimpleTimer::setTimer(long d, timer_callback f, int n) {
+    return setupTimer(d, f, NULL, false, n);
+}
+
+
+int OSL_SimpleTimer::setTimer(long d, timer_callback_p f, void* p, int n) {
+    // The callback is stored alongside the plain ones and cast back to the right type before it is called
+    return setupTimer(d, (timer_callback)f, p, true, n);
+}
+
+
+int OSL_SimpleTimer::setupTimer(long d, timer_callback f, void* p, boolean hp, int n) {
     int returnID;
     int freeTimer;
 
@@ -152,10 +242,13 @@ int OSL_SimpleTimer::setTimer(long d, timer_callback f, int n) {
 
     delays[freeTimer] = d;
     callbacks[freeTimer] = f;
+    params[freeTimer] = p;
+    hasParam[freeTimer] = hp;
     maxNumRuns[freeTimer] = n;
     enabled[freeTimer] = true;
-    prev_millis[freeTimer] = elapsed();
+    deadlines[freeTimer] = elapsed() + d;
     timerID[freeTimer] = NextID;
+    heapInsert(freeTimer);
 
     // Increment number of timers
     numTimers++;                
@@ -183,6 +276,16 @@ int OSL_SimpleTimer::setTimeout(long d, timer_callback f) {
 }
 
 
+int OSL_SimpleTimer::setInterval(long d, timer_callback_p f, void* p) {
+    return setTimer(d, f, p, RUN_FOREVER);
+}
+
+
+int OSL_SimpleTimer::setTimeout(long d, timer_callback_p f, void* p) {
+    return setTimer(d, f, p, RUN_ONCE);
+}
+
+
 void OSL_SimpleTimer::deleteTimer(int ID) 
 {
     int timerNum;
@@ -201,7 +304,10 @@ void OSL_SimpleTimer::deleteTimer(int ID)
     // don't decrease the number of timers if the
     // specified slot is already empty
     if (callbacks[timerNum] != NULL) {
+        heapRemove(timerNum);
         callbacks[timerNum] = 0;
+        params[timerNum] = 0;
+        hasParam[timerNum] = false;
         enabled[timerNum] = false;
         toBeCalled[timerNum] = DEFCALL_DONTRUN;
         delays[timerNum] = 0;
@@ -227,7 +333,11 @@ void OSL_SimpleTimer::restartTimer(int ID)
         return;
     }
     
-    prev_millis[timerNum] = elapsed();
+    deadlines[timerNum] = elapsed() + delays[timerNum];
+
+    // A restarted timer can only move later, but it may also have been taken off the heap by run() while its callback is executing
+    if (heapPos[timerNum] == NOT_IN_HEAP) heapInsert(timerNum);
+    else siftDown(heapPos[timerNum]);
 }
 
 
@@ -287,6 +397,17 @@ void OSL_SimpleTimer::toggle(int ID)
 }
 
 
+unsigned long OSL_SimpleTimer::msUntilNextTimer() {
+    long remaining;
+
+    if (heapSize == 0) return NO_TIMER_DUE;
+
+    // The earliest deadline is always at the top of the heap
+    remaining = (int32_t)(deadlines[heap[0]] - elapsed());
+    return (remaining > 0) ? remaining : 0;
+}
+
+
 int OSL_SimpleTimer::getNumTimers() {
     return numTimers;
 }
@@ -295,6 +416,9 @@ int OSL_SimpleTimer::getNumTimers() {
 int OSL_SimpleTimer::getTimerNum(int ID)
 {
     int timerNum = -1;
+
+    // IDs start at 1, free slots have an ID of 0
+    if (ID < 1) return -1;
     
     for (int i = 0; i < MAX_TIMERS; i++) 
     {
@@ -9,6 +9,21 @@
  * 
  * The library has also been re-named to OSL_SimpleTimer to avoid conflicts with other libraries. 
  *
+ * Timers are also kept in a binary min-heap ordered by deadline, so run() only has to look at the 
+ * earliest deadline to know whether anything is due. When nothing is due run() returns after a single 
+ * comparison regardless of how many timers are in use, and adding, deleting or rescheduling a timer 
+ * costs O(log n). Deadlines are compared as signed differences, so delays must be less than 2^31 mS
+ * (about 24 days). 
+ *
+ * The timers count in milliseconds from millis() and are polled from loop(). They aren't run from 
+ * a hardware compare interrupt at a finer resolution because no compare unit is free: Timer0 
+ * provides millis(), and all six compare outputs drive light PWM. 
+ *
+ * Callbacks can optionally take a void* parameter that is passed back to them when the timer fires. 
+ * This lets one callback serve many timers (one per light, one per flag, etc.) instead of needing a 
+ * separate function and global for each. The pointer can refer to a variable, or small values can be 
+ * cast directly into it. 
+ *
  * The rest of the library remains as written by Marcello Romani. 
  * For the Arduino page on his original version, see: http://playground.arduino.cc/Code/SimpleTimer
  * 
@@ -36,9 +51,13 @@
 
 
 // Note: MAX_SIMPLETIMER_SLOTS is defined in OSL_Settings.h
+#if MAX_SIMPLETIMER_SLOTS > 254
+    #error MAX_SIMPLETIMER_SLOTS must be less than 255 (heap positions are stored in a byte)
+#endif
 
 
 typedef void (*timer_callback)(void);
+typedef void (*timer_callback_p)(void *);
 
 class OSL_SimpleTimer {
 
@@ -65,6 +84,11 @@ public:
     // call function f every d milliseconds for n times
     int setTimer(long d, timer_callback f, int n);
 
+    // same as above, but f will be called with param p
+    int setInterval(long d, timer_callback_p f, void* p);
+    int setTimeout(long d, timer_callback_p f, void* p);
+    int setTimer(long d, timer_callback_p f, void* p, int n);
+
     // destroy the specified timer
     void deleteTimer(int ID);
 
@@ -93,6 +117,11 @@ public:
     // Gets the timer number (0-MAX_TIMERS) by ID
     int getTimerNum(int ID);
 
+    // returns the number of milliseconds until the next timer is due, 0 if one is due now, 
+    // or NO_TIMER_DUE if no timers are running
+    const static unsigned long NO_TIMER_DUE = 0xFFFFFFFF;
+    unsigned long msUntilNextTimer();
+
 private:
     // deferred call constants
     const static int DEFCALL_DONTRUN = 0;       // don't call the callback function
@@ -102,13 +131,38 @@ private:
     // find the first available slot
     int findFirstFreeSlot();
 
-    // value returned by the millis() function
-    // in the previous run() call
-    unsigned long prev_millis[MAX_TIMERS];
+    // min-heap maintenance
+    const static uint8_t NOT_IN_HEAP = 0xFF;
+    boolean before(uint8_t a, uint8_t b);       // true if slot a is due before slot b
+    void heapSwap(uint8_t i, uint8_t j);
+    void siftUp(uint8_t i);
+    void siftDown(uint8_t i);
+    void heapInsert(uint8_t timerNum);
+    void heapRemove(uint8_t timerNum);
+
+    // time at which each timer is next due
+    unsigned long deadlines[MAX_TIMERS];
+
+    // slot numbers ordered as a binary min-heap on deadline, heap[0] is due first
+    uint8_t heap[MAX_TIMERS];
+    uint8_t heapSize;
+
+    // position of each slot in heap[], or NOT_IN_HEAP
+    uint8_t heapPos[MAX_TIMERS];
 
     // pointers to the callback functions
     timer_callback callbacks[MAX_TIMERS];
 
+    // parameters passed to the callback functions, and whether the callback takes one
+    void* params[MAX_TIMERS];
+    boolean hasParam[MAX_TIMERS];
+
+    // set up a timer in a free slot, shared by both types of callback
+    int setupTimer(long d, timer_callback f, void* p, boolean hp, int n);
+
+    // call the callback for a slot with or without its parameter
+    void callback(uint8_t timerNum);
+
     // delay values
     unsigned long delays[MAX_TIMERS];
 
@@ -122,7 +176,7 @@ private:
     boolean enabled[MAX_TIMERS];
 
     // deferred function call (sort of) - N.B.: this array is only used in run()
-    int toBeCalled[MAX_TIMERS];
+    uint8_t toBeCalled[MAX_TIMERS];
 
     // IDs for each timer (not equal to the timer number)
     int timerID[MAX_TIMERS];
@@ -0,0 +1,68 @@
+/* OSL_SyncLink.cpp     Sync Link - the frames a master OSL sends its followers over the serial port
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_SyncLink.h"
+#include <util/crc16.h>
+
+
+boolean OSL_SyncLink::send(Print &port, uint16_t state, uint8_t phase)
+{
+    uint8_t frame[SYNC_FRAME_BYTES];
+
+    if (port.availableForWrite() < SYNC_FRAME_BYTES) return false;
+
+    frame[0] = SYNC_FRAME_START;
+    frame[1] = lowByte(state);
+    frame[2] = highByte(state);
+    frame[3] = phase;
+    frame[4] = crc(&frame[1]);
+    port.write(frame, SYNC_FRAME_BYTES);
+    return true;
+}
+
+boolean OSL_SyncLink::receive(uint8_t c)
+{
+    uint8_t i;
+
+    if (_count == 0 && c != SYNC_FRAME_START) return false;                    // Waiting for the start of a frame
+    _frame[_count++] = c;
+    if (_count < SYNC_FRAME_BYTES) return false;
+
+    if (crc(&_frame[1]) == _frame[4])
+    {
+        _state = _frame[1] | ((uint16_t)_frame[2] << 8);
+        _phase = _frame[3];
+        _count = 0;
+        return true;
+    }
+
+    // Bad frame. If we started on a byte that only looked like the start, the real frame may begin later on, so keep from the next start byte
+    for (i=1; i<SYNC_FRAME_BYTES && _frame[i] != SYNC_FRAME_START; i++) { }
+    _count = SYNC_FRAME_BYTES - i;
+    memmove(_frame, &_frame[i], _count);
+    return false;
+}
+
+uint8_t OSL_SyncLink::crc(const uint8_t *data)
+{   // CRC-8 (CCITT) of the state and phase bytes
+    uint8_t c = 0;
+    for (uint8_t i=0; i<SYNC_FRAME_BYTES-2; i++) c = _crc8_ccitt_update(c, data[i]);
+    return c;
+}
@@ -0,0 +1,56 @@
+/* OSL_SyncLink.h       Sync Link - the frames a master OSL sends its followers over the serial port
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Each frame is 5 bytes: SYNC_FRAME_START, the 16 bit vehicle state (low byte first), the phase counter, and a CRC-8 of the state and phase.
+ * At 38400 baud that is 1.3 mS, so the 100 Hz the master sends at uses an eighth of the line. What the bits of the state mean is up to the
+ * sketch (see MULTI-BOARD SYNC in OSL_Settings.h).
+ *
+ * receive() takes one byte at a time and returns true when it has just completed a frame with a good CRC. It looks for the start byte again
+ * after anything that doesn't check out, so a follower can be plugged in part-way through, and stray debug text is skipped. send() only
+ * writes a frame if the transmit buffer has room for all of it, otherwise it skips that one.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OSL_SyncLink_h
+#define OSL_SyncLink_h
+
+#include <Arduino.h>
+
+
+#define SYNC_FRAME_START            0xA5
+#define SYNC_FRAME_BYTES            5
+
+
+class OSL_SyncLink
+{   public:
+        OSL_SyncLink() : _count(0), _state(0), _phase(0) {}
+
+        boolean  send(Print &port, uint16_t state, uint8_t phase);     // Returns false if there wasn't room and the frame was skipped
+        boolean  receive(uint8_t c);                                   // Returns true when c completes a good frame
+        uint16_t state(void) { return _state; }                         // From the last good frame
+        uint8_t  phase(void) { return _phase; }
+
+    private:
+        uint8_t  crc(const uint8_t *data);
+        uint8_t  _frame[SYNC_FRAME_BYTES];
+        uint8_t  _count;                                                // Bytes of the frame received so far
+        uint16_t _state;
+        uint8_t  _phase;
+};
+
+
+#endif
@@ -0,0 +1,59 @@
+/* OSL_Telemetry.cpp    Telemetry - a stream of binary snapshots of the OSL's inputs and outputs
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_Telemetry.h"
+#include <util/crc16.h>
+
+
+boolean OSL_Telemetry::send(Print &port)
+{
+    const uint8_t *p = (const uint8_t *)&frame;
+    uint16_t crc = 0;
+    uint8_t i;
+
+    if (port.availableForWrite() < (int)TELEMETRY_WIRE_BYTES) return false;
+
+    frame.version = TELEMETRY_VERSION;
+    for (i=0; i<sizeof(TelemetryFrame) - sizeof(frame.crc); i++) crc = _crc_xmodem_update(crc, p[i]);
+    frame.crc = crc;                                        // Little-endian, like the rest of the frame
+
+    writeCOBS(port, p, sizeof(TelemetryFrame));
+    return true;
+}
+
+void OSL_Telemetry::writeCOBS(Print &port, const uint8_t *data, uint8_t len)
+{
+    // Each block is a code byte, then code-1 bytes that aren't 0. A code under 255 means a 0 followed those bytes in the original data 
+    // (except at the very end). The frame is ended with a 0, which can't appear anywhere else. 
+    uint8_t i = 0;
+    uint8_t run;
+
+    while (true)
+    {
+        run = 0;
+        while (i + run < len && data[i + run] != 0 && run < 254) run++;
+        port.write(run + 1);
+        port.write(&data[i], run);
+        i += run;
+        if (i >= len) break;
+        if (run < 254) i++;                                 // Skip over the 0 the code byte stands for
+    }
+    port.write((uint8_t)0);
+}
@@ -0,0 +1,76 @@
+/* OSL_Telemetry.h      Telemetry - a stream of binary snapshots of the OSL's inputs and outputs
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * The sketch fills in the public frame (radio pulses and commands, drive mode, and the setting and brightness of each light) and calls 
+ * send(). The frame gets a CRC and is then COBS encoded (Consistent Overhead Byte Stuffing) as it is written to the port, straight from 
+ * the frame with no second buffer. COBS removes every 0 byte from the data, so a 0 can mark the end of each frame and the receiver can 
+ * always find the start of the next one, even if it joins part-way through or there is debug text mixed in. tools/osl_telemetry.py 
+ * decodes and plots the stream. 
+ *
+ * send() only writes a frame if the transmit buffer has room for all of it, otherwise it skips that one, so it never waits on the port.
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+#ifndef OSL_Telemetry_h
+#define OSL_Telemetry_h
+
+#include <Arduino.h>
+#include "../../AA_UserConfig.h"
+#include "../OSL_Settings/OSL_Settings.h"
+
+
+#define TELEMETRY_VERSION           1           // Change this if the frame layout changes, and change tools/osl_telemetry.py to match
+
+// Bits in TelemetryFrame.flags
+#define TELEM_BRAKING               0x01
+#define TELEM_ACCELERATING          0x02
+#define TELEM_DECELERATING          0x04
+#define TELEM_STOPPED_LONG          0x08
+#define TELEM_FAILSAFE              0x10
+
+typedef struct __attribute__((packed))
+{
+    uint8_t         version;                    // TELEMETRY_VERSION
+    uint32_t        time;                       // millis()
+    uint16_t        pulse[NUM_RC_CHANNELS];     // Pulse widths in uS, after smoothing. Throttle, steering, channel 3
+    int8_t          throttle;                   // Commands, as mapped by ProcessRCCommand
+    int8_t          turn;
+    uint8_t         channel3;
+    uint8_t         rcState;                    // RC_SIGNAL_SYNCHED, etc.
+    uint8_t         driveMode;                  // STOP, FWD, REV
+    uint8_t         flags;                      // TELEM_BRAKING, etc.
+    uint8_t         setting[NumLights];         // Current setting of each light (ON, OFF, etc.)
+    uint8_t         level[NumLights];           // Brightness of each light, MIN_PWM to MAX_PWM
+    uint16_t        crc;                        // CRC-16 (XMODEM) of everything above, filled in by send()
+} TelemetryFrame;
+
+// Worst case bytes on the wire for one frame: COBS adds one byte per 254 (so one, for our size), plus the 0 that ends the frame
+#define TELEMETRY_WIRE_BYTES        (sizeof(TelemetryFrame) + 2)
+
+class OSL_Telemetry
+{   public:
+        OSL_Telemetry() {}
+
+        boolean send(Print &port);                              // Returns false if there wasn't room and the frame was skipped
+        TelemetryFrame  frame;
+
+    private:
+        void writeCOBS(Print &port, const uint8_t *data, uint8_t len);
+};
+
+
+#endif 
@@ -0,0 +1,70 @@
+/* OSL_Trace.cpp        Trace - a small binary log of events kept in RAM
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+
+#include "OSL_Trace.h"
+
+#if TRACE
+
+#include <util/crc16.h>
+
+OSL_Trace Trace;
+
+
+void OSL_Trace::clear(void)
+{
+    _head = 0;
+    _count = 0;
+    _paused = false;
+}
+
+// Dump format, all multi-byte values little-endian:
+//     TRACE_DUMP_MAGIC (4 bytes), TRACE_FORMAT_VERSION, record size, record count, millis() at the time of the dump (4 bytes), 
+//     the records oldest first (time 4 bytes, event, arg, value 2 bytes), then a CRC-16 (XMODEM) of everything after the magic.
+// The dump can turn up in the middle of ordinary debug text, the magic is how the decoder finds it. 
+void OSL_Trace::dump(Print &port)
+{
+    uint8_t         header[7];
+    uint32_t        now = millis();
+    uint16_t        crc = 0;
+    uint8_t         i;
+    uint8_t         b;
+    const uint8_t   *p;
+
+    _paused = true;                                         // Don't let events logged while we're sending (by the serial task itself) scramble the buffer
+
+    port.print(F(TRACE_DUMP_MAGIC));
+    header[0] = TRACE_FORMAT_VERSION;
+    header[1] = sizeof(TraceRecord);
+    header[2] = _count;
+    header[3] = now; header[4] = now >> 8; header[5] = now >> 16; header[6] = now >> 24;
+    for (b=0; b<sizeof(header); b++) { port.write(header[b]); crc = _crc_xmodem_update(crc, header[b]); }
+
+    for (i=0; i<_count; i++)
+    {
+        p = (const uint8_t *)&_record[(_head - _count + i) & (TRACE_RECORDS - 1)];
+        for (b=0; b<sizeof(TraceRecord); b++) { port.write(p[b]); crc = _crc_xmodem_update(crc, p[b]); }   // AVR is little-endian already
+    }
+    port.write((uint8_t)(crc & 0xFF));
+    port.write((uint8_t)(crc >> 8));
+
+    _paused = false;
+}
+
+#endif // TRACE
@@ -0,0 +1,87 @@
+/* OSL_Trace.h          Trace - a small binary log of events kept in RAM
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Printing debug messages over the serial port takes several milliseconds each at 38400 baud, which changes the very timing we may be 
+ * trying to look at. Instead, TRACE_EVENT() stores a fixed-size record (time, event type, and two bytes of detail) in a ring buffer in RAM, 
+ * which costs little more than reading millis(). The newest TRACE_RECORDS events are kept, older ones are overwritten. Send "t" from 
+ * the serial monitor to dump the buffer, and use tools/osl_trace_decode.py to turn the dump into a readable timeline. 
+ * 
+ * The whole thing is only compiled if TRACE is set to true in AA_UserConfig.h. Otherwise the TRACE_EVENT macro expands to nothing and no RAM 
+ * or flash is used. Event types are defined in OSL_Settings.h under the TRACE heading. 
+ *   
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */  
+
+#ifndef OSL_Trace_h
+#define OSL_Trace_h
+
+#include <Arduino.h>
+#include "../../AA_UserConfig.h"
+#include "../OSL_Settings/OSL_Settings.h"
+
+
+#if TRACE
+
+#if (TRACE_RECORDS & (TRACE_RECORDS - 1)) || TRACE_RECORDS > 128
+#error "TRACE_RECORDS must be a power of two, no more than 128"
+#endif
+
+typedef struct
+{
+    uint32_t        time;                                   // millis() when the event was logged
+    uint8_t         event;                                  // Event type, see OSL_Settings.h
+    uint8_t         arg;                                    // Which channel, light, etc. 
+    uint16_t        value;                                  // Pulse width, new state, etc. 
+} TraceRecord;
+
+class OSL_Trace
+{   public:
+        OSL_Trace() { clear(); }
+
+        // Only call this from the main loop, not from an interrupt - the buffer isn't protected against being written from both at once
+        inline void log(uint8_t event, uint8_t arg, uint16_t value)
+        {
+            if (_paused) return;
+            TraceRecord *r = &_record[_head];
+            r->time = millis();
+            r->event = event;
+            r->arg = arg;
+            r->value = value;
+            _head = (_head + 1) & (TRACE_RECORDS - 1);
+            if (_count < TRACE_RECORDS) _count++;
+        }
+
+        void clear(void);
+        void dump(Print &port);                                 // Write the buffer out, oldest event first. The format is described in OSL_Trace.cpp
+
+    private:
+        TraceRecord     _record[TRACE_RECORDS];
+        uint8_t         _head;                                  // Where the next record goes
+        uint8_t         _count;                                 // How many records are in use
+        boolean         _paused;                                // Set while dumping
+};
+
+extern OSL_Trace Trace;
+
+#define TRACE_EVENT(event, arg, value)    Trace.log(event, arg, value)
+
+#else
+
+#define TRACE_EVENT(event, arg, value)
+
+#endif // TRACE
+
+#endif
@@ -0,0 +1,190 @@
+/* Arduino.h            Host build - the parts of the Arduino core the sketch uses, running on a PC
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Just enough of the Arduino AVR core for the OSL sketch and its libraries to compile and run on Linux. Time, pins, the serial port, the EEPROM
+ * and the interrupts are all simulated by the Host object (see OSL_Host.h), and time only moves when the test moves it.
+ *
+ * Two differences from the real thing are worth knowing: int is 32 bits here instead of 16, and unsigned long is 64 bits. millis() and micros()
+ * return 32 bits, so they still wrap at the same point they do on the board.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef Arduino_h
+#define Arduino_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>                                                 // EEPROM.ino's macros call these without including it
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define HIGH            0x1
+#define LOW             0x0
+
+#define INPUT           0x0
+#define OUTPUT          0x1
+#define INPUT_PULLUP    0x2
+
+#define CHANGE          1
+#define FALLING         2
+#define RISING          3
+
+#define PI              3.1415926535897932384626433832795
+#define DEC             10
+#define HEX             16
+#define OCT             8
+#define BIN             2
+
+#define A0              14
+#define A1              15
+#define A2              16
+#define A3              17
+#define A4              18
+#define A5              19
+#define A6              20
+#define A7              21
+#define NUM_DIGITAL_PINS        20
+
+#define NOT_A_PIN       0
+#define NOT_A_PORT      0
+#define PB              2
+#define PC              3
+#define PD              4
+
+#define clockCyclesPerMicrosecond()     ( F_CPU / 1000000L )
+
+#define constrain(amt,low,high)         ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define sq(x)                           ((x)*(x))
+#define lowByte(w)                      ((uint8_t) ((w) & 0xff))
+#define highByte(w)                     ((uint8_t) ((w) >> 8))
+#define bitRead(value, bit)             (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)              ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)            ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue)  ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define bit(b)                          (1UL << (b))
+
+#define interrupts()                    sei()
+#define noInterrupts()                  cli()
+
+// Functions rather than the core's macros, so the standard headers a test includes after this one still compile
+template <class A, class B> inline auto min(const A &a, const B &b) -> decltype(a < b ? a : b) { return a < b ? a : b; }
+template <class A, class B> inline auto max(const A &a, const B &b) -> decltype(a < b ? a : b) { return a > b ? a : b; }
+
+void     init(void);
+void     yield(void);
+
+uint32_t millis(void);
+uint32_t micros(void);
+void     delay(unsigned long ms);
+void     delayMicroseconds(unsigned int us);
+
+void     pinMode(uint8_t pin, uint8_t mode);
+void     digitalWrite(uint8_t pin, uint8_t val);
+int      digitalRead(uint8_t pin);
+int      analogRead(uint8_t pin);
+void     analogWrite(uint8_t pin, int val);
+
+volatile uint8_t *portOutputRegister(uint8_t port);
+volatile uint8_t *portInputRegister(uint8_t port);
+volatile uint8_t *portModeRegister(uint8_t port);
+uint8_t  digitalPinToPort(uint8_t pin);
+uint8_t  digitalPinToBitMask(uint8_t pin);
+
+long     random(long howbig);
+long     random(long howsmall, long howbig);
+void     randomSeed(unsigned long seed);
+long     map(long x, long in_min, long in_max, long out_min, long out_max);
+
+
+// Strings kept in flash on the board. Here they are ordinary strings, but the type still picks the right print().
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+class Print
+{   public:
+        virtual ~Print() {}
+        virtual size_t write(uint8_t) = 0;
+        virtual size_t write(const uint8_t *buffer, size_t size);
+        size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+        size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+        virtual int availableForWrite() { return 0; }
+        virtual void flush() { }
+
+        size_t print(const __FlashStringHelper *);
+        size_t print(const char[]);
+        size_t print(char);
+        size_t print(unsigned char, int = DEC);
+        size_t print(int, int = DEC);
+        size_t print(unsigned int, int = DEC);
+        size_t print(long, int = DEC);
+        size_t print(unsigned long, int = DEC);
+        size_t print(double, int = 2);
+
+        size_t println(const __FlashStringHelper *);
+        size_t println(const char[]);
+        size_t println(char);
+        size_t println(unsigned char, int = DEC);
+        size_t println(int, int = DEC);
+        size_t println(unsigned int, int = DEC);
+        size_t println(long, int = DEC);
+        size_t println(unsigned long, int = DEC);
+        size_t println(double, int = 2);
+        size_t println(void);
+
+    private:
+        size_t printNumber(unsigned long, uint8_t);
+        size_t printFloat(double, uint8_t);
+};
+
+class Stream : public Print
+{   public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+};
+
+#define SERIAL_TX_BUFFER_SIZE   64
+#define SERIAL_RX_BUFFER_SIZE   64
+#define SERIAL_8N1              0x06
+
+class HardwareSerial : public Stream
+{   public:
+        void    begin(unsigned long baud, uint8_t config = SERIAL_8N1);
+        void    end(void);
+        int     available(void);
+        int     peek(void);
+        int     read(void);
+        int     availableForWrite(void);
+        void    flush(void);
+        size_t  write(uint8_t);
+        using   Print::write;
+        operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#include "OSL_Host.h"
+
+#endif
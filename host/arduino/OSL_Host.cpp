@@ -0,0 +1,826 @@
+/* OSL_Host.cpp         Host build - a simulated ATmega328 for running the sketch on a PC
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+#include <avr/eeprom.h>
+#include <avr/sleep.h>
+#include "PinChangeInterrupt.h"
+
+OSL_Host        Host;
+HardwareSerial  Serial;
+
+HostSREG            SREG;
+HostEECR            EECR;
+HostFlagRegister    TIFR0, TIFR1, TIFR2, PCIFR;
+
+volatile uint8_t    PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+volatile uint8_t    PCICR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t    TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0;
+volatile uint8_t    TCCR1A, TCCR1B, TCCR1C, TIMSK1;
+volatile uint16_t   TCNT1, OCR1A, OCR1B, ICR1;
+volatile uint8_t    TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2;
+volatile uint8_t    EEDR;
+volatile uint16_t   EEAR;
+volatile uint8_t    SMCR, MCUCR, MCUSR, WDTCSR;
+
+volatile unsigned long timer0_overflow_count;                          // As in the core's wiring.c, for OSL_PinChangeDispatch
+
+#define NEVER               UINT64_MAX
+#define NS_PER_CYCLE        (1000000000ULL / F_CPU)
+#define TIMER0_OVERFLOW_NS  (64 * 256 * NS_PER_CYCLE)                   // Prescaler 64, as the core sets it up: 1024 uS
+#define TX_BUFFER           (SERIAL_TX_BUFFER_SIZE - 1)
+#define RX_BUFFER           (SERIAL_RX_BUFFER_SIZE - 1)
+
+static unsigned long randomContext = 1;
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// PINS
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// Nano pins 0-7 are port D, 8-13 port B and A0-A5 (14-19) port C. The pin change ports are numbered B = 0, C = 1, D = 2.
+
+static volatile uint8_t *pinReg(uint8_t pin)     { return pin < 8 ? &PIND : (pin < 14 ? &PINB : &PINC); }
+static volatile uint8_t *portReg(uint8_t pin)    { return pin < 8 ? &PORTD : (pin < 14 ? &PORTB : &PORTC); }
+static volatile uint8_t *ddrReg(uint8_t pin)     { return pin < 8 ? &DDRD : (pin < 14 ? &DDRB : &DDRC); }
+static volatile uint8_t *pcmskReg(uint8_t pin)   { return pin < 8 ? &PCMSK2 : (pin < 14 ? &PCMSK0 : &PCMSK1); }
+static uint8_t pinBit(uint8_t pin)               { return 1 << (pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14)); }
+static uint8_t pinChangePort(uint8_t pin)        { return pin < 8 ? 2 : (pin < 14 ? 0 : 1); }
+
+void OSL_Host::updateInput(uint8_t pin)
+{   // Works out the level on a pin, and flags a pin change interrupt if it changed and the pin is in the mask
+    uint8_t bit = pinBit(pin);
+    uint8_t level;
+
+    if (*ddrReg(pin) & bit)     level = *portReg(pin) & bit;            // Output
+    else if (_drive[pin] >= 0)  level = _drive[pin] ? bit : 0;          // Driven from outside
+    else                        level = *portReg(pin) & bit;            // Pullup, or low if there isn't one
+
+    if ((*pinReg(pin) & bit) == level) return;
+    *pinReg(pin) ^= bit;
+    if (*pcmskReg(pin) & bit) PCIFR.raw |= _BV(pinChangePort(pin));
+}
+
+void OSL_Host::drivePin(uint8_t pin, uint8_t level)
+{
+    if (pin >= HOST_PINS) return;
+    _drive[pin] = level ? 1 : 0;
+    updateInput(pin);
+    service();
+}
+
+void OSL_Host::releasePin(uint8_t pin)
+{
+    if (pin >= HOST_PINS) return;
+    _drive[pin] = -1;
+    updateInput(pin);
+    service();
+}
+
+void OSL_Host::edgeAt(uint8_t pin, uint8_t level, uint64_t ns)
+{
+    Edge e = { pin, EDGE_LEVEL, level, 0, 0 };
+    if (pin >= HOST_PINS) return;
+    _edges.insert(std::make_pair(ns < _now ? _now : ns, e));
+}
+
+void OSL_Host::rcPulse(uint8_t pin, uint16_t uS, uint32_t periodUs)
+{
+    rcPulseAt(pin, uS, _now, periodUs);
+}
+
+void OSL_Host::rcPulseAt(uint8_t pin, uint16_t uS, uint64_t ns, uint32_t periodUs)
+{
+    Edge e = { pin, EDGE_RC_SET, 0, uS, periodUs };
+    if (pin >= HOST_PINS) return;
+    _edges.insert(std::make_pair(ns < _now ? _now : ns, e));
+}
+
+uint8_t OSL_Host::pinOutput(uint8_t pin)
+{
+    return pin < HOST_PINS ? _output[pin] : 0;
+}
+
+void OSL_Host::pinModeChanged(uint8_t pin)
+{
+    updateInput(pin);
+    service();
+}
+
+void OSL_Host::pinWritten(uint8_t pin, uint8_t value)
+{
+    _output[pin] = value;
+    if (onPinWrite) onPinWrite(pin, value);
+    updateInput(pin);
+    service();
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// TIME AND INTERRUPTS
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+
+void OSL_Host::reset(bool eraseEEPROM)
+{
+    _now = 0;
+    _inInterrupt = false;
+    _interrupts = 0;
+    _interruptsAtSei = 0;
+    clockReadNs = 1000;
+    stopAt = 0;
+    onPinWrite = NULL;
+    for (uint8_t i=0; i<HOST_PINS + 2; i++) analogValue[i] = 512;
+
+    serialOutput.clear();
+    echoSerial = false;
+    serialDropped = 0;
+    _byteNs = 0;
+    _txBusy = false;
+    _txDone = NEVER;
+    _tx.clear();
+    _rx.clear();
+    _rxComing.clear();
+    _rxNext = NEVER;
+
+    if (eraseEEPROM) memset(eeprom, 0xFF, sizeof(eeprom));
+    eepromWritesLeft = -1;
+    eepromWrites = 0;
+    _eepromDone = NEVER;
+
+    sleepNs = 0;
+    wakeups = 0;
+    memset(interruptCount, 0, sizeof(interruptCount));
+
+    _edges.clear();
+    memset(_rc, 0, sizeof(_rc));
+    memset(_drive, -1, sizeof(_drive));
+    memset(_output, 0, sizeof(_output));
+
+    // Every register to 0, then the timers as the core's init() sets them up for millis() and analogWrite()
+    SREG.raw = EECR.raw = TIFR0.raw = TIFR1.raw = TIFR2.raw = PCIFR.raw = 0;
+    PINB = PINC = PIND = PORTB = PORTC = PORTD = DDRB = DDRC = DDRD = 0;
+    PCICR = PCMSK0 = PCMSK1 = PCMSK2 = 0;
+    TCCR0A = TCCR0B = TCNT0 = OCR0A = OCR0B = TIMSK0 = 0;
+    TCCR1A = TCCR1B = TCCR1C = TIMSK1 = 0;
+    TCNT1 = OCR1A = OCR1B = ICR1 = 0;
+    TCCR2A = TCCR2B = TCNT2 = OCR2A = OCR2B = TIMSK2 = 0;
+    EEDR = 0;
+    EEAR = 0;
+    SMCR = MCUCR = MCUSR = WDTCSR = 0;
+    timer0_overflow_count = 0;
+
+    TCCR0A = _BV(WGM01) | _BV(WGM00);                                   // Fast PWM, prescaler 64
+    TCCR0B = _BV(CS01) | _BV(CS00);
+    TIMSK0 = _BV(TOIE0);
+    TCCR1A = _BV(WGM10);                                                // Phase correct 8 bit PWM, prescaler 64
+    TCCR1B = _BV(CS11) | _BV(CS10);
+    TCCR2A = _BV(WGM20);                                                // Phase correct PWM, prescaler 64: overflows every 2.04 mS
+    TCCR2B = _BV(CS22);
+    _timer0Next = TIMER0_OVERFLOW_NS;
+    _timer1Next = NEVER;
+    _timer2Next = timer2Period();
+    randomContext = 1;
+    SREG.raw = _BV(SREG_I);
+}
+
+void OSL_Host::syncTimer0(void)
+{
+    TCNT0 = (uint8_t)(_now / (64 * NS_PER_CYCLE));
+    timer0_overflow_count = (unsigned long)(_now / TIMER0_OVERFLOW_NS);
+}
+
+uint64_t OSL_Host::timer2Period(void)
+{
+    static const uint16_t prescale[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+    uint16_t p = prescale[TCCR2B & 7];
+    uint16_t counts = (TCCR2A & (_BV(WGM20) | _BV(WGM21))) == _BV(WGM20) ? 510 : 256;     // Phase correct counts up then down
+    return p ? (uint64_t)p * counts * NS_PER_CYCLE : NEVER;
+}
+
+uint64_t OSL_Host::timer1Period(void)
+{   // Only the modes with OCR1A or ICR1 as the top are worked out, the rest run at the 8 bit phase correct rate the core leaves it in
+    static const uint16_t prescale[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+    uint16_t p = prescale[TCCR1B & 7];
+    uint8_t  mode = (TCCR1A & 3) | ((TCCR1B >> 1) & 0x0C);
+    uint32_t counts;
+
+    if (!p) return NEVER;
+    if (mode == 15 || mode == 4)        counts = (uint32_t)OCR1A + 1;
+    else if (mode == 14 || mode == 12)  counts = (uint32_t)ICR1 + 1;
+    else                                counts = 510;
+    return (uint64_t)p * counts * NS_PER_CYCLE;
+}
+
+uint64_t OSL_Host::nextEvent(void)
+{
+    uint64_t t = _timer0Next;
+
+    // Timer1 is only followed while its compare interrupt is on
+    if (!(TIMSK1 & _BV(OCIE1A)))    _timer1Next = NEVER;
+    else if (_timer1Next == NEVER)  _timer1Next = timer1Period() == NEVER ? NEVER : _now + timer1Period();
+
+    if (_timer1Next < t) t = _timer1Next;
+    if (_timer2Next < t) t = _timer2Next;
+    if ((EECR.raw & _BV(EEPE)) && _eepromDone < t) t = _eepromDone;
+    if (_txBusy && _txDone < t) t = _txDone;
+    if (!_rxComing.empty() && _rxNext < t) t = _rxNext;
+    if (!_edges.empty() && _edges.begin()->first < t) t = _edges.begin()->first;
+    return t;
+}
+
+void OSL_Host::runEvent(uint64_t t)
+{   // Everything that's due at time t
+    if (_timer0Next <= t)
+    {   // The core's millis() interrupt. Its count is worked out from the time, so all it does here is wake the processor.
+        _timer0Next += TIMER0_OVERFLOW_NS;
+        interruptCount[VECT_TIMER0_OVF]++;
+        _interrupts++;
+    }
+    if (_timer1Next <= t)
+    {   // In the modes with a buffered top, the value written during this period is the one used for the next
+        TIFR1.raw |= _BV(OCF1A);
+        _timer1Next = timer1Period() == NEVER ? NEVER : t + timer1Period();
+    }
+    if (_timer2Next <= t)
+    {
+        TIFR2.raw |= _BV(TOV2);
+        _timer2Next = timer2Period() == NEVER ? NEVER : t + timer2Period();
+    }
+    if ((EECR.raw & _BV(EEPE)) && _eepromDone <= t)
+    {
+        eeprom[_eepromAddress] = _eepromValue;
+        EECR.raw &= ~_BV(EEPE);
+        _eepromDone = NEVER;
+    }
+    if (_txBusy && _txDone <= t)
+    {   // The byte that was going out is done. The data register empty interrupt moves the next one in from the buffer.
+        if (_tx.empty()) _txBusy = false;
+        else
+        {
+            uint8_t b = _tx.front();
+            _tx.pop_front();
+            serialOutput += (char)b;
+            if (echoSerial) { putchar(b); fflush(stdout); }
+            _txDone = t + _byteNs;
+            interruptCount[VECT_USART]++;
+            _interrupts++;
+        }
+    }
+    if (!_rxComing.empty() && _rxNext <= t)
+    {
+        if (_rx.size() < RX_BUFFER) _rx.push_back(_rxComing.front());
+        else                        serialDropped++;
+        _rxComing.pop_front();
+        _rxNext = _rxComing.empty() ? NEVER : t + _byteNs;
+        interruptCount[VECT_USART]++;
+        _interrupts++;
+    }
+    while (!_edges.empty() && _edges.begin()->first <= t)
+    {
+        Edge e = _edges.begin()->second;
+        _edges.erase(_edges.begin());
+        if (e.kind == EDGE_RC_SET)
+        {   // A new pulse width, used from the next frame on. If there's no signal at the moment, the first frame starts now.
+            _rc[e.pin].width = e.width;
+            _rc[e.pin].period = e.period;
+            if (e.width > 0 && !_rc[e.pin].running)
+            {
+                Edge frame = { e.pin, EDGE_RC_FRAME, 0, 0, 0 };
+                _rc[e.pin].running = true;
+                _edges.insert(std::make_pair(t, frame));
+            }
+            continue;
+        }
+        if (e.kind == EDGE_SERIAL)
+        {
+            serialInput(&e.level, 1);
+            continue;
+        }
+        if (e.kind == EDGE_RC_FRAME)
+        {   // Start of an RC frame: the pulse, its end, and the start of the next frame
+            if (_rc[e.pin].width == 0) { _rc[e.pin].running = false; continue; }
+            Edge fall = { e.pin, EDGE_LEVEL, 0, 0, 0 };
+            Edge next = { e.pin, EDGE_RC_FRAME, 0, 0, 0 };
+            _edges.insert(std::make_pair(t + (uint64_t)_rc[e.pin].width * 1000, fall));
+            _edges.insert(std::make_pair(t + (uint64_t)_rc[e.pin].period * 1000, next));
+            e.level = 1;
+        }
+        _drive[e.pin] = e.level;
+        updateInput(e.pin);
+    }
+}
+
+void OSL_Host::advanceNs(uint64_t ns)
+{
+    uint64_t target = _now + ns;
+    uint64_t t;
+
+    while ((t = nextEvent()) <= target)
+    {
+        if (t > _now) _now = t;
+        syncTimer0();                                                   // Before the interrupts, they may read TCNT0
+        runEvent(_now);
+        service();
+    }
+    if (_now < target) _now = target;                                   // An interrupt that read the clock may have moved it on already
+    syncTimer0();
+    if (stopAt && _now >= stopAt && !_inInterrupt)
+    {
+        stopAt = 0;
+        throw Stop();
+    }
+}
+
+void OSL_Host::runVector(HostVector v)
+{
+    _inInterrupt = true;
+    SREG.raw &= ~_BV(SREG_I);
+    interruptCount[v]++;
+    _interrupts++;
+    switch (v)
+    {
+        case VECT_PCINT0:       PCINT0_vect();          break;
+        case VECT_PCINT1:       PCINT1_vect();          break;
+        case VECT_PCINT2:       PCINT2_vect();          break;
+        case VECT_TIMER2_OVF:   TIMER2_OVF_vect();      break;
+        case VECT_TIMER1_COMPA: TIMER1_COMPA_vect();    break;
+        case VECT_EE_READY:     EE_READY_vect();        break;
+        default:                                        break;
+    }
+    SREG.raw |= _BV(SREG_I);
+    _inInterrupt = false;
+}
+
+void OSL_Host::service(void)
+{   // Highest priority (lowest vector number) first, one at a time, as the processor does
+    while (!_inInterrupt && (SREG.raw & _BV(SREG_I)))
+    {
+        if      (PCIFR.raw & PCICR & _BV(PCIF0))                { PCIFR.raw &= ~_BV(PCIF0); runVector(VECT_PCINT0); }
+        else if (PCIFR.raw & PCICR & _BV(PCIF1))                { PCIFR.raw &= ~_BV(PCIF1); runVector(VECT_PCINT1); }
+        else if (PCIFR.raw & PCICR & _BV(PCIF2))                { PCIFR.raw &= ~_BV(PCIF2); runVector(VECT_PCINT2); }
+        else if (TIFR2.raw & TIMSK2 & _BV(TOV2))                { TIFR2.raw &= ~_BV(TOV2);  runVector(VECT_TIMER2_OVF); }
+        else if (TIFR1.raw & TIMSK1 & _BV(OCF1A))               { TIFR1.raw &= ~_BV(OCF1A); runVector(VECT_TIMER1_COMPA); }
+        else if ((EECR.raw & _BV(EERIE)) && !(EECR.raw & _BV(EEPE)))    runVector(VECT_EE_READY);      // Level triggered, for as long as it's on
+        else break;
+    }
+}
+
+void OSL_Host::interruptsOn(void)
+{
+    _interruptsAtSei = _interrupts;
+    SREG.raw |= _BV(SREG_I);
+    service();
+}
+
+void OSL_Host::sleep(void)
+{   // An interrupt that was already waiting when sei() ran wakes the processor as soon as it's asleep, so don't sleep at all
+    uint32_t before = _interrupts;
+    uint64_t start = _now;
+
+    if (!(SREG.raw & _BV(SREG_I)))
+    {
+        fprintf(stderr, "sleep_cpu() with interrupts off at %llu nS, the board would never wake up\n", (unsigned long long)_now);
+        abort();
+    }
+    if (_interrupts != _interruptsAtSei) { _interruptsAtSei = _interrupts; return; }
+    while (_interrupts == before) advanceNs(nextEvent() - _now);        // Timer0 wakes it within 1 mS whatever else happens
+    _interruptsAtSei = _interrupts;
+    sleepNs += _now - start;
+    wakeups++;
+}
+
+uint32_t OSL_Host::readMicros(void)
+{
+    advanceNs(clockReadNs);
+    return (uint32_t)((_now / TIMER0_OVERFLOW_NS) * 1024 + (uint8_t)(_now / (64 * NS_PER_CYCLE)) * 4);    // 4 uS steps, as the core's
+}
+
+uint32_t OSL_Host::readMillis(void)
+{
+    advanceNs(clockReadNs);
+    return (uint32_t)(_now / 1000000ULL);
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// SERIAL
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+
+void OSL_Host::serialBegin(unsigned long baud)
+{
+    _byteNs = baud ? 10ULL * 1000000000ULL / baud : 0;                 // Start bit, 8 data bits, stop bit
+}
+
+void OSL_Host::serialInput(const void *data, size_t length)
+{
+    if (_rxComing.empty()) _rxNext = _now + _byteNs;
+    for (size_t i=0; i<length; i++) _rxComing.push_back(((const uint8_t *)data)[i]);
+}
+
+void OSL_Host::serialInputAt(uint8_t b, uint64_t ns)
+{
+    Edge e = { 0, EDGE_SERIAL, b, 0, 0 };
+    _edges.insert(std::make_pair(ns < _now ? _now : ns, e));
+}
+
+int OSL_Host::serialAvailable(void)         { return (int)_rx.size(); }
+int OSL_Host::serialPeek(void)              { return _rx.empty() ? -1 : _rx.front(); }
+int OSL_Host::serialAvailableForWrite(void) { return (int)(TX_BUFFER - _tx.size()); }
+
+int OSL_Host::serialRead(void)
+{
+    if (_rx.empty()) return -1;
+    uint8_t b = _rx.front();
+    _rx.pop_front();
+    return b;
+}
+
+void OSL_Host::serialWrite(uint8_t b)
+{
+    if (!_txBusy && _tx.empty())
+    {   // Nothing going out, straight to the data register
+        _txBusy = true;
+        _txDone = _now + _byteNs;
+        serialOutput += (char)b;
+        if (echoSerial) { putchar(b); fflush(stdout); }
+        return;
+    }
+    while (_tx.size() >= TX_BUFFER) advanceNs(_txDone - _now);          // Buffer full, wait for room like the core does
+    _tx.push_back(b);
+}
+
+void OSL_Host::serialFlush(void)
+{
+    while (_txBusy) advanceNs(_txDone - _now);
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// EEPROM
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+
+void OSL_Host::writeEECR(uint8_t value)
+{
+    uint8_t old = EECR.raw;
+
+    EECR.raw = (value & (_BV(EERIE) | _BV(EEMPE))) | (old & _BV(EEPE));     // EEPE is only cleared by the hardware
+    if (!(value & _BV(EEMPE)) || ((old & _BV(EEMPE)) && !(value & _BV(EEPE)))) EECR.raw &= ~_BV(EEMPE);   // Only good for the next write
+
+    if ((value & _BV(EERE)) && !(old & _BV(EEPE))) EEDR = eeprom[EEAR % HOST_EEPROM_SIZE];
+
+    if ((value & _BV(EEPE)) && (old & _BV(EEMPE)) && !(old & _BV(EEPE)))
+    {   // Start a write. If the power goes now, the byte has been erased but not yet written.
+        if (eepromWritesLeft == 0)
+        {
+            eeprom[EEAR % HOST_EEPROM_SIZE] = 0xFF;
+            throw PowerLoss();
+        }
+        if (eepromWritesLeft > 0) eepromWritesLeft--;
+        eepromWrites++;
+        _eepromAddress = EEAR % HOST_EEPROM_SIZE;
+        _eepromValue = EEDR;
+        _eepromDone = _now + HOST_EEPROM_WRITE_NS;
+        EECR.raw = (EECR.raw | _BV(EEPE)) & ~_BV(EEMPE);
+    }
+    service();
+}
+
+void OSL_Host::eepromWriteNow(uint16_t address, uint8_t value)
+{
+    uint8_t oldSREG;
+
+    while (EECR.raw & _BV(EEPE)) advanceNs(_eepromDone - _now);
+    oldSREG = SREG;
+    cli();
+    EEAR = address;
+    EEDR = value;
+    EECR |= _BV(EEMPE);
+    EECR |= _BV(EEPE);
+    SREG = oldSREG;
+}
+
+HostSREG &HostSREG::operator=(uint8_t v)
+{
+    raw = v;
+    if (raw & _BV(SREG_I)) Host.service();
+    return *this;
+}
+
+HostEECR &HostEECR::operator=(uint8_t v)
+{
+    Host.writeEECR(v);
+    return *this;
+}
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+    eeprom_busy_wait();
+    EEAR = (uint16_t)(uintptr_t)addr;
+    EECR |= _BV(EERE);
+    return EEDR;
+}
+
+uint16_t eeprom_read_word(const uint16_t *addr)
+{
+    return eeprom_read_byte((const uint8_t *)addr) | ((uint16_t)eeprom_read_byte((const uint8_t *)addr + 1) << 8);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    for (size_t i=0; i<n; i++) ((uint8_t *)dst)[i] = eeprom_read_byte((const uint8_t *)src + i);
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+    Host.eepromWriteNow((uint16_t)(uintptr_t)addr, value);
+}
+
+void eeprom_write_word(uint16_t *addr, uint16_t value)
+{
+    eeprom_write_byte((uint8_t *)addr, value & 0xFF);
+    eeprom_write_byte((uint8_t *)addr + 1, value >> 8);
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+    for (size_t i=0; i<n; i++) eeprom_write_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+    if (eeprom_read_byte(addr) != value) eeprom_write_byte(addr, value);
+}
+
+void eeprom_update_word(uint16_t *addr, uint16_t value)
+{
+    eeprom_update_byte((uint8_t *)addr, value & 0xFF);
+    eeprom_update_byte((uint8_t *)addr + 1, value >> 8);
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+    for (size_t i=0; i<n; i++) eeprom_update_byte((uint8_t *)dst + i, ((const uint8_t *)src)[i]);
+}
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// ARDUINO CORE
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+
+void init(void)                             { Host.reset(); }
+void yield(void)                            { Host.advanceNs(Host.clockReadNs); }
+void cli(void)                              { SREG.raw &= ~_BV(SREG_I); }
+void sei(void)                              { Host.interruptsOn(); }
+void sleep_cpu(void)                        { Host.sleep(); }
+
+uint32_t millis(void)                       { return Host.readMillis(); }
+uint32_t micros(void)                       { return Host.readMicros(); }
+void delay(unsigned long ms)                { Host.advanceNs((uint64_t)ms * 1000000ULL); }
+void delayMicroseconds(unsigned int us)     { Host.advanceNs((uint64_t)us * 1000ULL); }
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= HOST_PINS) return;
+    uint8_t bit = pinBit(pin);
+    if (mode == OUTPUT)             { *ddrReg(pin) |= bit; }
+    else if (mode == INPUT_PULLUP)  { *ddrReg(pin) &= ~bit; *portReg(pin) |= bit; }
+    else                            { *ddrReg(pin) &= ~bit; *portReg(pin) &= ~bit; }
+    Host.pinModeChanged(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin >= HOST_PINS) return;
+    if (val) *portReg(pin) |= pinBit(pin);
+    else     *portReg(pin) &= ~pinBit(pin);
+    Host.pinWritten(pin, val ? 255 : 0);
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= HOST_PINS) return LOW;
+    return (*pinReg(pin) & pinBit(pin)) ? HIGH : LOW;
+}
+
+void analogWrite(uint8_t pin, int val)
+{   // As the core: 0 and 255 are plain digital writes, anything in between is PWM
+    if (pin >= HOST_PINS) return;
+    pinMode(pin, OUTPUT);
+    if (val <= 0)           digitalWrite(pin, LOW);
+    else if (val >= 255)    digitalWrite(pin, HIGH);
+    else                    Host.pinWritten(pin, (uint8_t)val);
+}
+
+int analogRead(uint8_t pin)
+{
+    if (pin < 14) pin += 14;                                            // A0 or 0 both mean the first analog input
+    return pin < HOST_PINS + 2 ? Host.analogValue[pin] : 0;
+}
+
+uint8_t digitalPinToPort(uint8_t pin)       { return pin < 8 ? PD : (pin < 14 ? PB : (pin < HOST_PINS ? PC : NOT_A_PIN)); }
+uint8_t digitalPinToBitMask(uint8_t pin)    { return pin < HOST_PINS ? pinBit(pin) : 0; }
+
+volatile uint8_t *portOutputRegister(uint8_t port)  { return port == PB ? &PORTB : (port == PC ? &PORTC : (port == PD ? &PORTD : NULL)); }
+volatile uint8_t *portInputRegister(uint8_t port)   { return port == PB ? &PINB : (port == PC ? &PINC : (port == PD ? &PIND : NULL)); }
+volatile uint8_t *portModeRegister(uint8_t port)    { return port == PB ? &DDRB : (port == PC ? &DDRC : (port == PD ? &DDRD : NULL)); }
+
+static long doRandom(void)
+{   // avr-libc's random(), so a given seed gives the same numbers as on the board
+    int32_t hi, lo, x;
+    x = (int32_t)randomContext;
+    if (x == 0) x = 123459876L;
+    hi = x / 127773L;
+    lo = x % 127773L;
+    x = 16807L * lo - 2836L * hi;
+    if (x < 0) x += 0x7FFFFFFFL;
+    randomContext = (unsigned long)x;
+    return x % 0x80000000L;
+}
+
+long random(long howbig)                    { return howbig == 0 ? 0 : doRandom() % howbig; }
+long random(long howsmall, long howbig)     { return howsmall >= howbig ? howsmall : random(howbig - howsmall) + howsmall; }
+void randomSeed(unsigned long seed)         { if (seed != 0) randomContext = (uint32_t)seed; }
+long map(long x, long in_min, long in_max, long out_min, long out_max) { return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min; }
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// PRINT
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--) { if (write(*buffer++)) n++; else break; }
+    return n;
+}
+
+size_t Print::print(const __FlashStringHelper *s)   { return write((const char *)s); }
+size_t Print::print(const char s[])                 { return write(s); }
+size_t Print::print(char c)                         { return write((uint8_t)c); }
+size_t Print::print(unsigned char b, int base)      { return print((unsigned long)b, base); }
+size_t Print::print(unsigned int n, int base)       { return print((unsigned long)n, base); }
+size_t Print::print(int n, int base)                { return print((long)n, base); }
+size_t Print::print(double n, int digits)           { return printFloat(n, digits); }
+
+size_t Print::print(long n, int base)
+{
+    if (base == 0) return write((uint8_t)n);
+    if (base == 10 && n < 0) return print('-') + printNumber((unsigned long)-n, 10);
+    return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    if (base == 0) return write((uint8_t)n);
+    return printNumber(n, base);
+}
+
+size_t Print::println(void)                                 { return write("\r\n"); }
+size_t Print::println(const __FlashStringHelper *s)         { return print(s) + println(); }
+size_t Print::println(const char c[])                       { return print(c) + println(); }
+size_t Print::println(char c)                               { return print(c) + println(); }
+size_t Print::println(unsigned char b, int base)            { return print(b, base) + println(); }
+size_t Print::println(int num, int base)                    { return print(num, base) + println(); }
+size_t Print::println(unsigned int num, int base)           { return print(num, base) + println(); }
+size_t Print::println(long num, int base)                   { return print(num, base) + println(); }
+size_t Print::println(unsigned long num, int base)          { return print(num, base) + println(); }
+size_t Print::println(double num, int digits)               { return print(num, digits) + println(); }
+
+size_t Print::printNumber(unsigned long n, uint8_t base)
+{
+    char buf[8 * sizeof(long) + 1];
+    char *str = &buf[sizeof(buf) - 1];
+
+    *str = '\0';
+    if (base < 2) base = 10;
+    do {
+        char c = n % base;
+        n /= base;
+        *--str = c < 10 ? c + '0' : c + 'A' - 10;
+    } while (n);
+    return write(str);
+}
+
+size_t Print::printFloat(double number, uint8_t digits)
+{   // The core's way of doing it, rounding included, so the output matches
+    size_t n = 0;
+    if (isnan(number)) return print("nan");
+    if (isinf(number)) return print("inf");
+    if (number > 4294967040.0) return print("ovf");
+    if (number < -4294967040.0) return print("ovf");
+    if (number < 0.0) { n += print('-'); number = -number; }
+
+    double rounding = 0.5;
+    for (uint8_t i=0; i<digits; ++i) rounding /= 10.0;
+    number += rounding;
+
+    unsigned long int_part = (unsigned long)number;
+    double remainder = number - (double)int_part;
+    n += print(int_part);
+    if (digits > 0) n += print('.');
+    while (digits-- > 0)
+    {
+        remainder *= 10.0;
+        unsigned int toPrint = (unsigned int)remainder;
+        n += print(toPrint);
+        remainder -= toPrint;
+    }
+    return n;
+}
+
+void   HardwareSerial::begin(unsigned long baud, uint8_t)   { Host.serialBegin(baud); }
+void   HardwareSerial::end(void)                            { Host.serialFlush(); }
+int    HardwareSerial::available(void)                      { return Host.serialAvailable(); }
+int    HardwareSerial::peek(void)                           { return Host.serialPeek(); }
+int    HardwareSerial::read(void)                           { return Host.serialRead(); }
+int    HardwareSerial::availableForWrite(void)              { return Host.serialAvailableForWrite(); }
+void   HardwareSerial::flush(void)                          { Host.serialFlush(); }
+size_t HardwareSerial::write(uint8_t b)                     { Host.serialWrite(b); return 1; }
+
+
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// INTERRUPT VECTORS
+// ------------------------------------------------------------------------------------------------------------------------------------------------------->
+// These are used when nothing in the build defines the vector itself. The pin change ones do what the PinChangeInterrupt library's do: work out
+// which pins changed and call the function attached to each.
+
+static void    (*pcintFunction[24])(void);
+static uint8_t pcintMode[24];
+static uint8_t pcintTrigger[24];
+static uint8_t pcintLast[3];
+
+static void pcintDispatch(uint8_t port, uint8_t pins)
+{
+    volatile uint8_t *mask = port == 0 ? &PCMSK0 : (port == 1 ? &PCMSK1 : &PCMSK2);
+    uint8_t changed = (pins ^ pcintLast[port]) & *mask;
+    pcintLast[port] = pins;
+    for (uint8_t i=0; i<8; i++)
+    {
+        uint8_t n = port * 8 + i;
+        if (!(changed & _BV(i)) || !pcintFunction[n]) continue;
+        pcintTrigger[n] = (pins & _BV(i)) ? RISING : FALLING;
+        if (pcintMode[n] == CHANGE || pcintMode[n] == pcintTrigger[n]) pcintFunction[n]();
+    }
+}
+
+extern "C" {
+__attribute__((weak)) void PCINT0_vect(void)        { pcintDispatch(0, PINB); }
+__attribute__((weak)) void PCINT1_vect(void)        { pcintDispatch(1, PINC); }
+__attribute__((weak)) void PCINT2_vect(void)        { pcintDispatch(2, PIND); }
+__attribute__((weak)) void TIMER2_OVF_vect(void)    { }
+__attribute__((weak)) void TIMER1_COMPA_vect(void)  { }
+__attribute__((weak)) void EE_READY_vect(void)      { EECR.raw &= ~_BV(EERIE); }
+}
+
+void attachPCINT(uint8_t pcintNum, void (*userFunc)(void), uint8_t mode)
+{
+    uint8_t port = pcintNum / 8;
+    if (pcintNum >= 24) return;
+    pcintFunction[pcintNum] = userFunc;
+    pcintMode[pcintNum] = mode;
+    pcintLast[port] = port == 0 ? PINB : (port == 1 ? PINC : PIND);
+    enablePCINT(pcintNum);
+}
+
+void detachPCINT(uint8_t pcintNum)
+{
+    if (pcintNum >= 24) return;
+    disablePCINT(pcintNum);
+    pcintFunction[pcintNum] = NULL;
+}
+
+void enablePCINT(uint8_t pcintNum)
+{
+    uint8_t port = pcintNum / 8;
+    if (pcintNum >= 24) return;
+    *(port == 0 ? &PCMSK0 : (port == 1 ? &PCMSK1 : &PCMSK2)) |= _BV(pcintNum % 8);
+    PCICR |= _BV(port);
+}
+
+void disablePCINT(uint8_t pcintNum)
+{
+    uint8_t port = pcintNum / 8;
+    if (pcintNum >= 24) return;
+    *(port == 0 ? &PCMSK0 : (port == 1 ? &PCMSK1 : &PCMSK2)) &= ~_BV(pcintNum % 8);
+}
+
+uint8_t getPinChangeInterruptTrigger(uint8_t pcintNum)
+{
+    return pcintNum < 24 ? pcintTrigger[pcintNum] : 0;
+}
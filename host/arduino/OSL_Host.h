@@ -0,0 +1,165 @@
+/* OSL_Host.h           Host build - a simulated ATmega328 for running the sketch on a PC
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * The Host object keeps the simulated time and everything that happens by itself as time goes by: the timers, the pin changes coming in, the
+ * serial port sending and receiving, and the EEPROM finishing a write. Each of these sets its interrupt flag at the right moment, and the
+ * interrupt runs as soon as interrupts are on, just as on the board.
+ *
+ * Time never moves on its own. It moves when the sketch waits for it (delay(), sleep_cpu(), a full serial buffer, a write to an EEPROM that's
+ * still busy), when the test moves it with advance(), and by clockReadNs each time the sketch reads millis() or micros(). That last one is a
+ * rough stand-in for the time the code in between takes, and it's what keeps a loop that watches the clock from going round forever. Nothing
+ * else the code does takes any time, so this measures waiting, not processing - use the profiler or the simavr benchmarks for that.
+ *
+ * Inputs: drivePin() sets the level on a pin now, edgeAt() at some time in the future, and rcPulse() starts a repeating RC signal on a pin
+ * (rcPulseAt() at some time in the future). Inputs set up in advance keep coming even while the sketch is stuck in a loop of its own.
+ * serialInput() sends bytes to the sketch at the port's baud rate (serialInputAt() from some time in the future). Outputs: pinOutput() is the level the sketch last wrote to a pin (analogWrite
+ * values, or 0 and 255), onPinWrite is called each time it writes one, and serialOutput collects everything sent out the serial port.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef OSL_Host_h
+#define OSL_Host_h
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <map>
+#include <deque>
+
+#define HOST_EEPROM_SIZE        1024
+#define HOST_EEPROM_WRITE_NS    3400000ULL                              // 3.4 mS per byte, from the datasheet
+#define HOST_PINS               20                                      // Digital 0-13 and A0-A5
+
+
+class OSL_Host
+{   public:
+        struct PowerLoss { };                                           // Thrown by an EEPROM write once eepromWritesLeft runs out
+        struct Stop { };                                                // Thrown when the time reaches stopAt
+
+        void        reset(bool eraseEEPROM = true);                     // Power on: time 0, registers as the core's init() leaves them, interrupts on.
+                                                                        // init() calls this, so a test starts with init() then setup() like the core's main()
+
+        // Time
+        uint64_t    now(void) { return _now; }                          // Simulated time in nS
+        void        advanceNs(uint64_t ns);                             // Let time go by, running whatever interrupts come due
+        void        advance(uint32_t uS) { advanceNs((uint64_t)uS * 1000); }
+        void        sleep(void);                                        // sleep_cpu(): on to the next interrupt
+        uint32_t    clockReadNs;                                        // Time taken by each millis() or micros() call, 1 uS to start with
+        uint64_t    stopAt;                                             // If not 0, throw Stop once the time gets here, wherever the sketch is (outside
+                                                                        // an interrupt). For ending a run when the sketch may be in a loop of its own.
+
+        // Pins
+        void        drivePin(uint8_t pin, uint8_t level);               // Drive an input pin high or low from outside
+        void        releasePin(uint8_t pin);                            // Stop driving it, the pullup (if on) decides the level
+        void        edgeAt(uint8_t pin, uint8_t level, uint64_t ns);    // Drive it at some time from now on
+        void        rcPulse(uint8_t pin, uint16_t uS, uint32_t periodUs = 20000);  // Repeating RC pulse of this width, from the next frame. 0 stops it.
+        void        rcPulseAt(uint8_t pin, uint16_t uS, uint64_t ns, uint32_t periodUs = 20000);  // The same, at some time from now on
+        uint8_t     pinOutput(uint8_t pin);                             // What the sketch last wrote: 0-255
+        void        (*onPinWrite)(uint8_t pin, uint8_t value);          // Called every time the sketch writes to a pin, if set
+        uint16_t    analogValue[HOST_PINS + 2];                         // What analogRead() returns for each pin
+
+        // Serial port
+        void        serialInput(const void *data, size_t length);       // Arrives one byte after another, at the baud rate, after anything already on its way
+        void        serialInput(const char *text) { serialInput(text, strlen(text)); }
+        void        serialInputAt(uint8_t b, uint64_t ns);              // One byte, starting at some time from now on (another board's output, say)
+        std::string serialOutput;                                       // Every byte the sketch has sent, as it leaves the transmit buffer
+        bool        echoSerial;                                         // Also print what the sketch sends to stdout
+        uint32_t    serialDropped;                                      // Bytes lost because the receive buffer was full
+
+        // EEPROM
+        uint8_t     eeprom[HOST_EEPROM_SIZE];                           // Erased to 0xFF by reset(), unless it's told not to
+        int32_t     eepromWritesLeft;                                   // -1 for no limit. The write after the last one allowed throws PowerLoss.
+        uint32_t    eepromWrites;                                       // Bytes actually written (an update that doesn't change a byte doesn't count)
+
+        // What happened
+        uint64_t    sleepNs;                                            // Total time spent in sleep_cpu()
+        uint32_t    wakeups;                                            // How many times sleep_cpu() woke up
+        uint32_t    interruptCount[8];                                  // Interrupts run, by HostVector
+        bool        inInterrupt(void) { return _inInterrupt; }
+
+        enum HostVector { VECT_PCINT0, VECT_PCINT1, VECT_PCINT2, VECT_TIMER2_OVF, VECT_TIMER1_COMPA, VECT_TIMER0_OVF, VECT_USART, VECT_EE_READY };
+
+        // Used by the Arduino and avr shims
+        uint32_t    readMicros(void);
+        uint32_t    readMillis(void);
+        void        service(void);                                      // Run any interrupts that are waiting, if interrupts are on
+        void        writeEECR(uint8_t value);
+        void        pinModeChanged(uint8_t pin);
+        void        pinWritten(uint8_t pin, uint8_t value);
+        void        serialBegin(unsigned long baud);
+        int         serialAvailable(void);
+        int         serialPeek(void);
+        int         serialRead(void);
+        int         serialAvailableForWrite(void);
+        void        serialWrite(uint8_t b);
+        void        serialFlush(void);
+        void        interruptsOn(void);                                 // sei()
+        void        eepromWriteNow(uint16_t address, uint8_t value);   // avr-libc style, waits for any write in progress
+
+    private:
+        enum EdgeKind { EDGE_LEVEL, EDGE_RC_FRAME, EDGE_RC_SET, EDGE_SERIAL };
+        struct Edge { uint8_t pin; uint8_t kind; uint8_t level; uint16_t width; uint32_t period; };
+        struct RCSignal { uint16_t width; uint32_t period; bool running; };
+
+        uint64_t    _now;
+        bool        _inInterrupt;
+        uint32_t    _interrupts;                                        // All of interruptCount added up, to tell if sleep() has been woken
+        uint32_t    _interruptsAtSei;
+
+        std::multimap<uint64_t, Edge> _edges;
+        RCSignal    _rc[HOST_PINS];
+        int8_t      _drive[HOST_PINS];                                  // -1 not driven
+        uint8_t     _output[HOST_PINS];
+
+        uint64_t    _timer0Next;
+        uint64_t    _timer1Next;
+        uint64_t    _timer2Next;
+        uint64_t    _eepromDone;
+        uint16_t    _eepromAddress;
+        uint8_t     _eepromValue;
+
+        uint64_t    _byteNs;
+        bool        _txBusy;
+        uint64_t    _txDone;
+        std::deque<uint8_t> _tx;
+        std::deque<uint8_t> _rx;
+        std::deque<uint8_t> _rxComing;
+        uint64_t    _rxNext;
+
+        uint64_t    nextEvent(void);
+        void        runEvent(uint64_t t);
+        void        runVector(HostVector v);
+        void        updateInput(uint8_t pin);
+        void        syncTimer0(void);
+        uint64_t    timer2Period(void);
+        uint64_t    timer1Period(void);
+};
+
+extern OSL_Host Host;
+
+
+// The sketch's own setup() and loop(), and a way to run the loop for a while
+void setup(void);
+void loop(void);
+
+inline void runSketch(uint32_t ms)
+{
+    uint64_t end = Host.now() + (uint64_t)ms * 1000000ULL;
+    while (Host.now() < end) loop();
+}
+
+#endif
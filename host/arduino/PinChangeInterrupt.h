@@ -0,0 +1,39 @@
+/* PinChangeInterrupt.h Host build - stands in for the PinChangeInterrupt library in src/OSL_PinChangeInterrupt
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * The library's own vectors are AVR assembly, so the host build copies this file over the library's header and leaves its .cpp files out.
+ * attachPCINT() sets the same mask bits the library does, and the host's default pin change vectors call the attached functions (OSL_Host.cpp).
+ * A vector the sketch defines itself, as the RC tab does with PCINT_TEMPLATE_DISPATCH, takes the place of the default one.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PINCHANGEINTERRUPT_H
+#define PINCHANGEINTERRUPT_H
+
+#include <Arduino.h>
+
+// PCINT0-5 are pins 8-13 (port B), PCINT8-13 are A0-A5 (port C), PCINT16-23 are pins 0-7 (port D)
+#define digitalPinToPCINT(p)    ((p) < 8 ? (p) + 16 : ((p) < 14 ? (p) - 8 : ((p) < 20 ? (p) - 6 : NOT_AN_INTERRUPT)))
+#define NOT_AN_INTERRUPT        -1
+
+void    attachPCINT(uint8_t pcintNum, void (*userFunc)(void), uint8_t mode);
+void    detachPCINT(uint8_t pcintNum);
+void    enablePCINT(uint8_t pcintNum);
+void    disablePCINT(uint8_t pcintNum);
+uint8_t getPinChangeInterruptTrigger(uint8_t pcintNum);
+
+#endif
@@ -0,0 +1,44 @@
+/* avr/eeprom.h         Host build - the avr-libc EEPROM functions
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * These wait for any write in progress, as avr-libc's do, and go through the same simulated EEPROM as EECR (see OSL_Host.h).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _AVR_EEPROM_H_
+#define _AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+
+#define eeprom_is_ready()           (!(EECR & _BV(EEPE)))
+#define eeprom_busy_wait()          do { yield(); } while (!eeprom_is_ready())     // yield() lets the simulated time go by
+
+void     yield(void);
+
+uint8_t  eeprom_read_byte(const uint8_t *addr);
+uint16_t eeprom_read_word(const uint16_t *addr);
+void     eeprom_read_block(void *dst, const void *src, size_t n);
+void     eeprom_write_byte(uint8_t *addr, uint8_t value);
+void     eeprom_write_word(uint16_t *addr, uint16_t value);
+void     eeprom_write_block(const void *src, void *dst, size_t n);
+void     eeprom_update_byte(uint8_t *addr, uint8_t value);
+void     eeprom_update_word(uint16_t *addr, uint16_t value);
+void     eeprom_update_block(const void *src, void *dst, size_t n);
+
+#endif
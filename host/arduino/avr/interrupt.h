@@ -0,0 +1,45 @@
+/* avr/interrupt.h      Host build - interrupt vectors and cli()/sei()
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * ISR() defines an ordinary function with the vector's name, which the host calls when the interrupt would have fired (see OSL_Host.h).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _AVR_INTERRUPT_H_
+#define _AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+void cli(void);
+void sei(void);
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define ISR(vector, ...)    extern "C" void vector(void); extern "C" void vector(void)
+#define reti()
+
+extern "C" {
+void PCINT0_vect(void);
+void PCINT1_vect(void);
+void PCINT2_vect(void);
+void TIMER2_OVF_vect(void);
+void TIMER1_COMPA_vect(void);
+void EE_READY_vect(void);
+}
+
+#endif
@@ -0,0 +1,150 @@
+/* avr/io.h             Host build - the ATmega328 registers the sketch touches
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Most registers are plain bytes that the host reads when it needs to (the interrupt masks and timer setup) or keeps up to date itself (the
+ * PINx inputs and the Timer0 count). The few with side effects on the board have them here too: SREG turns interrupts on and off, EECR runs
+ * the EEPROM, and writing a 1 to an interrupt flag clears it. See OSL_Host.h.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _AVR_IO_H_
+#define _AVR_IO_H_
+
+#include <stdint.h>
+
+#ifndef F_CPU
+#define F_CPU           16000000UL
+#endif
+
+#define _BV(bit)        (1 << (bit))
+#define E2END           0x3FF
+#define RAMEND          0x8FF
+
+// Status register. Setting the I bit runs any interrupts that are waiting.
+class HostSREG
+{   public:
+        uint8_t raw;
+        operator uint8_t() const { return raw; }
+        HostSREG &operator=(uint8_t v);
+        HostSREG &operator|=(uint8_t v) { return *this = raw | v; }
+        HostSREG &operator&=(uint8_t v) { return *this = raw & v; }
+};
+
+// Interrupt flag registers, where writing a 1 clears the flag
+class HostFlagRegister
+{   public:
+        uint8_t raw;
+        operator uint8_t() const { return raw; }
+        HostFlagRegister &operator=(uint8_t v)  { raw &= ~v; return *this; }
+        HostFlagRegister &operator|=(uint8_t v) { raw &= ~(raw | v); return *this; }     // Read-modify-write clears every flag that was set
+        HostFlagRegister &operator&=(uint8_t v) { raw &= ~(raw & v); return *this; }
+};
+
+// EEPROM control register. Reads and writes happen as the bits are set, with the write taking its 3.4 mS of simulated time.
+class HostEECR
+{   public:
+        uint8_t raw;
+        operator uint8_t() const { return raw; }
+        HostEECR &operator=(uint8_t v);
+        HostEECR &operator|=(uint8_t v) { return *this = raw | v; }
+        HostEECR &operator&=(uint8_t v) { return *this = raw & v; }
+};
+
+extern HostSREG             SREG;
+extern HostEECR             EECR;
+extern HostFlagRegister     TIFR0, TIFR1, TIFR2, PCIFR;
+
+extern volatile uint8_t     PINB, PINC, PIND, PORTB, PORTC, PORTD, DDRB, DDRC, DDRD;
+extern volatile uint8_t     PCICR, PCMSK0, PCMSK1, PCMSK2;
+extern volatile uint8_t     TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0;
+extern volatile uint8_t     TCCR1A, TCCR1B, TCCR1C, TIMSK1;
+extern volatile uint16_t    TCNT1, OCR1A, OCR1B, ICR1;
+extern volatile uint8_t     TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2;
+extern volatile uint8_t     EEDR;
+extern volatile uint16_t    EEAR;
+extern volatile uint8_t     SMCR, MCUCR, MCUSR, WDTCSR;
+
+// SREG
+#define SREG_I          7
+
+// EECR
+#define EERE            0
+#define EEPE            1
+#define EEMPE           2
+#define EERIE           3
+
+// Pin change interrupts
+#define PCIE0           0
+#define PCIE1           1
+#define PCIE2           2
+#define PCIF0           0
+#define PCIF1           1
+#define PCIF2           2
+
+// Timer0
+#define TOIE0           0
+#define OCIE0A          1
+#define OCIE0B          2
+#define TOV0            0
+#define OCF0A           1
+#define OCF0B           2
+#define CS00            0
+#define CS01            1
+#define CS02            2
+#define WGM00           0
+#define WGM01           1
+
+// Timer1
+#define TOIE1           0
+#define OCIE1A          1
+#define OCIE1B          2
+#define TOV1            0
+#define OCF1A           1
+#define OCF1B           2
+#define CS10            0
+#define CS11            1
+#define CS12            2
+#define WGM10           0
+#define WGM11           1
+#define WGM12           3
+#define WGM13           4
+#define COM1A0          6
+#define COM1A1          7
+#define COM1B0          4
+#define COM1B1          5
+
+// Timer2
+#define TOIE2           0
+#define OCIE2A          1
+#define OCIE2B          2
+#define TOV2            0
+#define OCF2A           1
+#define OCF2B           2
+#define CS20            0
+#define CS21            1
+#define CS22            2
+#define WGM20           0
+#define WGM21           1
+#define WGM22           3
+
+// Sleep
+#define SE              0
+#define SM0             1
+#define SM1             2
+#define SM2             3
+
+#endif
@@ -0,0 +1,57 @@
+/* avr/pgmspace.h       Host build - program memory
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * There is only one address space on a PC, so PROGMEM data stays in RAM and the pgm_read functions just read it.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __PGMSPACE_H_
+#define __PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PGM_P                       const char *
+#define PGM_VOID_P                  const void *
+#define PSTR(s)                     (s)
+
+#define pgm_read_byte(addr)         (*(const uint8_t *)(addr))
+#define pgm_read_word(addr)         (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr)        (*(const uint32_t *)(addr))
+#define pgm_read_ptr(addr)          (*(void * const *)(addr))
+#define pgm_read_byte_near(addr)    pgm_read_byte(addr)
+#define pgm_read_word_near(addr)    pgm_read_word(addr)
+#define pgm_read_dword_near(addr)   pgm_read_dword(addr)
+#define pgm_read_ptr_near(addr)     pgm_read_ptr(addr)
+#define pgm_read_byte_far(addr)     pgm_read_byte(addr)
+
+#define memcpy_P                    memcpy
+#define memcmp_P                    memcmp
+#define strcpy_P                    strcpy
+#define strncpy_P                   strncpy
+#define strcmp_P                    strcmp
+#define strncmp_P                   strncmp
+#define strcasecmp_P                strcasecmp
+#define strncasecmp_P               strncasecmp
+#define strlen_P                    strlen
+#define sprintf_P                   sprintf
+#define snprintf_P                  snprintf
+
+#endif
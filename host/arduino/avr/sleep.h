@@ -0,0 +1,38 @@
+/* avr/sleep.h          Host build - sleep modes
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * sleep_cpu() lets simulated time run on to the next interrupt (see OSL_Host.h).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _AVR_SLEEP_H_
+#define _AVR_SLEEP_H_
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE             0
+#define SLEEP_MODE_ADC              _BV(SM0)
+#define SLEEP_MODE_PWR_DOWN         _BV(SM1)
+#define SLEEP_MODE_PWR_SAVE         (_BV(SM0) | _BV(SM1))
+
+#define set_sleep_mode(mode)        do { SMCR = (SMCR & ~(_BV(SM0) | _BV(SM1) | _BV(SM2))) | (mode); } while (0)
+#define sleep_enable()              do { SMCR |= _BV(SE); } while (0)
+#define sleep_disable()             do { SMCR &= ~_BV(SE); } while (0)
+void    sleep_cpu(void);
+#define sleep_mode()                do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
+
+#endif
@@ -0,0 +1,32 @@
+/* avr/wdt.h            Host build - watchdog
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * There is no watchdog on the host, these do nothing.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _AVR_WDT_H_
+#define _AVR_WDT_H_
+
+#define WDTO_15MS                   0
+#define WDTO_1S                     6
+#define WDTO_2S                     7
+#define wdt_reset()
+#define wdt_enable(timeout)
+#define wdt_disable()
+
+#endif
@@ -0,0 +1,35 @@
+/* util/atomic.h        Host build - ATOMIC_BLOCK
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * The same save, cli() and restore as avr-libc, so interrupts that came in during the block run when it ends.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _UTIL_ATOMIC_H_
+#define _UTIL_ATOMIC_H_
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+static inline uint8_t __host_atomic_begin(void) { uint8_t s = SREG; cli(); return s; }
+
+#define ATOMIC_RESTORESTATE         0
+#define ATOMIC_FORCEON              1
+#define ATOMIC_BLOCK(type)          for (uint8_t __sreg = __host_atomic_begin() | ((type) ? _BV(SREG_I) : 0), __todo = 1; __todo; __todo = 0, SREG = __sreg)
+#define NONATOMIC_BLOCK(type)       for (uint8_t __sreg = SREG, __todo = (sei(), 1); __todo; __todo = 0, SREG = __sreg)
+
+#endif
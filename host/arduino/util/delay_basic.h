@@ -0,0 +1,30 @@
+/* util/delay_basic.h   Host build - busy-wait loops
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Each loop pass takes 3 or 4 cycles on the board, here they let that much simulated time go by.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _UTIL_DELAY_BASIC_H_
+#define _UTIL_DELAY_BASIC_H_
+
+#include <Arduino.h>
+
+static inline void _delay_loop_1(uint8_t count) { Host.advanceNs((count ? count : 256) * 3 * (1000000000ULL / F_CPU)); }
+static inline void _delay_loop_2(uint16_t count) { Host.advanceNs((count ? count : 65536) * 4 * (1000000000ULL / F_CPU)); }
+
+#endif
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+osl_host_sketch.py      Turn the OpenSourceLights sketch into C++ for the host build
+Source:                 https://github.com/OSRCL/OSL_Original
+
+Does what the Arduino IDE does before compiling: puts the .ino tabs together (the main tab first, then the others in
+alphabetical order), adds a prototype for every function and includes Arduino.h at the top. The sketch is copied into
+the output folder first, so that settings can be changed for one build without touching the real AA_UserConfig.h or
+OSL_Settings.h, and the PinChangeInterrupt library is replaced with the host's stand-in (see host/arduino).
+
+Usage:
+    osl_host_sketch.py SKETCH_DIR OUT_DIR [--set NAME=VALUE ...]
+
+Writes OUT_DIR/OpenSourceLights/sketch.cpp next to the copied tabs and libraries. Files are only written when they
+change, so make doesn't rebuild everything each time CMake runs this.
+"""
+
+import os
+import re
+import sys
+import argparse
+
+HOST_DIR = os.path.dirname(os.path.abspath(__file__))
+SETTINGS_FILES = ['AA_UserConfig.h', os.path.join('src', 'OSL_Settings', 'OSL_Settings.h')]
+KEYWORDS = {'if', 'while', 'for', 'switch', 'return', 'else', 'do', 'case', 'sizeof'}
+DEFINITION = re.compile(r'^([A-Za-z_][\w\s\*&:<>,]*?[\s\*&]+)(\w+)\s*\(([^;{}]*)\)\s*(\{.*)?(//.*)?$')
+
+
+def write_if_changed(path, data):
+    if os.path.exists(path):
+        with open(path, 'rb') as f:
+            if f.read() == data:
+                return
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, 'wb') as f:
+        f.write(data)
+
+
+def copy_sketch(sketch_dir, out_dir):
+    """Copy every file, leaving out the real PinChangeInterrupt library's sources. Returns the files copied."""
+    copied = []
+    for root, dirs, files in os.walk(sketch_dir):
+        dirs.sort()
+        rel = os.path.relpath(root, sketch_dir)
+        for name in sorted(files):
+            if rel.endswith('OSL_PinChangeInterrupt') and name.endswith('.cpp'):
+                continue
+            src = os.path.join(root, name)
+            with open(src, 'rb') as f:
+                data = f.read()
+            if name == 'PinChangeInterrupt.h':
+                with open(os.path.join(HOST_DIR, 'arduino', 'PinChangeInterrupt.h'), 'rb') as f:
+                    data = f.read()
+            copied.append((os.path.normpath(os.path.join(rel, name)), data))
+    return copied
+
+
+def apply_settings(copied, settings):
+    """Change the value of each #define named in settings, in the first of SETTINGS_FILES that has it."""
+    files = dict(copied)
+    for name, value in settings:
+        define = re.compile(r'^(\s*#define\s+' + re.escape(name) + r'\s+)(\S+)', re.M)
+        for path in SETTINGS_FILES:
+            text = files[os.path.normpath(path)].decode('latin-1')
+            if define.search(text):
+                files[os.path.normpath(path)] = define.sub(lambda m: m.group(1) + value, text, count=1).encode('latin-1')
+                break
+        else:
+            sys.exit('%s is not #defined in %s' % (name, ' or '.join(SETTINGS_FILES)))
+    return [(path, files[path]) for path, _ in copied]
+
+
+def prototypes(lines):
+    """The Arduino IDE's prototype generator, near enough: every function defined at the top level that isn't already a
+    prototype. Returns the prototypes and the index of the line holding the first definition."""
+    found = []
+    first = None
+    depth = 0
+    for i, line in enumerate(lines):
+        if depth == 0 and not line.startswith('#'):
+            m = DEFINITION.match(line)
+            if m and m.group(2) not in KEYWORDS and 'class' not in m.group(1) and \
+                    not m.group(1).strip().startswith(('return', 'else', 'typedef', 'static inline', 'template')):
+                following = line if m.group(4) else next((x for x in lines[i + 1:] if x.strip()), '')
+                if following.strip().startswith('{'):
+                    args = re.sub(r'/\*.*?\*/', '', m.group(3))
+                    found.append('%s %s(%s);' % (m.group(1).strip(), m.group(2), args))
+                    if first is None:
+                        first = i
+        code = re.sub(r'//.*', '', line)
+        code = re.sub(r'"(\\.|[^"\\])*"', '""', code)
+        code = re.sub(r"'(\\.|[^'\\])*'", "''", code)
+        depth += code.count('{') - code.count('}')
+    return found, first
+
+
+def build_sketch(sketch_dir, copied):
+    tabs = sorted((p for p, _ in copied if p.endswith('.ino') and os.sep not in p), key=str.lower)
+    main = os.path.basename(os.path.abspath(sketch_dir)) + '.ino'
+    tabs.remove(main)
+    tabs.insert(0, main)
+    files = dict(copied)
+
+    lines = []                                  # (text, tab, line number)
+    for tab in tabs:
+        for n, text in enumerate(files[tab].decode('latin-1').split('\n')):
+            lines.append((text, tab, n + 1))
+    found, first = prototypes([text for text, _, _ in lines])
+
+    # #line directives point back at the real tabs, so compiler errors and the debugger show the file you'd edit
+    out = ['#include <Arduino.h>']
+    last = None
+    for i, (text, tab, n) in enumerate(lines):
+        if i == first:
+            out.append('// Prototypes')
+            out.extend(found)
+            last = None
+        if last != tab or i == first:
+            out.append('#line %d "%s"' % (n, os.path.join(os.path.abspath(sketch_dir), tab)))
+            last = tab
+        out.append(text)
+    return ('\n'.join(out) + '\n').encode('latin-1')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Turn the OpenSourceLights sketch into C++ for the host build')
+    parser.add_argument('sketch_dir')
+    parser.add_argument('out_dir')
+    parser.add_argument('--set', action='append', default=[], metavar='NAME=VALUE', help='change a #define for this build')
+    args = parser.parse_args()
+
+    settings = []
+    for s in args.set:
+        if '=' not in s:
+            sys.exit('--set needs NAME=VALUE, not %s' % s)
+        settings.append(tuple(s.split('=', 1)))
+
+    copied = apply_settings(copy_sketch(args.sketch_dir, args.out_dir), settings)
+    target = os.path.join(args.out_dir, os.path.basename(os.path.abspath(args.sketch_dir)))
+    for path, data in copied:
+        write_if_changed(os.path.join(target, path), data)
+    write_if_changed(os.path.join(target, 'sketch.cpp'), build_sketch(args.sketch_dir, copied))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,232 @@
+/* osl_replay.cpp       Host build - replay a recorded RC trace through the sketch, faster than real time
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * Runs the whole sketch on the simulated board (see host/README.md) and feeds its RC inputs from a CSV file, then writes out every change
+ * of every light output with the time it happened. An hour of driving takes seconds.
+ *
+ * Usage:
+ *      osl_replay TRACE.csv [-o TIMELINE.csv] [--param NAME=VALUE ...] [--tail MS]
+ *
+ * The trace's first row names its columns, and which columns are there decides how it's read:
+ *      time_ms, pulse1, pulse2, pulse3     Pulse widths in uS for throttle, steering and channel 3 from that time on, a new pulse every 20 mS.
+ *                                          0 means no signal. Other columns are ignored, so a CSV saved by tools/osl_telemetry.py --csv
+ *                                          replays as it is.
+ *      time_us, channel, level             Single edges on a channel (0-2), for traces captured with a logic analyzer
+ *
+ * --param sets one of the serial console's parameters (see the CONSOLE tab) as the trace starts, so the effect of a deadband or a
+ * delay can be compared without rebuilding. Anything set with a #define needs its own build, see osl_host_sketch() in CMakeLists.txt.
+ *
+ * The timeline has one row per change: time_us, light (1-8), level (0-255). A summary goes to stderr: for each light how often it changed,
+ * its average brightness, and how long it took to change after each change of the inputs in the trace (the brake light's latency, say).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+
+#define CHANNELS    3
+
+static const uint8_t RCPins[CHANNELS]   = { pin_HW1_Throttle, pin_HW1_Steering, pin_HW1_Ch3 };
+static const uint8_t LightPins[8]       = { pin_HW1_Light1, pin_HW1_Light2, pin_HW1_Light3, pin_HW1_Light4,
+                                            pin_HW1_Light5, pin_HW1_Light6, pin_HW1_Light7, pin_HW1_Light8 };
+
+struct TraceRow { uint64_t ns; int32_t value[CHANNELS]; };             // Pulse widths, or for an edge: channel, level
+struct LightStats
+{
+    uint8_t  level;
+    uint64_t since;                                                     // When it last changed
+    uint32_t changes;
+    double   levelNs;                                                   // Level x time, for the average
+    uint32_t responses;                                                 // Input changes it changed after, and how long it took
+    uint64_t responseNs;
+    uint64_t responseMaxNs;
+};
+
+static FILE       *timeline;
+static LightStats lights[8];
+static std::vector<uint64_t> inputChanges;                              // When the trace changes the inputs, for the latency
+static size_t     lastChange;                                           // Index of the most recent one, plus 1
+static bool       responded[8];                                         // Whether each light has changed since then
+
+static void onPinWrite(uint8_t pin, uint8_t value)
+{
+    while (lastChange < inputChanges.size() && inputChanges[lastChange] <= Host.now())
+    {
+        lastChange++;
+        memset(responded, 0, sizeof(responded));
+    }
+    for (uint8_t i=0; i<8; i++)
+    {
+        if (LightPins[i] != pin || lights[i].level == value) continue;
+        LightStats &l = lights[i];
+        uint64_t now = Host.now();
+        fprintf(timeline, "%llu,%d,%d\n", (unsigned long long)(now / 1000), i + 1, value);
+        l.levelNs += (double)l.level * (now - l.since);
+        l.level = value;
+        l.since = now;
+        l.changes++;
+        if (!responded[i] && lastChange > 0)
+        {
+            uint64_t took = now - inputChanges[lastChange - 1];
+            responded[i] = true;
+            l.responses++;
+            l.responseNs += took;
+            if (took > l.responseMaxNs) l.responseMaxNs = took;
+        }
+    }
+}
+
+static std::vector<std::string> splitCSV(const std::string &line)
+{
+    std::vector<std::string> fields;
+    std::string field;
+    for (size_t i=0; i<=line.size(); i++)
+    {
+        if (i == line.size() || line[i] == ',') { fields.push_back(field); field.clear(); }
+        else if (line[i] != ' ' && line[i] != '\r' && line[i] != '"') field += line[i];
+    }
+    return fields;
+}
+
+static bool readTrace(const char *path, std::vector<TraceRow> &rows, bool &edges)
+{
+    FILE *f = fopen(path, "r");
+    char buf[1024];
+    int  column[CHANNELS + 1];
+
+    if (!f) { perror(path); return false; }
+    if (!fgets(buf, sizeof(buf), f)) { fprintf(stderr, "%s is empty\n", path); fclose(f); return false; }
+
+    std::vector<std::string> header = splitCSV(std::string(buf, strcspn(buf, "\n")));
+    const char *pulseNames[CHANNELS + 1] = { "time_ms", "pulse1", "pulse2", "pulse3" };
+    const char *edgeNames[CHANNELS]      = { "time_us", "channel", "level" };
+    const char **names;
+    int count;
+
+    edges = false;
+    for (size_t i=0; i<header.size(); i++) if (header[i] == "time_us") edges = true;
+    names = edges ? edgeNames : pulseNames;
+    count = edges ? 3 : CHANNELS + 1;
+    for (int c=0; c<count; c++)
+    {
+        column[c] = -1;
+        for (size_t i=0; i<header.size(); i++) if (header[i] == names[c]) column[c] = i;
+        if (column[c] < 0) { fprintf(stderr, "%s has no %s column\n", path, names[c]); fclose(f); return false; }
+    }
+
+    while (fgets(buf, sizeof(buf), f))
+    {
+        std::vector<std::string> fields = splitCSV(std::string(buf, strcspn(buf, "\n")));
+        TraceRow row;
+        if (fields.size() <= 1 || fields[0].empty() || fields[0][0] == '#') continue;
+        uint64_t t = strtoull(fields[column[0]].c_str(), NULL, 10);
+        row.ns = edges ? t * 1000ULL : t * 1000000ULL;
+        for (int c=1; c<count; c++) row.value[c - 1] = (size_t)column[c] < fields.size() ? atoi(fields[column[c]].c_str()) : 0;
+        if (!rows.empty() && row.ns < rows.back().ns) { fprintf(stderr, "%s: times must not go backwards (%llu)\n", path, (unsigned long long)t); fclose(f); return false; }
+        rows.push_back(row);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *tracePath = NULL;
+    const char *outPath = NULL;
+    std::vector<std::string> params;
+    uint32_t tailMs = 1000;
+    std::vector<TraceRow> rows;
+    bool edges;
+
+    for (int i=1; i<argc; i++)
+    {
+        std::string a = argv[i];
+        if (a == "-o" && i + 1 < argc)                  outPath = argv[++i];
+        else if (a == "--param" && i + 1 < argc)        params.push_back(argv[++i]);
+        else if (a == "--tail" && i + 1 < argc)         tailMs = strtoul(argv[++i], NULL, 10);
+        else if (a[0] != '-' && !tracePath)             tracePath = argv[i];
+        else
+        {
+            fprintf(stderr, "Usage: %s TRACE.csv [-o TIMELINE.csv] [--param NAME=VALUE ...] [--tail MS]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (!tracePath) { fprintf(stderr, "No trace file given\n"); return 2; }
+    if (!readTrace(tracePath, rows, edges)) return 1;
+    timeline = outPath ? fopen(outPath, "w") : stdout;
+    if (!timeline) { perror(outPath); return 1; }
+    fprintf(timeline, "time_us,light,level\n");
+
+    init();
+    Host.onPinWrite = onPinWrite;
+    setup();
+
+    // Everything is queued up front and the host delivers each input at its time, so the trace keeps coming even while the sketch is in a
+    // loop of its own (waiting for a radio signal in shelf queen mode, say). The trace starts when setup() is done, with the console
+    // parameters arriving over the serial port in its first few milliseconds.
+    uint64_t start = Host.now();
+    for (uint8_t i=0; i<8; i++) lights[i].since = start;
+    for (size_t i=0; i<params.size(); i++)
+    {
+        size_t eq = params[i].find('=');
+        if (eq == std::string::npos) { fprintf(stderr, "--param needs NAME=VALUE, not %s\n", params[i].c_str()); return 2; }
+        Host.serialInput(("set " + params[i].substr(0, eq) + " " + params[i].substr(eq + 1) + "\n").c_str());
+    }
+    for (size_t r=0; r<rows.size(); r++)
+    {
+        if (edges)
+        {
+            Host.edgeAt(RCPins[rows[r].value[0] % CHANNELS], rows[r].value[1] ? HIGH : LOW, start + rows[r].ns);
+            continue;
+        }
+        bool changed = false;
+        for (uint8_t c=0; c<CHANNELS; c++)
+        {
+            if (r > 0 && rows[r].value[c] == rows[r - 1].value[c]) continue;
+            Host.rcPulseAt(RCPins[c], rows[r].value[c] > 0 ? rows[r].value[c] : 0, start + rows[r].ns);
+            changed = true;
+        }
+        if (changed && r > 0) inputChanges.push_back(start + rows[r].ns);
+    }
+
+    Host.stopAt = start + (rows.empty() ? 0 : rows.back().ns) + (uint64_t)tailMs * 1000000ULL;
+    try { for (;;) loop(); }
+    catch (OSL_Host::Stop &) { }
+
+    if (Host.serialOutput.find("Unknown") != std::string::npos || Host.serialOutput.find("Out of range") != std::string::npos)
+    {
+        fprintf(stderr, "A --param was not accepted:\n%s", Host.serialOutput.c_str());
+        return 1;
+    }
+
+    // Summary
+    uint64_t end = Host.now();
+    fprintf(stderr, "Replayed %.1f seconds, %u wakeups, asleep %.1f%% of the time\n", (end - start) / 1e9, Host.wakeups, 100.0 * Host.sleepNs / end);
+    fprintf(stderr, "Light  Changes  Average  Responses  Mean response mS  Max response mS\n");
+    for (uint8_t i=0; i<8; i++)
+    {
+        LightStats &l = lights[i];
+        l.levelNs += (double)l.level * (end - l.since);
+        fprintf(stderr, "%5d  %7u  %6.1f%%  %9u  %16.1f  %15.1f\n", i + 1, l.changes, 100.0 * l.levelNs / 255.0 / (end - start), l.responses,
+                l.responses ? l.responseNs / 1e6 / l.responses : 0.0, l.responseMaxNs / 1e6);
+    }
+    if (timeline != stdout) fclose(timeline);
+    return 0;
+}
@@ -0,0 +1,33 @@
+/* host_test.h          Host build - checks for the test programs
+ * Source:              https://github.com/OSRCL
+ * Authors:             Luke Middleton
+ *
+ * CHECK() prints the line of any check that fails and carries on, so one run shows everything that's wrong. End main() with
+ * return TEST_RESULT(), which is what ctest goes by.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef host_test_h
+#define host_test_h
+
+#include <stdio.h>
+
+static int testFailures = 0;
+
+#define CHECK(condition)    do { if (!(condition)) { printf("%s:%d: failed: %s\n", __FILE__, __LINE__, #condition); testFailures++; } } while (0)
+#define TEST_RESULT()       (printf(testFailures ? "%d check(s) failed\n" : "OK\n", testFailures), testFailures ? 1 : 0)
+
+#endif
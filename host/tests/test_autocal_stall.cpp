@@ -0,0 +1,75 @@
+/* test_autocal_stall.cpp   Host build - how long the main loop is held up when auto calibration saves while driving
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * With EnableAutoCalibration on, the learned channel extremes are saved to the config store every AUTOCAL_SAVE_INTERVAL_MS if they have
+ * moved. That happens while driving, so the save must not hold up the loop: a long pass drops radio pulses and light updates. This drives
+ * a sketch built with auto calibration on, and a short save interval, with the sticks going past the calibrated extremes, checks that the
+ * new extremes were saved, and prints the longest pass of loop() (not counting time asleep).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+#include "host_test.h"
+
+static_assert(EnableAutoCalibration, "Build this against a sketch with EnableAutoCalibration set to true");
+
+#define DRIVE_MS            (3 * AUTOCAL_SAVE_INTERVAL_MS)
+#define STEP_MS             500                                         // A new stick position this often
+#define STALL_LIMIT_NS      5000000ULL                                  // 5 mS, a fraction of a 20 mS radio frame
+
+int main()
+{
+    uint64_t start, end, longest = 0, longestAt = 0;
+    uint32_t writes;
+
+    init();
+    Host.rcPulse(pin_HW1_Throttle, 1500);
+    Host.rcPulse(pin_HW1_Steering, 1500);
+    Host.rcPulse(pin_HW1_Ch3, 1000);
+    setup();
+    runSketch(3000);
+    writes = Host.eepromWrites;
+
+    // Full throttle and steering both ways, a little further than the calibration, with rests at center in between
+    start = Host.now();
+    for (uint32_t ms=0; ms<DRIVE_MS; ms+=STEP_MS)
+    {
+        static const uint16_t Sticks[4] = { 1500, PULSE_WIDTH_TYP_MAX + 50, 1500, PULSE_WIDTH_TYP_MIN - 50 };
+        uint64_t at = start + (uint64_t)ms * 1000000ULL;
+        Host.rcPulseAt(pin_HW1_Throttle, Sticks[(ms / STEP_MS) % 4], at);
+        Host.rcPulseAt(pin_HW1_Steering, Sticks[(ms / STEP_MS + 1) % 4], at);
+    }
+    end = start + DRIVE_MS * 1000000ULL;
+
+    while (Host.now() < end)
+    {
+        uint64_t t = Host.now();
+        uint64_t slept = Host.sleepNs;
+        loop();
+        uint64_t busy = (Host.now() - t) - (Host.sleepNs - slept);     // Time asleep waiting for the next tick isn't a stall
+        if (busy > longest) { longest = busy; longestAt = t - start; }
+    }
+
+    printf("%lu S of driving, %u bytes saved to EEPROM, longest pass of loop() %.2f mS (at %.1f S)\n", (unsigned long)(DRIVE_MS / 1000),
+           (unsigned)(Host.eepromWrites - writes), longest / 1e6, longestAt / 1e9);
+    CHECK(Host.eepromWrites > writes);                                  // The new extremes were saved
+    CHECK(longest < STALL_LIMIT_NS);
+
+    return TEST_RESULT();
+}
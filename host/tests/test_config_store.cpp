@@ -0,0 +1,126 @@
+/* test_config_store.cpp    Host build - power lost part-way through a config store save
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * Saves a run of records into a ring laid out like the sketch's (EEPROM CONFIG STORE in OSL_Settings.h), enough to go round it more than
+ * once. Each save is made again from the same starting EEPROM with the power cut after every number of bytes it writes, then the board
+ * starts up again and load() has to come back with the record before, or the new one if the save got as far as its CRC. A second save
+ * after the restart has to work as normal.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <new>
+#include <Arduino.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+#include "src/OSL_EEPROMWriter/OSL_EEPROMWriter.h"
+#include "src/OSL_ConfigStore/OSL_ConfigStore.h"
+#include "host_test.h"
+
+#define RECORD_SIZE     22                                              // Config is 22 bytes on the ATmega328
+#define VERSION         7
+#define SAVES           (EEPROM_CONFIG_SLOTS * 2 + 1)
+
+static void record(uint8_t n, uint8_t *data)
+{
+    for (uint8_t i=0; i<RECORD_SIZE; i++) data[i] = (uint8_t)(n * 37 + i * 11);
+}
+
+// Power off and on again: the EEPROM keeps what was written, everything in RAM starts over
+static void restart(OSL_ConfigStore &store)
+{
+    Host.reset(false);
+    new (&EEPROMWriter) OSL_EEPROMWriter();
+    store.begin(EEPROM_CONFIG_START, EEPROM_CONFIG_SLOTS, EEPROM_CONFIG_SLOT_SIZE);
+}
+
+// Is the newest record in the store record n?
+static bool loads(OSL_ConfigStore &store, uint8_t n)
+{
+    uint8_t want[RECORD_SIZE], got[RECORD_SIZE];
+    record(n, want);
+    memset(got, 0, sizeof(got));
+    return store.load(got, sizeof(got)) == VERSION && store.length() == RECORD_SIZE && memcmp(want, got, sizeof(want)) == 0;
+}
+
+int main()
+{
+    OSL_ConfigStore store;
+    uint8_t  data[RECORD_SIZE];
+    uint8_t  before[HOST_EEPROM_SIZE];
+    uint32_t writes;
+    uint32_t cuts = 0;
+
+    init();
+    store.begin(EEPROM_CONFIG_START, EEPROM_CONFIG_SLOTS, EEPROM_CONFIG_SLOT_SIZE);
+    CHECK(store.load(data, sizeof(data)) == 0);                         // Nothing saved yet
+    record(0, data);
+    CHECK(store.save(data, sizeof(data), VERSION));
+    EEPROMWriter.flush();
+    CHECK(store.saved());
+
+    for (uint8_t n=1; n<=SAVES; n++)
+    {
+        // Save n all the way, to see how many bytes it writes, then start again from before it was saved
+        memcpy(before, Host.eeprom, sizeof(before));
+        restart(store);
+        CHECK(loads(store, n - 1));
+        record(n, data);
+        store.save(data, sizeof(data), VERSION);
+        EEPROMWriter.flush();
+        writes = Host.eepromWrites;
+        CHECK(writes > 0);
+
+        for (uint32_t cut=0; cut<writes; cut++)
+        {
+            bool lost = false;
+            memcpy(Host.eeprom, before, sizeof(before));
+            restart(store);
+            store.load(data, sizeof(data));
+            Host.eepromWritesLeft = cut;
+            record(n, data);
+            try { store.save(data, sizeof(data), VERSION); EEPROMWriter.flush(); }
+            catch (OSL_Host::PowerLoss &) { lost = true; }
+            CHECK(lost);
+            cuts++;
+
+            // The last byte written is the CRC's high byte, so until then the record before is the newest valid one
+            restart(store);
+            if (!loads(store, n - 1)) printf("Save %d cut after %u of %u bytes: record %d not loaded\n", n, cut, writes, n - 1);
+            CHECK(loads(store, n - 1));
+
+            // And the store carries on from there
+            record(n, data);
+            CHECK(store.save(data, sizeof(data), VERSION));
+            EEPROMWriter.flush();
+            CHECK(store.saved());
+            restart(store);
+            CHECK(loads(store, n));
+        }
+
+        // Leave save n in place for the next round
+        memcpy(Host.eeprom, before, sizeof(before));
+        restart(store);
+        store.load(data, sizeof(data));
+        record(n, data);
+        CHECK(store.save(data, sizeof(data), VERSION));
+        EEPROMWriter.flush();
+        CHECK(store.saved());
+    }
+
+    printf("%d saves, each cut short at every byte: %u power losses\n", SAVES, cuts);
+    return TEST_RESULT();
+}
@@ -0,0 +1,81 @@
+/* test_debug_stall.cpp     Host build - how long the main loop is held up by debug messages
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * With DEBUG on, every change of drive mode, light setting and radio state prints a message. This drives a sketch built with DEBUG set to
+ * true through a minute of quick changes, with the radio dropping out twice, times each pass of loop() (not counting time asleep) and
+ * prints the longest, along with how much text came out. A pass that has to wait for room in the serial transmit buffer shows up here,
+ * since writing to a full buffer takes as long as the bytes take to go out at BaudRate.
+ *
+ * Only generic calls into the sketch are used, so this builds against older copies of the sketch as well, for before and after numbers.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+#include "host_test.h"
+
+static_assert(DEBUG, "Build this against a sketch with DEBUG set to true");
+
+#define DRIVE_MS            60000UL
+#define STEP_MS             700                                         // A new stick position this often
+#define STALL_LIMIT_NS      5000000ULL                                  // 5 mS, a fraction of a 20 mS radio frame
+
+int main()
+{
+    uint64_t start, end, longest = 0, longestAt = 0;
+    uint32_t passes = 0;
+    size_t before;
+
+    init();
+    Host.rcPulse(pin_HW1_Throttle, 1500);
+    Host.rcPulse(pin_HW1_Steering, 1500);
+    Host.rcPulse(pin_HW1_Ch3, 1000);
+    setup();
+    runSketch(3000);                                                    // Start-up printing is allowed to take its time
+
+    // Throttle, steering and channel 3 all over the place, with the radio off for a second twice
+    start = Host.now();
+    srand(1);
+    for (uint32_t ms=0; ms<DRIVE_MS; ms+=STEP_MS)
+    {
+        uint64_t at = start + (uint64_t)ms * 1000000ULL;
+        bool off = (ms / STEP_MS) % 40 == 20;
+        Host.rcPulseAt(pin_HW1_Throttle, off ? 0 : 1000 + rand() % 1001, at);
+        Host.rcPulseAt(pin_HW1_Steering, off ? 0 : 1000 + rand() % 1001, at);
+        Host.rcPulseAt(pin_HW1_Ch3, off ? 0 : (rand() % 2 ? 1000 : 2000), at);
+    }
+    end = start + DRIVE_MS * 1000000ULL;
+
+    before = Host.serialOutput.size();
+    while (Host.now() < end)
+    {
+        uint64_t t = Host.now();
+        uint64_t slept = Host.sleepNs;
+        loop();
+        uint64_t busy = (Host.now() - t) - (Host.sleepNs - slept);     // Time asleep waiting for the next tick isn't a stall
+        if (busy > longest) { longest = busy; longestAt = t - start; }
+        passes++;
+    }
+
+    printf("%u passes of loop() in %lu S, %u bytes of debug output, longest pass %.2f mS (at %.1f S)\n", passes, DRIVE_MS / 1000,
+           (unsigned)(Host.serialOutput.size() - before), longest / 1e6, longestAt / 1e9);
+    CHECK(Host.serialOutput.size() - before > 1000);                    // There was plenty to print
+    CHECK(longest < STALL_LIMIT_NS);
+
+    return TEST_RESULT();
+}
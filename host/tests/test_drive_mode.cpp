@@ -0,0 +1,189 @@
+/* test_drive_mode.cpp      Host build - OSL_DriveMode against the drive-mode logic it replaced
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * OldDriveLogic below is the drive mode, braking, stop-length and accel/decel code that was written out in VehicleLogic (and ReturnDriveMode
+ * on the DRIVE tab) before it became the OSL_DriveMode state machine, with the globals it used made into members and millis() into a now
+ * that is passed in. Both are fed the same long runs of random throttle commands, for each combination of the settings that change the
+ * logic, and every output has to agree at every step.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <Arduino.h>
+#include "src/OSL_DriveMode/OSL_DriveMode.h"
+#include "host_test.h"
+
+#define STEPS       1000000
+
+struct OldDriveLogic
+{
+    DriveModeConfig c;
+    uint8_t  DriveModeCommand, DriveModeCommand_Previous, DriveMode, DriveMode_Previous;
+    int8_t   ThrottleCommand_Previous;
+    boolean  canBrake, Braking, Accelerating, Decelerating, StoppedLongTime, TurnSignal_Enable, canChangeScheme;
+    uint32_t TimeStopped, Last_FWD_Time;
+    uint8_t  ReverseTaps;
+
+    void begin(const DriveModeConfig &config, uint32_t now)
+    {
+        c = config;
+        DriveModeCommand = DriveModeCommand_Previous = DriveMode = DriveMode_Previous = STOP;
+        ThrottleCommand_Previous = 0;
+        canBrake = Braking = Accelerating = Decelerating = StoppedLongTime = TurnSignal_Enable = canChangeScheme = false;
+        TimeStopped = now;
+        Last_FWD_Time = 0;
+        ReverseTaps = 0;
+    }
+
+    uint8_t ReturnDriveMode(int ThrottleCMD)
+    {
+        if (ThrottleCMD       >  c.throttleDeadband) { return FWD;  }
+        else if (ThrottleCMD  < -c.throttleDeadband) { return REV;  }
+        else                                         { return STOP; }
+    }
+
+    void brakeThreshold(int8_t ThrottleCommand)
+    {
+        if (c.brakeAtThrottlePctBelow > 0 && canBrake == false && abs(ThrottleCommand) > c.brakeAtThrottlePctBelow) { Braking = false; canBrake = true; }
+        if (c.brakeAtThrottlePctBelow > 0 && canBrake == true && abs(ThrottleCommand) <= c.brakeAtThrottlePctBelow) { Braking = true; canBrake = false; }
+    }
+
+    void step(int8_t ThrottleCommand, uint32_t now)
+    {
+        DriveModeCommand = ReturnDriveMode(ThrottleCommand);
+
+        switch (DriveModeCommand)
+        {
+            case FWD:
+                DriveMode = FWD;
+                ReverseTaps = 0;
+                StoppedLongTime = false;
+                Last_FWD_Time = now;
+                canChangeScheme = false;
+                brakeThreshold(ThrottleCommand);
+                break;
+
+            case REV:
+                if (c.doubleTapReverse)
+                {
+                    if (DriveModeCommand_Previous != REV)
+                    {
+                        ReverseTaps += 1;
+                        if (ReverseTaps >= 2)
+                        {
+                            ReverseTaps = 2;
+                            DriveMode = REV;
+                            StoppedLongTime = false;
+                            canChangeScheme = false;
+                        }
+                        else if (now - Last_FWD_Time < c.fwdToRevBrakeTime)
+                        {
+                            DriveMode = STOP;
+                            Braking = true;
+                        }
+                    }
+                    if (DriveMode == REV) brakeThreshold(ThrottleCommand);
+                }
+                else
+                {
+                    DriveMode = REV;
+                    StoppedLongTime = false;
+                    canChangeScheme = false;
+                    brakeThreshold(ThrottleCommand);
+                }
+                break;
+
+            case STOP:
+                if (DriveModeCommand_Previous != STOP)
+                {
+                    Braking = false;
+                    canBrake = false;
+                }
+                DriveMode = STOP;
+                break;
+        }
+
+        if (DriveMode == STOP)
+        {
+            if (DriveMode_Previous != STOP)
+            {
+                TurnSignal_Enable = false;
+                TimeStopped = now;
+                canChangeScheme = false;
+            }
+            else
+            {
+                if (c.turnSignalDelay > 0 && ((now - TimeStopped) >= c.turnSignalDelay)) TurnSignal_Enable = true;
+                if (now - TimeStopped >= c.changeSchemeDelay) canChangeScheme = true;
+                if ((now - TimeStopped) >= c.longStopTime) StoppedLongTime = true;
+            }
+        }
+
+        Decelerating = ((DriveMode == FWD) && (ThrottleCommand >= 0) && (ThrottleCommand < ThrottleCommand_Previous - c.decelPct)) ||
+                       ((DriveMode == REV) && (ThrottleCommand <= 0) && (ThrottleCommand > ThrottleCommand_Previous + c.decelPct));
+        Accelerating = (DriveMode == FWD) && (ThrottleCommand >= 0) && (ThrottleCommand > ThrottleCommand_Previous + c.accelPct);
+
+        DriveMode_Previous = DriveMode;
+        DriveModeCommand_Previous = DriveModeCommand;
+        ThrottleCommand_Previous = ThrottleCommand;
+    }
+};
+
+int main()
+{
+    uint32_t runs = 0;
+    srand(1);
+
+    for (int doubleTap=0; doubleTap<2; doubleTap++)
+    for (int brakePct=0; brakePct<=30; brakePct+=30)
+    for (int turnDelay=0; turnDelay<=300; turnDelay+=300)
+    {
+        DriveModeConfig config = { 10, (boolean)doubleTap, (uint8_t)brakePct, 200, (uint16_t)turnDelay, 500, 900, 35, 20 };
+        OldDriveLogic old;
+        OSL_DriveMode drive;
+        uint32_t now = 1000;
+        int8_t throttle = 0;
+        long mismatch = -1;
+
+        old.begin(config, now);
+        drive.begin(config, now);
+        for (long i=0; i<STEPS && mismatch < 0; i++)
+        {
+            // Mostly small steps in time, the throttle held, jumping somewhere new or back to center. Now and again a long stop.
+            now += (rand() % 50 == 0) ? rand() % 2000 : rand() % 40;
+            if (rand() % 8 == 0)        throttle = rand() % 201 - 100;
+            else if (rand() % 3 == 0)   throttle = 0;
+            else if (rand() % 4 == 0)   throttle = constrain(throttle + rand() % 11 - 5, -100, 100);
+
+            old.step(throttle, now);
+            drive.step(throttle, now);
+            if (old.DriveModeCommand != drive.command() || old.DriveMode != drive.mode() || old.Braking != drive.braking() ||
+                old.Accelerating != drive.accelerating() || old.Decelerating != drive.decelerating() ||
+                old.StoppedLongTime != drive.stoppedLongTime() || old.TurnSignal_Enable != drive.turnSignalEnabled() ||
+                old.canChangeScheme != drive.canChangeScheme())
+            {
+                mismatch = i;
+            }
+        }
+        if (mismatch >= 0) printf("DoubleTapReverse %d, BrakeAtThrottlePctBelow %d, TurnSignalDelay %d: differs at step %ld\n", doubleTap, brakePct, turnDelay, mismatch);
+        CHECK(mismatch < 0);
+        runs++;
+    }
+    printf("%u settings, %d random throttle commands each\n", runs, STEPS);
+    return TEST_RESULT();
+}
@@ -0,0 +1,139 @@
+/* test_eeprom_stall.cpp    Host build - how long the main loop is held up by a save to EEPROM
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * Saving the console parameters and uploading a scheme both write more bytes than the EEPROM write queue holds, so they are queued as room
+ * comes free and every pass of loop() should stay short. This times each pass of loop() while a save and then an upload go through, and
+ * prints the longest, which is also the measurement for comparing changes to either of them. A config store save (a scheme change, each
+ * stage of radio setup, auto calibration) fits in the queue, so for that the call to SaveConfig() is timed along with the passes after it.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <string>
+#include <Arduino.h>
+#include <util/crc16.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+#include "src/OSL_ConfigStore/OSL_ConfigStore.h"
+#include "src/OSL_EEPROMWriter/OSL_EEPROMWriter.h"
+#include "src/OSL_Scheduler/OSL_Scheduler.h"
+#include "host_test.h"
+
+#define STALL_LIMIT_NS      5000000ULL                                      // 5 mS, not much more than one EEPROM byte
+
+// Runs loop() until the serial output has grown by something containing what, or timeoutMs has gone by. Returns the longest pass in nS,
+// not counting time asleep.
+static uint64_t runUntil(const std::string &what, uint32_t timeoutMs, bool &seen)
+{
+    size_t from = Host.serialOutput.size();
+    uint64_t end = Host.now() + (uint64_t)timeoutMs * 1000000ULL;
+    uint64_t longest = 0;
+
+    seen = false;
+    while (Host.now() < end)
+    {
+        uint64_t start = Host.now();
+        uint64_t slept = Host.sleepNs;
+        loop();
+        uint64_t busy = (Host.now() - start) - (Host.sleepNs - slept);     // Time asleep waiting for the next tick isn't a stall
+        if (busy > longest) longest = busy;
+        if (Host.serialOutput.find(what, from) != std::string::npos) { seen = true; break; }
+    }
+    return longest;
+}
+
+// Runs loop() until everything queued has been written to EEPROM, returns the longest pass as above
+static uint64_t runUntilWritten(uint32_t timeoutMs)
+{
+    uint64_t end = Host.now() + (uint64_t)timeoutMs * 1000000ULL;
+    uint64_t longest = 0;
+
+    while (Host.now() < end && !EEPROMWriter.idle())
+    {
+        uint64_t start = Host.now();
+        uint64_t slept = Host.sleepNs;
+        loop();
+        uint64_t busy = (Host.now() - start) - (Host.sleepNs - slept);
+        if (busy > longest) longest = busy;
+    }
+    return longest;
+}
+
+static std::string schemeFrame(uint8_t scheme)
+{
+    std::string frame;
+    uint16_t crc = 0;
+
+    frame += (char)UPLOAD_CMD_WRITE;
+    frame += (char)scheme;
+    frame += (char)SCHEME_FORMAT_VERSION;
+    frame += (char)EEPROM_SCHEME_DATA_SIZE;
+    for (uint16_t i=0; i<EEPROM_SCHEME_DATA_SIZE; i++) frame += (char)(i % 2);       // ON and OFF
+    for (size_t i=0; i<frame.size(); i++) crc = _crc_xmodem_update(crc, (uint8_t)frame[i]);
+    frame += (char)(crc >> 8);
+    frame += (char)(crc & 0xFF);
+    return std::string(1, (char)UPLOAD_SOF) + frame;
+}
+
+void SaveConfig();
+extern OSL_ConfigStore ConfigStore;
+extern OSL_Scheduler Scheduler;
+
+int main()
+{
+    uint64_t longest;
+    bool seen;
+    const std::string reply = std::string() + (char)UPLOAD_SOF + (char)UPLOAD_CMD_WRITE + (char)UPLOAD_OK;
+
+    init();
+    setup();
+    Host.rcPulse(2, 1500);
+    Host.rcPulse(17, 1500);
+    Host.rcPulse(4, 1000);
+    runSketch(1000);
+
+    Host.serialInput("set TurnSignalDelay_mS 1000\nsave\n");
+    longest = runUntil("Saved", 2000, seen);
+    CHECK(seen);
+    CHECK(longest < STALL_LIMIT_NS);
+    printf("Parameter save: longest pass of loop() %.1f mS\n", longest / 1e6);
+
+    std::string frame = schemeFrame(1);
+    Host.serialInput(frame.data(), frame.size());
+    longest = runUntil(reply, 3000, seen);
+    CHECK(seen);
+    CHECK(longest < STALL_LIMIT_NS);
+    printf("Scheme upload: longest pass of loop() %.1f mS\n", longest / 1e6);
+
+    uint64_t start = Host.now();
+    SaveConfig();
+    longest = Host.now() - start;
+    longest = max(longest, runUntilWritten(1000));
+    CHECK(EEPROMWriter.idle());
+    CHECK(ConfigStore.saved());
+    CHECK(longest < STALL_LIMIT_NS);
+    printf("Config save: longest pass of loop() %.1f mS\n", longest / 1e6);
+
+    // What the serial task took at most over all of that, for TASK_SERIAL_BUDGET_US in OSL_Settings.h
+    printf("Serial task: longest run %u uS\n", (unsigned)Scheduler.get(TASK_SERIAL).maxTime);
+
+    // Power off and on again, all three should have stuck
+    Host.reset(false);
+    setup();
+    CHECK(Host.eepromWrites == 0);
+
+    return TEST_RESULT();
+}
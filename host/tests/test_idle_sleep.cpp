@@ -0,0 +1,133 @@
+/* test_idle_sleep.cpp      Host build - how much of the time the processor is awake with EnableIdleSleep
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * Runs the sketch through three stretches of 30 seconds: starting up on the shelf with no radio (shelf-queen mode), stopped with the radio
+ * on, and driving. For each it prints how often the processor woke up, how often each task ran, and from those an estimate of the share of the
+ * time the processor was awake.
+ *
+ * Code takes no time in the host build (see host/README.md), so the estimate uses the costs in AwakeUs below for a 16 MHz ATmega328. They
+ * are rough; for a better figure, set PROFILER to true on a board, type p in the serial monitor and put the times it shows in their place.
+ * The counts of wakeups and task runs don't depend on them. With EnableIdleSleep false the processor is awake all of the time.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+#include "src/OSL_Scheduler/OSL_Scheduler.h"
+#include "host_test.h"
+
+static_assert(EnableIdleSleep, "Build this against a sketch with EnableIdleSleep set to true");
+
+extern OSL_Scheduler Scheduler;
+
+#define PHASE_MS        30000UL
+#define CLOCK_READ_NS   4000                                            // A pass of the scheduler reads the clock about 10 times. This makes a pass
+                                                                        // take about as long as on the board, so start-up's wait for the radio, which
+                                                                        // doesn't sleep, goes round about as many times as it would there.
+
+// Rough time awake for each wakeup and each run of a task, in uS on the board
+#define WAKE_US         8                                               // The millis() interrupt and the check before going back to sleep
+static const uint16_t AwakeUs[MAX_SCHEDULER_TASKS] = {
+    40,                                                                 // TASK_RC: every pass of the loop, including working out how long to sleep
+    10,                                                                 // TASK_SERIAL
+    150,                                                                // TASK_LIGHTS: light effects, timers and the button
+    400,                                                                // TASK_VEHICLE: drive mode and SetLights()
+    50,                                                                 // TASK_STATUS
+    300,                                                                // TASK_TELEMETRY
+    10,                                                                 // TASK_SETUP
+};                                                                      // TASK_SYNC and TASK_PIXELS are off in the default sketch
+
+static uint64_t phaseStart;
+static uint32_t lastWakeups, lastRuns[MAX_SCHEDULER_TASKS];
+
+// Start counting from now
+static void startPhase(void)
+{
+    phaseStart = Host.now();
+    lastWakeups = Host.wakeups;
+    for (uint8_t t=0; t<MAX_SCHEDULER_TASKS; t++) lastRuns[t] = Scheduler.get(t).runs;
+}
+
+// Runs the sketch until the time gets to end, then prints what it did since the phase started. Returns the estimated share of the time awake.
+// Each pass of loop() is let finish rather than stopped with Host.stopAt, which would leave the task it was in marked as running.
+static double runPhase(const char *name, uint64_t end)
+{
+    uint64_t awakeUs;
+    uint32_t runs[MAX_SCHEDULER_TASKS];
+    double seconds;
+
+    while (Host.now() < end) loop();
+
+    seconds = (Host.now() - phaseStart) / 1e9;
+    awakeUs = (uint64_t)(Host.wakeups - lastWakeups) * WAKE_US;
+    for (uint8_t t=0; t<MAX_SCHEDULER_TASKS; t++)
+    {
+        runs[t] = Scheduler.get(t).runs - lastRuns[t];
+        awakeUs += (uint64_t)runs[t] * AwakeUs[t];
+    }
+    printf("%-22s %8.0f %8.0f %8.0f %8.0f %8.0f %7.1f%%\n", name, (Host.wakeups - lastWakeups) / seconds, runs[TASK_RC] / seconds,
+           runs[TASK_LIGHTS] / seconds, runs[TASK_VEHICLE] / seconds, runs[TASK_STATUS] / seconds, 100.0 * awakeUs / (seconds * 1e6));
+    startPhase();
+    return (double)awakeUs / (seconds * 1e6);
+}
+
+static void sticks(uint16_t throttle, uint16_t steering, uint16_t ch3, uint64_t at)
+{
+    Host.rcPulseAt(pin_HW1_Throttle, throttle, at);
+    Host.rcPulseAt(pin_HW1_Steering, steering, at);
+    Host.rcPulseAt(pin_HW1_Ch3, ch3, at);
+}
+
+int main()
+{
+    const uint64_t phase = PHASE_MS * 1000000ULL;
+    uint64_t start;
+    double shelf, stopped, driving;
+
+    init();
+    Host.clockReadNs = CLOCK_READ_NS;
+    startPhase();
+    setup();
+    start = Host.now();
+
+    printf("Per second:              wakeups   passes   lights  vehicle   status   awake (estimated)\n");
+
+    // Start-up with no radio: a short wait for it, the shelf-queen delay, then shelf-queen mode. Then the radio comes on with the sticks
+    // centered, which ends shelf-queen mode.
+    sticks(1500, 1500, 1000, start + phase);
+    shelf = runPhase("Shelf queen (no radio)", start + phase);
+    stopped = runPhase("Stopped", start + 2 * phase);
+
+    // Forward, brake, reverse, turn and channel 3 changes, every few seconds
+    for (uint8_t i=0; i<10; i++)
+    {
+        uint64_t at = start + 2 * phase + i * phase / 10;
+        static const uint16_t Throttle[10] = { 1800, 1650, 1300, 1500, 1200, 1500, 1900, 1500, 1700, 1500 };
+        static const uint16_t Steering[10] = { 1500, 1900, 1500, 1500, 1100, 1500, 1500, 1900, 1100, 1500 };
+        sticks(Throttle[i], Steering[i], i < 5 ? 1000 : 2000, at);
+    }
+    driving = runPhase("Driving", start + 3 * phase);
+
+    // Sleeping should cut the time awake well down from all of it, most of all with nothing going on
+    CHECK(shelf < 0.2);
+    CHECK(stopped < 0.3);
+    CHECK(driving < 0.5);
+    CHECK(shelf <= stopped);
+
+    return TEST_RESULT();
+}
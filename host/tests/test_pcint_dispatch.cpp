@@ -0,0 +1,91 @@
+/* test_pcint_dispatch.cpp  Host build - the RC pin change vector with the template dispatch against the library's handler table
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * CMakeLists.txt builds this against the default sketch (PCINT_TEMPLATE_DISPATCH true) and against one with it false. Either way it flips
+ * the throttle pin a million times and calls the port 2 pin change vector after each flip, timing the calls (best of 5), then checks that the radio
+ * still reads: full throttle has to come through as full throttle.
+ *
+ * With the template dispatch the vector reads the port and the time and goes straight to ProcessRCEdge. With the table, the host's stand-in
+ * for the library (host/arduino/OSL_Host.cpp) looks up the handler and calls it through a pointer, and the handler then calls micros() and
+ * digitalRead(). The times are for the host's processor, not the ATmega328, and the host's micros() costs more than the AVR's, so only the
+ * difference between the two builds means anything. The AVR also saves and restores registers around the indirect call, which a PC doesn't
+ * show; see host/README.md for comparing the two vectors in the compiled firmware.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+#include "host_test.h"
+
+#define EDGES           1000000L
+#define ROUNDS          5
+
+extern int8_t ThrottleCommand;
+
+// Average time of fn() in nS, the best of a few rounds of EDGES calls
+template <class F> static double timeEach(F fn)
+{
+    double best = 0;
+    for (int round=0; round<ROUNDS; round++)
+    {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        for (long i=0; i<EDGES; i++) fn();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t).count() / EDGES;
+        if (round == 0 || ns < best) best = ns;
+    }
+    return best;
+}
+
+int main()
+{
+    const uint8_t bit = 1 << pin_HW1_Throttle;                          // Pins 0-7 are port D
+    double vectorNs, microsNs;
+    uint32_t clockReadNs;
+
+    init();
+    Host.rcPulse(pin_HW1_Throttle, 1500);
+    Host.rcPulse(pin_HW1_Steering, 1500);
+    Host.rcPulse(pin_HW1_Ch3, 1000);
+    setup();
+    runSketch(3000);
+    Host.rcPulse(pin_HW1_Throttle, 0);                                  // The pin is ours for now
+
+    // Change the pin behind the simulator's back, so the only thing that runs is the vector. The table's handlers call micros(), which on the
+    // host also looks for interrupts to run, so that is timed by itself too. Reading the clock doesn't move it on while timing, or the millions
+    // of calls would leave the simulated time seconds ahead of the radio.
+    clockReadNs = Host.clockReadNs;
+    Host.clockReadNs = 0;
+    noInterrupts();
+    vectorNs = timeEach([bit]() { PIND ^= bit; PCINT2_vect(); });
+    microsNs = timeEach([]() { micros(); });
+    PIND &= ~bit;
+    interrupts();
+    Host.clockReadNs = clockReadNs;
+    printf("PCINT_TEMPLATE_DISPATCH %s: %.1f nS per pin change (the host's micros() alone %.1f nS)\n", PCINT_TEMPLATE_DISPATCH ? "true" : "false",
+           vectorNs, microsNs);
+
+    // The radio still reads correctly
+    Host.rcPulse(pin_HW1_Throttle, 2000);
+    runSketch(2000);
+    if (ThrottleCommand < 90) printf("Full throttle read as %d\n", ThrottleCommand);
+    CHECK(ThrottleCommand >= 90);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,209 @@
+/* test_simple_timer.cpp    Host build - OSL_SimpleTimer's deadline heap against the slot scan it replaced
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * OldScanTimer below is run(), setTimer() and deleteTimer() as they were before the timers were kept in a heap: every pass of run() looks
+ * at every slot. Both are given a full set of timers with different periods, some repeating and some that run a few times and are set again,
+ * and run() is called every 100 uS for a minute of simulated time. Every timer has to fire the same number of times in both, and the time
+ * each run() took on this PC is printed for the two. idZero() checks that restarting ID 0, which the free slots have, leaves them alone.
+ *
+ * CMakeLists.txt builds this against sketches with 5 (the default), 16 and 32 MAX_SIMPLETIMER_SLOTS. The times are for the host's processor,
+ * not the ATmega328, so only the difference between the two and how it changes with the number of slots mean anything.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <chrono>
+#include <Arduino.h>
+#include "src/OSL_SimpleTimer/OSL_SimpleTimer.h"
+#include "host_test.h"
+
+#define SLOTS           OSL_SimpleTimer::MAX_TIMERS
+#define RUN_MS          60000UL
+#define PASS_US         100                                             // One pass of the main loop
+#define REPEAT_RUNS     3                                               // Odd slots run this many times, then are set again
+
+struct OldScanTimer
+{
+    const static int DEFCALL_DONTRUN = 0, DEFCALL_RUNONLY = 1, DEFCALL_RUNANDDEL = 2;
+    timer_callback_p callbacks[SLOTS];
+    void*         params[SLOTS];
+    unsigned long prev_millis[SLOTS], delays[SLOTS];
+    int           maxNumRuns[SLOTS], numRuns[SLOTS], toBeCalled[SLOTS], timerID[SLOTS];
+    boolean       enabled[SLOTS];
+    int           NextID, numTimers;
+
+    OldScanTimer() : NextID(1), numTimers(0)
+    {
+        for (int i=0; i<SLOTS; i++) { callbacks[i] = 0; enabled[i] = false; numRuns[i] = 0; timerID[i] = 0; }
+    }
+
+    int setTimer(long d, timer_callback_p f, void *p, int n)
+    {
+        int i;
+        for (i=0; i<SLOTS && callbacks[i]; i++) ;
+        if (i == SLOTS) return -1;
+        delays[i] = d; callbacks[i] = f; params[i] = p; maxNumRuns[i] = n; enabled[i] = true; numRuns[i] = 0;
+        prev_millis[i] = millis();
+        timerID[i] = NextID++;
+        numTimers++;
+        return timerID[i];
+    }
+
+    void deleteTimer(int ID)
+    {
+        for (int i=0; i<SLOTS; i++)
+        {
+            if (timerID[i] != ID || callbacks[i] == 0) continue;
+            callbacks[i] = 0; enabled[i] = false; toBeCalled[i] = DEFCALL_DONTRUN; delays[i] = 0; numRuns[i] = 0; timerID[i] = 0;
+            numTimers--;
+        }
+    }
+
+    void run()
+    {
+        int i;
+        unsigned long current_millis = millis();
+
+        for (i = 0; i < SLOTS; i++)
+        {
+            toBeCalled[i] = DEFCALL_DONTRUN;
+            if (callbacks[i] && current_millis - prev_millis[i] >= delays[i])
+            {
+                prev_millis[i] += delays[i];
+                if (enabled[i])
+                {
+                    if (maxNumRuns[i] == OSL_SimpleTimer::RUN_FOREVER) toBeCalled[i] = DEFCALL_RUNONLY;
+                    else if (numRuns[i] < maxNumRuns[i])
+                    {
+                        toBeCalled[i] = DEFCALL_RUNONLY;
+                        numRuns[i]++;
+                        if (numRuns[i] >= maxNumRuns[i]) toBeCalled[i] = DEFCALL_RUNANDDEL;
+                    }
+                }
+            }
+        }
+        for (i = 0; i < SLOTS; i++)
+        {
+            switch (toBeCalled[i])
+            {
+                case DEFCALL_RUNONLY:   (*callbacks[i])(params[i]); break;
+                case DEFCALL_RUNANDDEL: (*callbacks[i])(params[i]); deleteTimer(timerID[i]); break;
+            }
+        }
+    }
+};
+
+// Each timer's callback counts its firings. Odd slots are timers that run a few times, and set themselves up again after the last one.
+static uint32_t fired[2][SLOTS];
+static uint8_t  finished[2][SLOTS];
+static int      which;
+
+static void onTimer(void *p)
+{
+    intptr_t slot = (intptr_t)p;
+    fired[which][slot]++;
+    if ((slot & 1) && fired[which][slot] % REPEAT_RUNS == 0) finished[which][slot] = 1;
+}
+
+static unsigned long period(int slot)   { return 7 + slot * 13; }     // 7 mS to a few hundred, none in step with another
+
+// What reading the clock around a call costs, taken off each average below
+static double clockNs(void)
+{
+    std::chrono::nanoseconds spent(0);
+    for (int i=0; i<1000000; i++)
+    {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        spent += std::chrono::steady_clock::now() - t;
+    }
+    return spent.count() / 1e6;
+}
+
+// Runs either timer for RUN_MS, returns the average time of a call to run() in nS
+template <class Timer> static double runFor(Timer &timer)
+{
+    uint64_t start = Host.now();
+    uint64_t calls = 0;
+    std::chrono::nanoseconds spent(0);
+
+    for (intptr_t i=0; i<SLOTS; i++)
+    {
+        if (i & 1) timer.setTimer(period(i), onTimer, (void *)i, REPEAT_RUNS);
+        else       timer.setTimer(period(i), onTimer, (void *)i, OSL_SimpleTimer::RUN_FOREVER);
+    }
+    while (Host.now() - start < RUN_MS * 1000000ULL)
+    {
+        Host.advance(PASS_US);
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        timer.run();
+        spent += std::chrono::steady_clock::now() - t;
+        calls++;
+        for (intptr_t i=0; i<SLOTS; i++)
+        {
+            if (!finished[which][i]) continue;
+            finished[which][i] = 0;
+            timer.setTimer(period(i), onTimer, (void *)i, REPEAT_RUNS);
+        }
+    }
+    return (double)spent.count() / calls - clockNs();
+}
+
+// Free slots have an ID of 0. If restartTimer(0) put one on the heap, the timer set in it next would skip its place in the heap, and a
+// later deadline at the top would hold up the one below it.
+static uint32_t idZeroFired;
+static void onIdZero(void *)    { idZeroFired++; }
+
+static void idZero(void)
+{
+    OSL_SimpleTimer timer;
+    uint64_t start = Host.now();
+
+    timer.deleteTimer(timer.setTimeout(50, onIdZero, 0));             // Slot 0 is free again
+    timer.setTimeout(60, onIdZero, 0);                                  // Slot 1
+    CHECK(timer.getTimerNum(0) == -1);
+    timer.restartTimer(0);
+    timer.enable(0);
+    timer.setTimeout(100, onIdZero, 0);                                 // Back in slot 0
+    idZeroFired = 0;
+    while (Host.now() - start < 80 * 1000000ULL) { Host.advance(PASS_US); timer.run(); }
+    CHECK(idZeroFired == 1);                                            // The 60 mS timeout, on time
+}
+
+int main()
+{
+    init();
+
+    OldScanTimer *old = new OldScanTimer();
+    OSL_SimpleTimer *heap = new OSL_SimpleTimer();
+    which = 0;
+    double oldNs = runFor(*old);
+    which = 1;
+    double heapNs = runFor(*heap);
+
+    idZero();
+    for (int i=0; i<SLOTS; i++)
+    {
+        if (fired[0][i] != fired[1][i]) printf("Slot %d: fired %u times scanning, %u from the heap\n", i, fired[0][i], fired[1][i]);
+        CHECK(fired[0][i] == fired[1][i]);
+        CHECK(fired[0][i] >= RUN_MS / period(i) - REPEAT_RUNS);
+    }
+    printf("%d timers, run() every %d uS for %lu S: slot scan %.1f nS, heap %.1f nS per call\n", SLOTS, PASS_US, RUN_MS / 1000, oldNs, heapNs);
+
+    delete old;
+    delete heap;
+    return TEST_RESULT();
+}
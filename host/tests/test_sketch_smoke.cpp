@@ -0,0 +1,65 @@
+/* test_sketch_smoke.cpp    Host build - boot the sketch and drive it from the radio
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * The whole sketch with the settings as they are in AA_UserConfig.h: power up with a blank EEPROM, get a radio signal, flip channel 3,
+ * then power up again on the EEPROM the first run left behind.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+#include "host_test.h"
+
+extern int8_t ThrottleCommand;
+
+static const uint8_t LightPins[8] = { 9, 10, 11, 6, 5, 3, 15, 16 };        // pin_HW1_Light1-8
+
+static void readLights(uint8_t *levels)
+{
+    for (uint8_t i=0; i<8; i++) levels[i] = Host.pinOutput(LightPins[i]);
+}
+
+int main()
+{
+    uint8_t stopped[8], switched[8];
+    uint32_t writes;
+
+    init();
+    setup();
+    writes = Host.eepromWrites;
+    CHECK(writes > 0);                                                      // A blank EEPROM gets the defaults written to it
+
+    Host.rcPulse(2, 1500);                                                  // Throttle and steering centered, channel 3 at one end
+    Host.rcPulse(17, 1500);
+    Host.rcPulse(4, 1000);
+    runSketch(3000);
+    readLights(stopped);
+    CHECK(abs(ThrottleCommand) < 10);                                       // Centered reads as centered
+    CHECK(Host.sleepNs > Host.now() / 2);                                   // Nothing much to do, so mostly asleep
+
+    Host.rcPulse(4, 2000);                                                  // Channel 3 to the other end turns on the default scheme's headlights
+    runSketch(2000);
+    readLights(switched);
+    CHECK(memcmp(stopped, switched, sizeof(stopped)) != 0);
+
+    // Power off and on again. Everything was saved the first time, so nothing more is written.
+    Host.reset(false);
+    setup();
+    CHECK(Host.eepromWrites == 0);
+
+    return TEST_RESULT();
+}
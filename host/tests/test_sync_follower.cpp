@@ -0,0 +1,132 @@
+/* test_sync_follower.cpp   Host build - the follower's half of the multi-board sync test
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * Reads what test_sync_master wrote (see there) on stdin, plays the master's serial bytes into a sketch built with SyncRole = SYNC_FOLLOWER
+ * at the times they were sent, and compares the follower's lights with the master's every 10 mS. Both boards run the same schemes, so once
+ * the follower has heard from the master they should match, apart from the one frame (SYNC_INTERVAL_MS) it takes a change to get across. The
+ * backfire effect is random on each board, so that light is only checked for flickering on both.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <vector>
+#include <Arduino.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+#include "src/OSL_SyncLink/OSL_SyncLink.h"
+#include "host_test.h"
+
+static_assert(SyncRole == SYNC_FOLLOWER, "Build this against a sketch with SyncRole set to SYNC_FOLLOWER");
+
+static const uint8_t LightPins[8] = { pin_HW1_Light1, pin_HW1_Light2, pin_HW1_Light3, pin_HW1_Light4,
+                                      pin_HW1_Light5, pin_HW1_Light6, pin_HW1_Light7, pin_HW1_Light8 };
+
+#define SAMPLE_US       10000
+#define SETTLE_US       500000                                          // Time after the first byte before the lights are compared
+#define LATENCY_US      (2 * SYNC_INTERVAL_MS * 1000UL)                 // A light that matches the master this soon after is in step
+#define BACKFIRE_LIGHT  6                                               // Light 7, BACKFIRE in scheme one. It flickers at random on each board.
+
+struct LightChange { uint64_t us; uint8_t light; uint8_t level; };
+
+static std::vector<LightChange> masterChanges, followerChanges;
+
+static void onPinWrite(uint8_t pin, uint8_t value)
+{
+    static uint8_t levels[8];
+    for (uint8_t i=0; i<8; i++)
+    {
+        if (LightPins[i] != pin || levels[i] == value) continue;
+        levels[i] = value;
+        LightChange c = { Host.now() / 1000, i, value };
+        followerChanges.push_back(c);
+    }
+}
+
+// Each light's level in every millisecond up to endMs, from its list of changes
+static void levelsByMs(const std::vector<LightChange> &changes, uint64_t endMs, std::vector<uint8_t> *levels)
+{
+    size_t c = 0;
+    uint8_t now[8] = { 0 };
+    for (uint64_t ms=0; ms<=endMs; ms++)
+    {
+        for ( ; c < changes.size() && changes[c].us <= ms * 1000; c++) now[changes[c].light] = changes[c].level;
+        for (uint8_t i=0; i<8; i++) levels[i].push_back(now[i]);
+    }
+}
+
+int main()
+{
+    char kind;
+    unsigned long long us;
+    unsigned a, b;
+    uint64_t first = 0, last = 0;
+    uint32_t bytes = 0;
+
+    init();
+    Host.onPinWrite = onPinWrite;
+    setup();
+
+    while (scanf(" %c %llu %u", &kind, &us, &a) == 3)
+    {
+        if (kind == 'S')
+        {
+            Host.serialInputAt(a, us * 1000);
+            if (bytes++ == 0) first = us;
+        }
+        else if (kind == 'L' && scanf("%u", &b) == 1)
+        {
+            LightChange c = { us, (uint8_t)(a - 1), (uint8_t)b };
+            masterChanges.push_back(c);
+        }
+        last = us;
+    }
+    // The master sends a frame every SYNC_INTERVAL_MS
+    CHECK(bytes > 0 && bytes >= (last - first) / (SYNC_INTERVAL_MS * 1000UL) * SYNC_FRAME_BYTES * 9 / 10);
+    if (bytes == 0) return TEST_RESULT();
+
+    Host.stopAt = (last + SAMPLE_US) * 1000;
+    try { for (;;) loop(); }
+    catch (OSL_Host::Stop &) { }
+
+    // Compare every light every SAMPLE_US. One that differs from the master counts as in step if the follower had the master's level
+    // within LATENCY_US either side, since a change takes up to a frame to get across and the master changes on its own tick.
+    std::vector<uint8_t> master[8], follower[8];
+    uint64_t latencyMs = LATENCY_US / 1000;
+    uint32_t samples = 0, inStep = 0, changes = 0, backfires[2] = { 0, 0 };
+    levelsByMs(masterChanges, last / 1000 + latencyMs, master);
+    levelsByMs(followerChanges, last / 1000 + latencyMs, follower);
+    for (uint64_t t = (first + SETTLE_US) / 1000; t <= last / 1000; t += SAMPLE_US / 1000)
+    {
+        for (uint8_t i=0; i<8; i++)
+        {
+            if (i == BACKFIRE_LIGHT) continue;
+            bool ok = false;
+            for (uint64_t d = t - latencyMs; !ok && d <= t + latencyMs; d++) ok = (follower[i][d] == master[i][t]);
+            samples++;
+            if (ok) inStep++;
+        }
+    }
+    for (size_t i=0; i<followerChanges.size(); i++) if (followerChanges[i].us > first + SETTLE_US) changes++;
+    for (size_t i=0; i<masterChanges.size(); i++)   if (masterChanges[i].light == BACKFIRE_LIGHT) backfires[0]++;
+    for (size_t i=0; i<followerChanges.size(); i++) if (followerChanges[i].light == BACKFIRE_LIGHT) backfires[1]++;
+
+    printf("%u bytes from the master, follower lights in step for %u of %u samples, %u changes\n", bytes, inStep, samples, changes);
+    CHECK(changes > 10);                                                // The follower did follow the drive
+    CHECK(inStep >= samples * 99 / 100);
+    CHECK(backfires[0] > 0 && backfires[1] > 0);                       // Both backfired, even if not in step
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,98 @@
+/* test_sync_master.cpp     Host build - the master's half of the multi-board sync test
+ * Source:                  https://github.com/OSRCL
+ * Authors:                 Luke Middleton
+ *
+ * Runs a sketch built with SyncRole = SYNC_MASTER through a short drive and writes to stdout every byte it sends out the serial port and
+ * every change of its lights, each with the time it happened. test_sync_follower reads this on its stdin, plays the bytes into a follower
+ * and checks that the follower's lights do what the master's did. ctest runs the two joined by a pipe:
+ *
+ *      test_sync_master | test_sync_follower
+ *
+ * Lines on stdout:  S time_us byte       a byte sent to the followers
+ *                   L time_us light level a change of one of the master's lights (1-8, 0-255)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <Arduino.h>
+#include "src/OSL_Settings/OSL_Settings.h"
+
+static_assert(SyncRole == SYNC_MASTER, "Build this against a sketch with SyncRole set to SYNC_MASTER");
+
+static const uint8_t LightPins[8] = { pin_HW1_Light1, pin_HW1_Light2, pin_HW1_Light3, pin_HW1_Light4,
+                                      pin_HW1_Light5, pin_HW1_Light6, pin_HW1_Light7, pin_HW1_Light8 };
+
+// The drive: from each time on, throttle, steering and channel 3
+struct DriveStep { uint32_t ms; uint16_t throttle, steering, ch3; };
+static const DriveStep Drive[] = {
+    {     0, 1500, 1500, 1000 },                                        // Stopped
+    {  3000, 1800, 1500, 1000 },                                        // Forward
+    {  4500, 1600, 1500, 1000 },                                        // Back off the throttle, the muffler light backfires
+    {  5000, 1300, 1500, 1000 },                                        // Brake
+    {  5500, 1500, 1500, 1000 },
+    {  7000, 1500, 1900, 1000 },                                        // Turn right while stopped, the turn signal blinks
+    { 10000, 1500, 1500, 2000 },                                        // Channel 3 to the other end
+    { 12000, 1250, 1500, 2000 },                                        // Reverse
+    { 14000, 1500, 1100, 2000 },                                        // Turn left
+    { 17000, 1500, 1500, 2000 },
+};
+#define DRIVE_END_MS    19000
+
+static size_t sent = 0;
+
+static void sendSerial(void)
+{   // Everything that has left the master's transmit buffer since last time
+    for ( ; sent < Host.serialOutput.size(); sent++)
+    {
+        printf("S %llu %u\n", (unsigned long long)(Host.now() / 1000), (uint8_t)Host.serialOutput[sent]);
+    }
+}
+
+static void onPinWrite(uint8_t pin, uint8_t value)
+{
+    static uint8_t levels[8];
+    for (uint8_t i=0; i<8; i++)
+    {
+        if (LightPins[i] != pin || levels[i] == value) continue;
+        sendSerial();                                                   // Keep the output in time order
+        levels[i] = value;
+        printf("L %llu %d %d\n", (unsigned long long)(Host.now() / 1000), i + 1, value);
+    }
+}
+
+int main()
+{
+    init();
+    Host.onPinWrite = onPinWrite;
+    setup();
+
+    uint64_t start = Host.now();
+    for (size_t i=0; i<sizeof(Drive) / sizeof(Drive[0]); i++)
+    {
+        uint64_t at = start + (uint64_t)Drive[i].ms * 1000000ULL;
+        Host.rcPulseAt(pin_HW1_Throttle, Drive[i].throttle, at);
+        Host.rcPulseAt(pin_HW1_Steering, Drive[i].steering, at);
+        Host.rcPulseAt(pin_HW1_Ch3, Drive[i].ch3, at);
+    }
+
+    // Run a millisecond at a time so the bytes go out close to when they were sent
+    while (Host.now() < start + (uint64_t)DRIVE_END_MS * 1000000ULL)
+    {
+        runSketch(1);
+        sendSerial();
+    }
+    return 0;
+}
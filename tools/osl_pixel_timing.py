@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""
+osl_pixel_timing.py     Timing of the WS2812 pixel output, and how much it can upset the RC inputs
+Source:                 https://github.com/OSRCL/OSL_Original
+
+When PixelCount is set in AA_UserConfig.h, src/OSL_PixelOutput sends the strip by hand with interrupts off, PixelsPerBurst
+pixels at a time. An RC edge that comes in during a burst is timestamped when the burst ends, so that pulse reads long or
+short by up to the length of the burst. This script prints the time interrupts are off (the worst RC error), the time to send
+the whole strip and the CPU it takes, for each burst size.
+
+The self-test reads the instructions of OSL_PixelOutput::send straight from the .cpp file, runs them cycle by cycle at 16 MHz
+the way the ATmega328 would, and checks every bit of the waveform against the WS2812B datasheet timings. It also decodes the
+waveform the way a pixel would and checks it got the right bytes. The same waveform can be seen on pin 12 with a logic
+analyzer, or in a VCD trace of PORTB when the sketch is run under simavr.
+
+Usage:
+    osl_pixel_timing.py                         table for 16 pixels
+    osl_pixel_timing.py --pixels 40             same, for a longer strip
+    osl_pixel_timing.py --selftest              run send() cycle by cycle and check the waveform and the budgets
+"""
+
+import os
+import re
+import random
+import argparse
+
+# These must match OSL_Settings.h and AA_UserConfig.h
+PIXEL_MAX_COUNT = 64
+PIXEL_US = 30
+PIXEL_BURST_OVERHEAD_US = 2
+PIXEL_MAX_BURST_US = 500
+PIXEL_GAP_MAX_US = 40
+PIXEL_FRAME_MS = 10
+THROTTLE_DEADBAND_US = 50                       # Default ThrottleDeadband of 10, out of 100 for 500 uS of stick travel
+BURST_GAP_US = 9                                # Between bursts with nothing waiting: SREG, two calls to micros() and the loop. An estimate.
+
+F_CPU = 16000000
+SEND_CPP = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'OpenSourceLights', 'src', 'OSL_PixelOutput', 'OSL_PixelOutput.cpp')
+
+# WS2812B datasheet, in nS. Each is the typical value +/- 150 nS, the bit period is 1.25 uS +/- 600 nS.
+T0H = (250, 550)
+T1H = (650, 950)
+T0L = (700, 1000)
+T1L = (300, 600)
+PERIOD = (650, 1850)
+THRESHOLD_NS = 600                              # A pixel reads a 1 if the line is still high about this long after it went high
+
+
+def burst_pixels(pixels, per_burst):
+    return pixels if per_burst == 0 or per_burst > pixels else per_burst
+
+
+def burst_us(pixels, per_burst):
+    """Longest time interrupts are off, as PIXEL_BURST_US in OSL_Settings.h"""
+    return burst_pixels(pixels, per_burst) * PIXEL_US + PIXEL_BURST_OVERHEAD_US
+
+
+def frame_us(pixels, per_burst):
+    """Time to send the whole strip, with nothing else getting in the way"""
+    per = burst_pixels(pixels, per_burst)
+    bursts = (pixels + per - 1) // per
+    return pixels * PIXEL_US + bursts * PIXEL_BURST_OVERHEAD_US + (bursts - 1) * BURST_GAP_US
+
+
+def read_send(path=SEND_CPP):
+    """The instructions of OSL_PixelOutput::send, as (label, mnemonic, operands) with the %[...] operand names left in"""
+    src = open(path).read()
+    body = src[src.index('void OSL_PixelOutput::send'):]
+    body = body[body.index('asm volatile('):body.index(': [b]')]
+    program = []
+    for text in re.findall(r'"([^"]*)"\s*"\\n\\t"', body):
+        text = text.strip()
+        if text.endswith(':'):
+            program.append((text[:-1], None, []))
+            continue
+        parts = text.split(None, 1)
+        ops = [o.strip() for o in parts[1].split(',')] if len(parts) > 1 else []
+        ops = [re.sub(r'%a?\[(\w+)\]', r'\1', o) for o in ops]
+        program.append((None, parts[0], ops))
+    return program
+
+
+def run_send(program, data, hi=0x10, lo=0x00):
+    """Runs send() on data, starting as the C code before the asm does. Returns the port writes as (cycle, value) and how
+    many bytes were read."""
+    r = {'b': data[0], 'bit': 8, 'next': lo, 'hi': hi, 'lo': lo, 'bytes': len(data)}
+    ptr = 1
+    memory = list(data) + [0xA5]                # send() reads one byte past the end
+    reads = 1
+    z = False
+    cycle = 0
+    writes = []
+    labels = {}
+    for i, (label, op, ops) in enumerate(program):
+        if label:
+            labels.setdefault(label, []).append(i)
+
+    def target(ref, i):
+        n, d = ref[:-1], ref[-1]
+        if d == 'b':
+            return max(j for j in labels[n] if j < i)
+        return min(j for j in labels[n] if j > i)
+
+    i = 0
+    while i < len(program):
+        label, op, ops = program[i]
+        i += 1
+        if label:
+            continue
+        if op == 'st':
+            cycle += 2
+            writes.append((cycle, r[ops[1]]))   # The pin changes as the store finishes. Every write is a st, so they're all offset the same.
+        elif op == 'sbrc':
+            if r[ops[0]] & (1 << int(ops[1])):
+                cycle += 1
+            else:
+                cycle += 2                      # Skipping a one-word instruction
+                while program[i][0]:
+                    i += 1
+                i += 1
+        elif op == 'mov':
+            r[ops[0]] = r[ops[1]]
+            cycle += 1
+        elif op == 'lsl':
+            r[ops[0]] = (r[ops[0]] << 1) & 0xFF
+            z = r[ops[0]] == 0
+            cycle += 1
+        elif op == 'dec':
+            r[ops[0]] = (r[ops[0]] - 1) & 0xFF
+            z = r[ops[0]] == 0
+            cycle += 1
+        elif op == 'ldi':
+            r[ops[0]] = int(ops[1], 0)
+            cycle += 1
+        elif op == 'ld':
+            r[ops[0]] = memory[ptr]
+            ptr += 1
+            reads += 1
+            cycle += 2
+        elif op == 'sbiw':
+            r[ops[0]] = (r[ops[0]] - int(ops[1], 0)) & 0xFFFF
+            z = r[ops[0]] == 0
+            cycle += 2
+        elif op == 'nop':
+            cycle += 1
+        elif op == 'rjmp':
+            cycle += 2
+            if ops[0] != '.+0':
+                i = target(ops[0], i - 1)
+        elif op in ('breq', 'brne'):
+            if z == (op == 'breq'):
+                cycle += 2
+                i = target(ops[0], i - 1)
+            else:
+                cycle += 1
+        else:
+            raise ValueError('send() uses %s, which this script doesn\'t know the timing of' % op)
+    return writes, reads
+
+
+def waveform(writes, mask=0x10):
+    """Rising and falling edges of the pin, as (cycle, level)"""
+    edges = []
+    level = 0
+    for cycle, value in writes:
+        if (value & mask != 0) != level:
+            level = 1 - level
+            edges.append((cycle, level))
+    return edges
+
+
+def check_waveform(edges, data):
+    """Checks each bit against the datasheet and decodes it. Returns a list of problems, empty if there were none."""
+    ns = 1e9 / F_CPU
+    problems = []
+    rises = [c for c, level in edges if level == 1]
+    falls = [c for c, level in edges if level == 0]
+    if len(rises) != len(data) * 8 or len(falls) != len(rises):
+        return ['%d bits sent for %d bytes' % (len(rises), len(data))]
+    bits = []
+    for n, (rise, fall) in enumerate(zip(rises, falls)):
+        high = (fall - rise) * ns
+        bit = 1 if high > THRESHOLD_NS else 0
+        bits.append(bit)
+        lo_, hi_ = T1H if bit else T0H
+        if not lo_ <= high <= hi_:
+            problems.append('bit %d: high for %.0f nS' % (n, high))
+        if n + 1 < len(rises):
+            low = (rises[n + 1] - fall) * ns
+            lo_, hi_ = T1L if bit else T0L
+            if not lo_ <= low <= hi_:
+                problems.append('bit %d: low for %.0f nS' % (n, low))
+            period = (rises[n + 1] - rise) * ns
+            if not PERIOD[0] <= period <= PERIOD[1] or rises[n + 1] - rise != 20:
+                problems.append('bit %d: period of %.0f nS' % (n, period))
+    got = [int(''.join(str(b) for b in bits[i:i + 8]), 2) for i in range(0, len(bits), 8)]
+    if got != list(data):
+        problems.append('the pixels would read %s, not %s' % (got, list(data)))
+    return problems
+
+
+def selftest():
+    rnd = random.Random(1)
+    program = read_send()
+
+    # Every bit at 20 cycles, high and low times within the datasheet, the right bytes, and never more than one byte read past the end
+    for data in [[0x00], [0xFF], [0x80, 0x01], [0x55, 0xAA, 0x0F]] + [[rnd.randrange(256) for _ in range(rnd.randrange(1, 13))] for _ in range(200)]:
+        writes, reads = run_send(program, data)
+        problems = check_waveform(waveform(writes), data)
+        assert not problems, problems[:5]
+        assert reads == len(data) + 1, '%d bytes read for %d sent' % (reads, len(data))
+        assert writes[-1][0] <= len(data) * 8 * 20, 'send() takes longer than its bits'
+
+    # Only the pixel pin changes, whatever the rest of the port is doing
+    data = [rnd.randrange(256) for _ in range(6)]
+    writes, reads = run_send(program, data, hi=0x5B, lo=0x4B)
+    assert all(v & ~0x10 == 0x4B for c, v in writes), 'send() changed another pin on the port'
+
+    # The numbers in OSL_Settings.h
+    assert PIXEL_US * F_CPU == 24 * 20 * 1000000, 'PIXEL_US doesn\'t match 24 bits of 20 cycles'
+    assert BURST_GAP_US < PIXEL_GAP_MAX_US, 'the gap between bursts is always too long'
+    assert burst_us(PIXEL_MAX_COUNT, 1) <= THROTTLE_DEADBAND_US, 'one pixel at a time should stay within the throttle deadband'
+    assert burst_us(PIXEL_MAX_COUNT, PIXEL_MAX_COUNT) > PIXEL_MAX_BURST_US, 'the whole strip at once should need a shorter strip'
+    for pixels in range(1, PIXEL_MAX_COUNT + 1):
+        assert frame_us(pixels, 1) < PIXEL_FRAME_MS * 1000, '%d pixels one at a time don\'t fit in a frame' % pixels
+    print('Pixel output self-test passed (%d instructions in send(), 20 cycles per bit)' % sum(1 for p in program if p[1]))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Timing of the OSL WS2812 pixel output')
+    ap.add_argument('--pixels', type=int, default=16, help='number of pixels (PixelCount in AA_UserConfig.h, default 16)')
+    ap.add_argument('--selftest', action='store_true', help='run send() cycle by cycle and check the waveform and the budgets')
+    args = ap.parse_args()
+
+    if args.selftest:
+        selftest()
+        return
+
+    pixels = max(1, min(args.pixels, PIXEL_MAX_COUNT))
+    print('%d pixels, %d bytes of RAM, sent every %d mS if anything changed' % (pixels, pixels * 3, PIXEL_FRAME_MS))
+    print()
+    print('PixelsPerBurst  Interrupts off  Whole strip  CPU     Allowed')
+    for per_burst in [0, 1, 2, 4, 8, 16]:
+        if per_burst >= pixels:
+            continue
+        off = burst_us(pixels, per_burst)
+        note = 'no, serial port' if off > PIXEL_MAX_BURST_US else 'yes' if off <= THROTTLE_DEADBAND_US else 'yes, > deadband'
+        print('%14s  %11d uS  %8d uS  %4.1f%%   %s' %
+              ('0 (all)' if per_burst == 0 else per_burst, off, frame_us(pixels, per_burst),
+               frame_us(pixels, per_burst) / (PIXEL_FRAME_MS * 10.0), note))
+    print('An RC pulse that ends during a burst reads long by up to the time interrupts are off. The default throttle deadband')
+    print('is %d uS either side of center.' % THROTTLE_DEADBAND_US)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+"""
+osl_scheme_compile.py   Compile light schemes from a CSV file into a packed PROGMEM header for the OSL sketch
+Source:                 https://github.com/OSRCL/OSL_Original
+
+Fill in the schemes in "OSL Light Setup_v7.xls" (or any spreadsheet) and save it as CSV. The CSV is read like this:
+  - A row whose first cell starts with "Scheme" begins a new scheme
+  - A row of NumStates setting names (OFF, ON, NA, BLINK, ...) is one light, in order from light 1. A label in the first
+    cell ("Light 1", "1", etc.) is allowed and ignored
+  - Every other row (headings, notes, blank lines) is ignored
+tools/schemes_default.csv holds the two schemes from AA_LightSetup as an example.
+
+Every setting is checked before anything is written: unknown names and settings that need PWM on lights without it are
+errors, NA in a Channel 3 position is a warning. Lights that are set the same way in more than one place are only stored
+once - the header holds a table of unique light rows, plus for each scheme the row used by each light.
+
+Set UseCompiledSchemes to true in AA_UserConfig.h and NumSchemes to the number of schemes to use the result. If the board
+has shift registers for extra lights, give the same number as ShiftRegisters with --registers.
+
+Usage:
+    osl_scheme_compile.py SCHEMES.csv [-o OpenSourceLights/AA_SchemesCompiled.h] [--registers N]
+"""
+
+import os
+import sys
+import csv
+import argparse
+
+# These must match OSL_Settings.h and the comments in AA_LightSetup
+SETTINGS = ['OFF', 'ON', 'NA', 'BLINK', 'BLINK_ALT', 'FASTBLINK', 'FASTBLINK_ALT', 'SOFTBLINK', 'DIM',
+            'FADEOFF', 'FADEON', 'XENON', 'BACKFIRE', 'SAFETYBLINK', 'SAFETYBLINK_ALT']
+STATES = ['Pos 1', 'Pos 2', 'Pos 3', 'Pos 4', 'Pos 5', 'Forward', 'Reverse', 'Stop', 'StopDelay', 'Brake',
+          'Right Turn', 'Left Turn', 'No Turn', 'Accelerating', 'Decelerating']
+NUM_LIGHTS = 8                                  # Changed by --registers
+NUM_STATES = len(STATES)
+CHANNEL3_STATES = 5                             # The first five states are the Channel 3 positions
+PWM_SETTINGS = ['DIM', 'FADEOFF', 'FADEON', 'XENON']
+NO_PWM_LIGHTS = [7, 8]                          # Every other light can do PWM, including those on shift registers
+
+DEFAULT_OUTPUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'OpenSourceLights', 'AA_SchemesCompiled.h')
+
+
+def read_schemes(path):
+    schemes = []
+    errors = []
+    warnings = []
+    with open(path, newline='') as f:
+        for lineno, cells in enumerate(csv.reader(f), 1):
+            cells = [c.strip() for c in cells]
+            while cells and not cells[-1]:
+                cells.pop()
+            if not cells:
+                continue
+            if cells[0].upper().startswith('SCHEME'):
+                schemes.append([])
+                continue
+            names = [c.upper() for c in cells]
+            labelled = len(names) == NUM_STATES + 1
+            if labelled:
+                names = names[1:]
+            if len(names) != NUM_STATES or not any(n in SETTINGS for n in names):
+                continue                        # Headings, notes, etc.
+            where = '%s:%d' % (path, lineno)
+            if not schemes:
+                errors.append('%s: light row before the first "Scheme" row' % where)
+                continue
+            light = len(schemes[-1]) + 1
+            if light > NUM_LIGHTS:
+                errors.append('%s: scheme %d has more than %d lights' % (where, len(schemes), NUM_LIGHTS))
+                continue
+            row = []
+            for state, n in enumerate(names):
+                if n not in SETTINGS:
+                    errors.append('%s: light %d, %s: unknown setting "%s"' % (where, light, STATES[state], n))
+                    n = 'OFF'
+                elif n in PWM_SETTINGS and light in NO_PWM_LIGHTS:
+                    errors.append('%s: light %d, %s: %s needs PWM, lights 7 and 8 don\'t have it' % (where, light, STATES[state], n))
+                elif n == 'NA' and state < CHANNEL3_STATES:
+                    warnings.append('%s: light %d, %s: NA in a Channel 3 position, the light will keep whatever it was doing' % (where, light, STATES[state]))
+                row.append(SETTINGS.index(n))
+            schemes[-1].append(tuple(row))
+
+    for i, s in enumerate(schemes, 1):
+        if len(s) != NUM_LIGHTS:
+            errors.append('%s: scheme %d has %d lights, it needs %d' % (path, i, len(s), NUM_LIGHTS))
+    if not schemes:
+        errors.append('%s: no schemes found' % path)
+    return schemes, errors, warnings
+
+
+def pack(schemes):
+    rows = []
+    index = []
+    for s in schemes:
+        index.append([])
+        for r in s:
+            if r not in rows:
+                rows.append(r)
+            index[-1].append(rows.index(r))
+    return rows, index
+
+
+def write_header(path, source, schemes, rows, index):
+    width = max(len(n) for n in SETTINGS) + 2
+    with open(path, 'w') as f:
+        f.write('// AA_SchemesCompiled.h - light schemes, generated by tools/osl_scheme_compile.py from %s\n' % os.path.basename(source))
+        f.write('// DON\'T EDIT THIS FILE - change the CSV and run the script again. Only used if UseCompiledSchemes = true in AA_UserConfig.h\n')
+        f.write('// %d schemes, %d unique light rows, %d bytes of flash (%d as a full table)\n\n' %
+                (len(schemes), len(rows), flash_packed(schemes, rows), flash_full(schemes)))
+        f.write('#if NumSchemes != %d\n' % len(schemes))
+        f.write('#error "AA_SchemesCompiled.h holds %d schemes, set NumSchemes in AA_UserConfig.h to match"\n' % len(schemes))
+        f.write('#endif\n')
+        f.write('#if NumLights != %d\n' % NUM_LIGHTS)
+        f.write('#error "AA_SchemesCompiled.h has %d lights per scheme, compile it again with --registers to match ShiftRegisters in AA_UserConfig.h"\n' % NUM_LIGHTS)
+        f.write('#endif\n\n')
+        f.write('    // Each unique light row, one setting per state\n')
+        f.write('    const PROGMEM uint8_t SchemeRows[%d][NumStates] =\n    {\n' % len(rows))
+        f.write(('        //     ' + ''.join(s.ljust(width) for s in STATES)).rstrip() + '\n')
+        for i, r in enumerate(rows):
+            cells = ''.join((SETTINGS[v] + (',' if j < len(r) - 1 else '')).ljust(width) for j, v in enumerate(r))
+            f.write('            {  %s }%s  // Row %d\n' % (cells.rstrip(), ',' if i < len(rows) - 1 else ' ', i))
+        f.write('    };\n\n')
+        f.write('    // For each scheme, the row used by each light\n')
+        f.write('    const PROGMEM uint8_t SchemeLightRows[NumSchemes][NumLights] =\n    {\n')
+        for i, lights in enumerate(index):
+            f.write('        {  %s  }%s  // Scheme %d\n' % (', '.join('%3d' % v for v in lights), ',' if i < len(index) - 1 else ' ', i + 1))
+        f.write('    };\n')
+
+
+def flash_full(schemes):
+    return len(schemes) * NUM_LIGHTS * NUM_STATES
+
+
+def flash_packed(schemes, rows):
+    return len(rows) * NUM_STATES + len(schemes) * NUM_LIGHTS
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Compile OSL light schemes from CSV into AA_SchemesCompiled.h')
+    ap.add_argument('csv', help='CSV export of the light setup spreadsheet')
+    ap.add_argument('-o', '--output', default=DEFAULT_OUTPUT, help='header to write (default: OpenSourceLights/AA_SchemesCompiled.h)')
+    ap.add_argument('--registers', type=int, default=0, choices=range(2), help='ShiftRegisters in AA_UserConfig.h, 0 or 1 (default 0)')
+    args = ap.parse_args()
+
+    global NUM_LIGHTS
+    NUM_LIGHTS = 8 + 8 * args.registers
+    schemes, errors, warnings = read_schemes(args.csv)
+    for w in warnings:
+        print('warning: ' + w, file=sys.stderr)
+    if errors:
+        for e in errors:
+            print('error: ' + e, file=sys.stderr)
+        sys.exit('%d errors, nothing written' % len(errors))
+
+    rows, index = pack(schemes)
+    if len(rows) > 255:
+        sys.exit('%d unique light rows, no more than 255 are allowed' % len(rows))
+    write_header(args.output, args.csv, schemes, rows, index)
+
+    print('Wrote %s' % os.path.normpath(args.output))
+    print('%d schemes, %d lights each, %d unique light rows' % (len(schemes), NUM_LIGHTS, len(rows)))
+    print('Flash: %d bytes (%d rows x %d states + %d schemes x %d lights), %d as a full table, %d saved' %
+          (flash_packed(schemes, rows), len(rows), NUM_STATES, len(schemes), NUM_LIGHTS, flash_full(schemes),
+           flash_full(schemes) - flash_packed(schemes, rows)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,339 @@
+#!/usr/bin/env python3
+"""
+osl_scheme_upload.py    Send a light scheme to an Open Source Lights board over the serial port
+Source:                 https://github.com/OSRCL/OSL_Original
+
+The scheme is stored in the OSL's EEPROM and replaces the scheme of the same number in AA_LightSetup
+until it is erased again. EnableSchemeUpload must be set to true in AA_UserConfig.h.
+
+The scheme file uses the same layout as one scheme in AA_LightSetup: one row per light, one setting
+name per state, for example:
+
+    {  OFF,  OFF,  XENON,  XENON,  XENON,  NA,  NA,  NA,  NA,  NA,  NA,  NA,  NA,  FASTBLINK,  NA  },  // Light 1
+
+Anything after // is ignored, as are braces and blank lines, so a scheme can be copied straight out of AA_LightSetup.
+
+Usage:
+    osl_scheme_upload.py PORT info
+    osl_scheme_upload.py PORT write SCHEME FILE
+    osl_scheme_upload.py PORT erase SCHEME
+    osl_scheme_upload.py --selftest           check the frames against a model of the firmware's side, no board needed
+
+Talking to a board requires pyserial (pip install pyserial).
+"""
+
+import sys
+import time
+import random
+import argparse
+
+# These must match OSL_Settings.h
+SETTINGS = ['OFF', 'ON', 'NA', 'BLINK', 'BLINK_ALT', 'FASTBLINK', 'FASTBLINK_ALT', 'SOFTBLINK', 'DIM',
+            'FADEOFF', 'FADEON', 'XENON', 'BACKFIRE', 'SAFETYBLINK', 'SAFETYBLINK_ALT']
+SCHEME_FORMAT_VERSION = 1
+UPLOAD_SOF = 0xA5
+CMD_INFO = ord('I')
+CMD_WRITE = ord('W')
+CMD_ERASE = ord('E')
+UPLOAD_OK, UPLOAD_ERR_CRC, UPLOAD_ERR_VERSION, UPLOAD_ERR_SCHEME, UPLOAD_ERR_LENGTH, UPLOAD_ERR_SETTING, UPLOAD_ERR_COMMAND = range(7)
+UPLOAD_TIMEOUT_MS = 500
+EEPROM_SCHEME_BANK_START = 512
+EEPROM_SCHEME_HEADER_SIZE = 4
+EEPROM_SCHEME_SLOT_EMPTY = 0xFF
+STATUS = ['OK', 'CRC error', 'scheme format version does not match firmware', 'scheme number out of range',
+          'wrong number of settings', 'invalid setting', 'unknown command']
+
+
+def crc_xmodem(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def parse_scheme(path):
+    with open(path) as f:
+        return parse_scheme_lines(f, path)
+
+
+def parse_scheme_lines(lines, path):
+    rows = []
+    for lineno, line in enumerate(lines, 1):
+        line = line.split('//')[0].replace('{', ' ').replace('}', ' ')
+        names = [n.strip().upper() for n in line.split(',') if n.strip()]
+        if not names:
+            continue
+        row = []
+        for n in names:
+            if n not in SETTINGS:
+                sys.exit('%s:%d: unknown setting "%s"' % (path, lineno, n))
+            row.append(SETTINGS.index(n))
+        rows.append(row)
+    return rows
+
+
+def frame(cmd, scheme=0, payload=b''):
+    body = bytes([cmd, scheme, SCHEME_FORMAT_VERSION, len(payload)]) + bytes(payload)
+    crc = crc_xmodem(body)
+    return bytes([UPLOAD_SOF]) + body + bytes([crc >> 8, crc & 0xFF])
+
+
+def transact(port, cmd, scheme=0, payload=b'', extra=0, timeout=3.0):
+    port.reset_input_buffer()
+    port.write(frame(cmd, scheme, payload))
+    # The OSL may also be printing debug text, skip everything until the start of our reply
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        b = port.read(1)
+        if b and b[0] == UPLOAD_SOF:
+            reply = port.read(2 + extra)
+            if len(reply) == 2 + extra and reply[0] == cmd:
+                return reply[1], reply[2:]
+    sys.exit('No reply from OSL - is EnableSchemeUpload set to true?')
+
+
+class FirmwareModel:
+    """The board's side: the frame parser in SCHEME_UPLOAD.ino and the EEPROM scheme bank in EEPROM.ino, byte for byte"""
+
+    def __init__(self, lights=8, states=15, schemes=2):
+        self.lights, self.states, self.schemes = lights, states, schemes
+        self.data_size = lights * states
+        self.slot_size = EEPROM_SCHEME_HEADER_SIZE + self.data_size
+        self.slots = 0 if self.data_size > 255 else min(4, (1024 - EEPROM_SCHEME_BANK_START) // self.slot_size)
+        self.eeprom = bytearray([0xFF] * 1024)
+        self.writes_left = None                 # If set, the EEPROM stops being written after this many more bytes (a power loss)
+        self.state = 'sof'
+        self.last_byte_ms = 0
+        self.replies = []
+
+    def slot_address(self, scheme):
+        return EEPROM_SCHEME_BANK_START + (scheme - 1) * self.slot_size
+
+    def write(self, address, value):
+        if self.writes_left is not None:
+            if self.writes_left == 0:
+                return
+            self.writes_left -= 1
+        self.eeprom[address] = value
+
+    def slot_crc(self, address, version):
+        # SchemeSlotCRC(): the version, the light count and the settings
+        return crc_xmodem(bytes([version, self.eeprom[address + 1]]) + bytes(self.eeprom[address + EEPROM_SCHEME_HEADER_SIZE:address + self.slot_size]))
+
+    def slot_valid(self, scheme):
+        # SchemeSlotValid()
+        if scheme < 1 or scheme > self.slots:
+            return False
+        a = self.slot_address(scheme)
+        if self.eeprom[a] != SCHEME_FORMAT_VERSION or self.eeprom[a + 1] != self.lights:
+            return False
+        return self.eeprom[a + 2] | (self.eeprom[a + 3] << 8) == self.slot_crc(a, SCHEME_FORMAT_VERSION)
+
+    def slot_scheme(self, scheme):
+        a = self.slot_address(scheme) + EEPROM_SCHEME_HEADER_SIZE
+        return bytes(self.eeprom[a:a + self.data_size])
+
+    def receive(self, data, ms=None):
+        """Bytes arriving over the serial port, at ms (the same time as the last ones if not given)"""
+        if ms is not None:
+            if self.state != 'sof' and ms - self.last_byte_ms > UPLOAD_TIMEOUT_MS:
+                self.state = 'sof'
+            self.last_byte_ms = ms
+        for c in data:
+            self.byte(c)
+
+    def byte(self, c):
+        if self.state == 'sof':
+            if c == UPLOAD_SOF:
+                self.header, self.payload, self.state = [], [], 'header'
+        elif self.state == 'header':
+            self.header.append(c)
+            if len(self.header) == 4:
+                if self.header[3] > self.data_size:
+                    self.reply(self.header[0], UPLOAD_ERR_LENGTH)
+                    self.state = 'sof'
+                else:
+                    self.state = 'payload' if self.header[3] else 'crc'
+                    self.crc = []
+        elif self.state == 'payload':
+            self.payload.append(c)
+            if len(self.payload) == self.header[3]:
+                self.state, self.crc = 'crc', []
+        elif self.state == 'crc':
+            self.crc.append(c)
+            if len(self.crc) == 2:
+                self.state = 'sof'
+                self.frame_done()
+
+    def frame_done(self):
+        cmd, scheme, version, length = self.header
+        if (self.crc[0] << 8 | self.crc[1]) != crc_xmodem(bytes(self.header + self.payload)):
+            status = UPLOAD_ERR_CRC
+        elif cmd == CMD_INFO:
+            status = UPLOAD_OK
+        elif cmd not in (CMD_WRITE, CMD_ERASE):
+            status = UPLOAD_ERR_COMMAND
+        elif scheme < 1 or scheme > min(self.schemes, self.slots):
+            status = UPLOAD_ERR_SCHEME
+        elif cmd == CMD_ERASE:
+            status = UPLOAD_OK
+        elif version != SCHEME_FORMAT_VERSION:
+            status = UPLOAD_ERR_VERSION
+        elif length != self.data_size:
+            status = UPLOAD_ERR_LENGTH
+        elif any(b >= len(SETTINGS) for b in self.payload):
+            status = UPLOAD_ERR_SETTING
+        else:
+            status = UPLOAD_OK
+
+        if status != UPLOAD_OK or cmd == CMD_INFO:
+            self.reply(cmd, status, [SCHEME_FORMAT_VERSION, self.lights, self.states, self.schemes, self.slots] if status == UPLOAD_OK else [])
+        elif cmd == CMD_ERASE:
+            self.write(self.slot_address(scheme), EEPROM_SCHEME_SLOT_EMPTY)
+            self.reply(cmd, status)
+        else:
+            # The commit, in the order the EEPROM writer's queue writes it: slot marked empty, light count, settings, CRC, version byte last
+            a = self.slot_address(scheme)
+            self.write(a, EEPROM_SCHEME_SLOT_EMPTY)
+            self.write(a + 1, self.lights)
+            for i, b in enumerate(self.payload):
+                self.write(a + EEPROM_SCHEME_HEADER_SIZE + i, b)
+            crc = crc_xmodem(bytes([SCHEME_FORMAT_VERSION, self.lights] + self.payload))
+            self.write(a + 2, crc & 0xFF)
+            self.write(a + 3, crc >> 8)
+            self.write(a, SCHEME_FORMAT_VERSION)
+            self.reply(cmd, UPLOAD_OK if self.slot_valid(scheme) else UPLOAD_ERR_CRC)
+
+    def reply(self, cmd, status, extra=()):
+        self.replies.append((cmd, status) + tuple(extra))
+
+
+def selftest():
+    """Frames from this script through the model of the firmware: good ones stored, anything damaged or short turned away"""
+    rnd = random.Random(1)
+    example = """
+        {  OFF,  OFF,  XENON,  XENON,  XENON,  NA,  NA,  NA,  NA,  NA,  NA,  NA,  NA,  FASTBLINK,  NA  },  // Light 1
+        {  FADEOFF,  FADEOFF,  ON,  ON,  ON,  NA,  NA,  NA,  NA,  NA,  NA,  NA,  NA,  NA,  NA  },     // Light 2
+    """.splitlines() + ['{ ' + ', '.join(rnd.choice(SETTINGS) for _ in range(15)) + ' },' for _ in range(6)]
+    rows = parse_scheme_lines(example, 'example')
+    assert len(rows) == 8 and all(len(r) == 15 for r in rows), 'example scheme parsed as %r' % rows
+    assert rows[0][2] == SETTINGS.index('XENON') and rows[1][0] == SETTINGS.index('FADEOFF')
+    payload = bytes(s for r in rows for s in r)
+
+    # Info, then a write that is stored and checks out the way SchemeSlotValid() reads it
+    fw = FirmwareModel()
+    fw.receive(frame(CMD_INFO))
+    assert fw.replies.pop() == (CMD_INFO, UPLOAD_OK, SCHEME_FORMAT_VERSION, 8, 15, 2, 4), 'info reply'
+    fw.receive(frame(CMD_WRITE, 2, payload))
+    assert fw.replies.pop() == (CMD_WRITE, UPLOAD_OK), 'good frame not accepted'
+    assert fw.slot_valid(2) and fw.slot_scheme(2) == payload, 'slot not stored'
+    a = fw.slot_address(2)
+    assert fw.eeprom[a + 2] | fw.eeprom[a + 3] << 8 == crc_xmodem(bytes([SCHEME_FORMAT_VERSION, 8]) + payload), 'slot CRC'
+
+    # Every single-bit error anywhere after the start byte is caught, and leaves the slot as it was
+    good = frame(CMD_WRITE, 1, payload)
+    for i in range(1, len(good)):
+        for bit in range(8):
+            fw = FirmwareModel()
+            bad = bytearray(good)
+            bad[i] ^= 1 << bit
+            fw.receive(bytes(bad), ms=0)
+            fw.receive(b'', ms=1000)                    # Anything left half-received times out
+            assert not fw.slot_valid(1), 'byte %d bit %d: corrupted frame stored' % (i, bit)
+            assert all(r[1] != UPLOAD_OK for r in fw.replies), 'byte %d bit %d: corrupted frame accepted' % (i, bit)
+
+    # A frame cut short gets no reply and stores nothing, and the next frame after the timeout goes through
+    for cut in range(1, len(good)):
+        fw = FirmwareModel()
+        fw.receive(good[:cut], ms=0)
+        assert not fw.replies and not fw.slot_valid(1), 'frame cut at %d bytes was used' % cut
+        fw.receive(good, ms=UPLOAD_TIMEOUT_MS + 1)
+        assert fw.replies == [(CMD_WRITE, UPLOAD_OK)] and fw.slot_scheme(1) == payload, 'no recovery after a frame cut at %d bytes' % cut
+
+    # Frames that are whole but wrong
+    fw = FirmwareModel()
+    for f, status in [(frame(CMD_WRITE, 1, payload[:-1]), UPLOAD_ERR_LENGTH), (frame(CMD_WRITE, 3, payload), UPLOAD_ERR_SCHEME),
+                      (frame(CMD_WRITE, 0, payload), UPLOAD_ERR_SCHEME), (frame(ord('X'), 1), UPLOAD_ERR_COMMAND),
+                      (frame(CMD_WRITE, 1, payload[:-1] + bytes([len(SETTINGS)])), UPLOAD_ERR_SETTING)]:
+        fw.receive(f)
+        assert fw.replies.pop() == (f[1], status), 'expected %s for %r' % (STATUS[status], f)
+    body = bytes([CMD_WRITE, 1, SCHEME_FORMAT_VERSION + 1, len(payload)]) + payload
+    crc = crc_xmodem(body)
+    fw.receive(bytes([UPLOAD_SOF]) + body + bytes([crc >> 8, crc & 0xFF]))
+    assert fw.replies.pop() == (CMD_WRITE, UPLOAD_ERR_VERSION), 'wrong version accepted'
+    fw.receive(bytes([UPLOAD_SOF, CMD_WRITE, 1, SCHEME_FORMAT_VERSION, 255]))
+    assert fw.replies.pop() == (CMD_WRITE, UPLOAD_ERR_LENGTH), 'oversize length accepted'
+    assert not fw.slot_valid(1), 'a bad frame was stored'
+
+    # Power lost part-way through a commit: the slot holds the old scheme, the new one, or is empty, never a mix
+    old = bytes(len(payload))
+    for writes in range(0, 4 + len(payload) + 1):
+        fw = FirmwareModel()
+        fw.receive(frame(CMD_WRITE, 1, old))
+        fw.writes_left = writes
+        fw.receive(frame(CMD_WRITE, 1, payload))
+        assert not fw.slot_valid(1) or fw.slot_scheme(1) in (old, payload), 'power loss after %d bytes left a mixed slot' % writes
+        assert writes > 0 or fw.slot_scheme(1) == old, 'a commit that wrote nothing changed the slot'
+
+    # Debug text in front of a frame is skipped, and erase empties the slot
+    fw = FirmwareModel()
+    fw.receive(b'Drive Mode: Forward\r\n' + good)
+    assert fw.replies.pop() == (CMD_WRITE, UPLOAD_OK) and fw.slot_valid(1), 'frame after debug text'
+    fw.receive(frame(CMD_ERASE, 1))
+    assert fw.replies.pop() == (CMD_ERASE, UPLOAD_OK) and not fw.slot_valid(1), 'erase'
+
+    # With shift registers the slots are bigger and fewer, and with two or more there are none
+    assert FirmwareModel(lights=16).slots == 2 and FirmwareModel(lights=24).slots == 0
+    print('Scheme upload self-test passed (%d byte frames, %d corruptions, %d cut short)' % (len(good), (len(good) - 1) * 8, len(good) - 1))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Upload light schemes to an Open Source Lights board')
+    ap.add_argument('port', nargs='?', help='serial port, eg COM3 or /dev/ttyUSB0')
+    ap.add_argument('--baud', type=int, default=38400, help='must match BaudRate in OSL_Settings.h')
+    ap.add_argument('--selftest', action='store_true', help='check the frames against a model of the firmware, no board needed')
+    sub = ap.add_subparsers(dest='command')
+    sub.add_parser('info')
+    w = sub.add_parser('write')
+    w.add_argument('scheme', type=int)
+    w.add_argument('file')
+    e = sub.add_parser('erase')
+    e.add_argument('scheme', type=int)
+    args = ap.parse_args()
+
+    if args.selftest:
+        selftest()
+        return
+    if not args.port or not args.command:
+        ap.error('give a serial port and a command, or --selftest')
+
+    import serial
+    port = serial.Serial(args.port, args.baud, timeout=0.5)
+    time.sleep(2)       # Opening the port resets the Nano, give the bootloader time to hand over to the sketch
+
+    status, info = transact(port, CMD_INFO, extra=5)
+    version, lights, states, schemes, slots = info
+    if args.command == 'info':
+        print('Scheme format version %d, %d lights, %d states, %d schemes, %d EEPROM slots' % (version, lights, states, schemes, slots))
+        return
+    if version != SCHEME_FORMAT_VERSION:
+        sys.exit('Firmware uses scheme format version %d, this script writes version %d' % (version, SCHEME_FORMAT_VERSION))
+
+    if args.command == 'write':
+        rows = parse_scheme(args.file)
+        if len(rows) != lights or any(len(r) != states for r in rows):
+            sys.exit('Scheme must have %d rows of %d settings' % (lights, states))
+        payload = bytes(s for r in rows for s in r)
+        status, _ = transact(port, CMD_WRITE, args.scheme, payload)
+    else:
+        status, _ = transact(port, CMD_ERASE, args.scheme)
+
+    print(STATUS[status] if status < len(STATUS) else 'error %d' % status)
+    sys.exit(0 if status == 0 else 1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+"""
+osl_shift_timing.py     Refresh timing of the shift register outputs, for each number of registers
+Source:                 https://github.com/OSRCL/OSL_Original
+
+Lights 9 and up are on 74HC595 shift registers when ShiftRegisters is set in AA_UserConfig.h. They are dimmed with bit
+angle modulation by the Timer1 interrupt in src/OSL_ShiftOutput: 8 periods per frame, period n being 2^n times the
+shortest one, and during each period the bits for the next one are clocked into the registers. This script works out
+the frame rate, CPU load and RAM for each number of registers, and simulates the interrupt to check the bits for the
+next period are always in before it starts, even when an RC pin change interrupt runs in the middle of the shifting.
+
+The timings are estimates from the cycle counts of the code at 16 MHz, they aren't measured.
+
+Usage:
+    osl_shift_timing.py                 table for 1 to 7 registers (only 1 fits in the ATmega328's RAM)
+    osl_shift_timing.py --rc-us 12      same, allowing a 12 uS RC interrupt in the worst place (default 8)
+    osl_shift_timing.py --selftest      simulate every register count and check the timing, output order and brightness
+"""
+
+import random
+import argparse
+
+# These must match OSL_Settings.h
+SHIFT_RAM_PER_REGISTER = 660
+SHIFT_RAM_FREE = 2048 - 300 - 8 * 82 - 157
+SHIFT_MAX_REGISTERS = SHIFT_RAM_FREE // SHIFT_RAM_PER_REGISTER
+SHIFT_BAM_BITS = 8
+SHIFT_BYTE_US = 5
+SHIFT_TICK_OVERHEAD_US = 6
+SHIFT_MIN_REFRESH_HZ = 80
+BYTES_PER_LIGHT = 82                            # See ShiftRegisters in AA_UserConfig.h
+TABLE_REGISTERS = 7                             # The timing still works this far, for a processor with more RAM
+
+# How SHIFT_TICK_OVERHEAD_US is split up in OSL_ShiftOutput::tick
+ISR_ENTRY_US = 2                                # From the compare match to the first line of tick()
+BEFORE_SHIFT_US = 2                             # Latch, Arduino pins, OCR1A, turning our own interrupt off
+ISR_EXIT_US = 2                                 # Turning our interrupt back on and returning
+
+
+def tick_us(registers):
+    return SHIFT_TICK_OVERHEAD_US + registers * SHIFT_BYTE_US
+
+
+def frame_us(registers):
+    return tick_us(registers) * ((1 << SHIFT_BAM_BITS) - 1)
+
+
+def period_us(registers, bit):
+    return tick_us(registers) << bit
+
+
+def simulate(registers, rc_us=0, frames=3):
+    """Runs the interrupt for a few frames. An RC interrupt of rc_us lands during the shifting in every period. Returns
+    the time each period was latched and a list of problems, empty if there were none."""
+    problems = []
+    latches = []
+    match = period_us(registers, 0)             # Time of the compare match that starts the current period. The timer starts in period 0.
+    masked_until = 0.0                          # Our interrupt is off until the shifting is done
+    bit = 0
+    for _ in range(frames * SHIFT_BAM_BITS):
+        bit = (bit + 1) % SHIFT_BAM_BITS
+        # OCR1A is double buffered, so the timer keeps time however late we are. But if we're still shifting when the period after this one
+        # starts, its match is merged with this one and a whole period is lost.
+        next_match = match + period_us(registers, bit)
+        if masked_until >= next_match:
+            problems.append('%d registers: still shifting when period %d should have started' % (registers, (bit + 1) % SHIFT_BAM_BITS))
+        entry = max(match, masked_until) + ISR_ENTRY_US
+        latches.append((bit, entry, match + ISR_ENTRY_US))
+        masked_until = entry + BEFORE_SHIFT_US + registers * SHIFT_BYTE_US + rc_us + ISR_EXIT_US
+        match = next_match
+    return latches, problems
+
+
+def worst_late_us(latches):
+    """Latest any period started, compared to when it would have with nothing else running"""
+    return max(t - on_time for bit, t, on_time in latches)
+
+
+def set_output(planes, pins, registers, output, level):
+    """Same as OSL_ShiftOutput::set"""
+    if output < registers * 8:
+        for b in range(SHIFT_BAM_BITS):
+            mask = 1 << (output & 7)
+            planes[b][output >> 3] = (planes[b][output >> 3] | mask) if level & (1 << b) else (planes[b][output >> 3] & ~mask)
+    else:
+        n = output - registers * 8
+        for b in range(SHIFT_BAM_BITS):
+            pins[b] = (pins[b] | (1 << n)) if level & (1 << b) else (pins[b] & ~(1 << n))
+
+
+def shift_and_latch(planes, registers, bit):
+    """Same as OSL_ShiftOutput::shift, into a simulated chain of 74HC595s. Returns Q0-Q7 of each register after the latch."""
+    chain = [0] * (registers * 8)               # Shift register stages, in the order the data passes through them
+    for r in range(registers, 0, -1):
+        b = planes[bit][r - 1]
+        for m in (0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01):
+            chain = [1 if b & m else 0] + chain[:-1]        # Rising clock edge: SER goes into Q0 of the first register, each Q7 into the next one
+    return chain                                # chain[8 * r + q] is Qq of register r
+
+
+def selftest():
+    rnd = random.Random(1)
+    assert ISR_ENTRY_US + BEFORE_SHIFT_US + ISR_EXIT_US == SHIFT_TICK_OVERHEAD_US, 'the parts of the interrupt overhead don\'t add up'
+    assert SHIFT_MAX_REGISTERS == 1, 'OSL_Settings.h allows %d registers' % SHIFT_MAX_REGISTERS
+    for registers in range(1, TABLE_REGISTERS + 1):
+        # Frame rate, as checked by the #error in OSL_Settings.h
+        assert 1e6 / frame_us(registers) >= SHIFT_MIN_REFRESH_HZ, '%d registers: %.0f Hz' % (registers, 1e6 / frame_us(registers))
+
+        # With nothing else running every period starts exactly on time
+        latches, problems = simulate(registers)
+        assert not problems, problems
+        assert worst_late_us(latches) == 0, '%d registers: periods start up to %.1f uS late' % (registers, worst_late_us(latches))
+
+        # An RC interrupt during the shifting can make the next latch late. With one in every period that can carry over into the period after,
+        # but it never adds up to a whole period, and none are lost.
+        for rc_us in (4, 8, 12, 20):
+            latches, problems = simulate(registers, rc_us)
+            assert not problems, problems
+            assert worst_late_us(latches) < rc_us + tick_us(registers), '%d registers: %.1f uS late with a %d uS RC interrupt' % (registers, worst_late_us(latches), rc_us)
+
+        # Every output ends up on the right register pin, with the right bit in each period
+        levels = [rnd.randrange(256) for _ in range(registers * 8 + 2)]
+        planes = [[0] * registers for _ in range(SHIFT_BAM_BITS)]
+        pins = [0] * SHIFT_BAM_BITS
+        for output, level in enumerate(levels):
+            set_output(planes, pins, registers, output, level)
+        for bit in range(SHIFT_BAM_BITS):
+            q = shift_and_latch(planes, registers, bit)
+            for output in range(registers * 8):
+                assert q[output] == (levels[output] >> bit) & 1, '%d registers: output %d wrong in period %d' % (registers, output, bit)
+            for n in range(2):
+                assert (pins[bit] >> n) & 1 == (levels[registers * 8 + n] >> bit) & 1, 'Arduino pin %d wrong in period %d' % (n, bit)
+
+        # Each output is on for exactly level/255 of the frame
+        for level in range(256):
+            on = sum(period_us(registers, b) for b in range(SHIFT_BAM_BITS) if level & (1 << b))
+            assert on * 255 == level * frame_us(registers), '%d registers: level %d is on for %d of %d uS' % (registers, level, on, frame_us(registers))
+    print('Shift register self-test passed (1 to %d registers)' % TABLE_REGISTERS)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Refresh timing of the OSL shift register outputs')
+    ap.add_argument('--rc-us', type=float, default=8, help='length of an RC pin change interrupt that lands during the shifting (default 8)')
+    ap.add_argument('--selftest', action='store_true', help='simulate every number of registers and check the timing')
+    args = ap.parse_args()
+
+    if args.selftest:
+        selftest()
+        return
+
+    print('Registers  Lights  Shortest period  Frame     Refresh  CPU   Extra RAM  Late with RC interrupt')
+    for registers in range(1, TABLE_REGISTERS + 1):
+        latches, problems = simulate(registers, args.rc_us)
+        busy = SHIFT_BAM_BITS * tick_us(registers) / frame_us(registers)
+        print('%9d  %6d  %12d uS  %5.2f mS  %4.0f Hz  %3.1f%%  %6d B   %s' %
+              (registers, 8 + 8 * registers, tick_us(registers), frame_us(registers) / 1000.0, 1e6 / frame_us(registers),
+               busy * 100, 8 * registers * BYTES_PER_LIGHT, 'PERIOD LOST' if problems else '%.1f uS' % worst_late_us(latches)) +
+              ('' if registers <= SHIFT_MAX_REGISTERS else '  (no room in RAM)'))
+    print('(the ATmega328 has 2048 bytes of RAM in all, room for %d register)' % SHIFT_MAX_REGISTERS)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""
+osl_telemetry.py        Show or plot the telemetry stream from an Open Source Lights board
+Source:                 https://github.com/OSRCL/OSL_Original
+
+EnableTelemetry must be set to true in AA_UserConfig.h. The OSL then sends a snapshot of its radio inputs, drive mode
+and lights every TelemetryInterval_mS. Each snapshot is COBS encoded and ends with a 0 byte, see src/OSL_Telemetry.
+
+Usage:
+    osl_telemetry.py PORT               print each snapshot as a line of text
+    osl_telemetry.py PORT --plot        live plot of the commands and light brightness (requires matplotlib)
+    osl_telemetry.py PORT --csv FILE    also save every snapshot to a CSV file
+    osl_telemetry.py --selftest         check the encoder/decoder against each other, no board needed
+
+Add --registers N if the board has ShiftRegisters set in AA_UserConfig.h, the frame has a setting and level for every light.
+
+Reading from the board requires pyserial (pip install pyserial).
+"""
+
+import sys
+import csv
+import time
+import struct
+import random
+import argparse
+import collections
+
+# These must match OSL_Telemetry.h and OSL_Settings.h
+TELEMETRY_VERSION = 1
+NUM_RC_CHANNELS = 3
+NUM_LIGHTS = 8                                  # Changed by --registers, see set_lights()
+FRAME = struct.Struct('<BI%dHbbBBBB%dB%dBH' % (NUM_RC_CHANNELS, NUM_LIGHTS, NUM_LIGHTS))
+FLAGS = ['Braking', 'Accelerating', 'Decelerating', 'StoppedLong', 'Failsafe']
+SETTINGS = ['OFF', 'ON', 'NA', 'BLINK', 'BLINK_ALT', 'FASTBLINK', 'FASTBLINK_ALT', 'SOFTBLINK', 'DIM',
+            'FADEOFF', 'FADEON', 'XENON', 'BACKFIRE', 'SAFETYBLINK', 'SAFETYBLINK_ALT']
+RC_STATES = ['Uninitialized', 'Acquiring', 'Synched', 'Lost']
+DRIVE_MODES = {1: 'STOP', 2: 'FWD', 3: 'REV'}
+
+
+def set_lights(n):
+    global NUM_LIGHTS, FRAME, CSV_HEADER
+    NUM_LIGHTS = n
+    FRAME = struct.Struct('<BI%dHbbBBBB%dB%dBH' % (NUM_RC_CHANNELS, NUM_LIGHTS, NUM_LIGHTS))
+    CSV_HEADER = csv_header()
+
+
+def crc_xmodem(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    """Same algorithm as OSL_Telemetry::writeCOBS, including the trailing 0"""
+    out = bytearray()
+    i = 0
+    while True:
+        run = 0
+        while i + run < len(data) and data[i + run] != 0 and run < 254:
+            run += 1
+        out.append(run + 1)
+        out += data[i:i + run]
+        i += run
+        if i >= len(data):
+            break
+        if run < 254:
+            i += 1
+    out.append(0)
+    return bytes(out)
+
+
+def cobs_decode(block):
+    """Decode one frame, without its trailing 0. Returns None if it's malformed."""
+    out = bytearray()
+    i = 0
+    while i < len(block):
+        code = block[i]
+        if code == 0 or i + code > len(block):
+            return None
+        out += block[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(block):
+            out.append(0)
+    return bytes(out)
+
+
+def parse(payload):
+    """Returns a dict for a good frame, None for anything else (debug text, a partial frame, a CRC error)"""
+    if payload is None or len(payload) != FRAME.size:
+        return None
+    v = FRAME.unpack(payload)
+    if v[0] != TELEMETRY_VERSION or v[-1] != crc_xmodem(payload[:-2]):
+        return None
+    n = 2 + NUM_RC_CHANNELS
+    return {
+        'time': v[1],
+        'pulse': list(v[2:n]),
+        'throttle': v[n], 'turn': v[n + 1], 'channel3': v[n + 2],
+        'rcState': v[n + 3], 'driveMode': v[n + 4], 'flags': v[n + 5],
+        'setting': list(v[n + 6:n + 6 + NUM_LIGHTS]),
+        'level': list(v[n + 6 + NUM_LIGHTS:n + 6 + 2 * NUM_LIGHTS]),
+    }
+
+
+def frames(port):
+    buf = bytearray()
+    while True:
+        buf += port.read(max(1, port.in_waiting))
+        while 0 in buf:
+            end = buf.index(0)
+            # Frames are always FRAME.size + 1 bytes once encoded, anything in front of that is debug text that was printed between frames
+            f = parse(cobs_decode(bytes(buf[max(0, end - FRAME.size - 1):end])))
+            del buf[:end + 1]
+            if f:
+                yield f
+
+
+def describe(f):
+    flags = [n for i, n in enumerate(FLAGS) if f['flags'] & (1 << i)]
+    lights = ' '.join('%s/%d' % (SETTINGS[s] if s < len(SETTINGS) else s, l) for s, l in zip(f['setting'], f['level']))
+    return '%9.3f  %-8s %-4s thr %4d turn %4d ch3 %d  pulses %s  %s  | %s' % (
+        f['time'] / 1000.0, RC_STATES[f['rcState']] if f['rcState'] < len(RC_STATES) else f['rcState'],
+        DRIVE_MODES.get(f['driveMode'], f['driveMode']), f['throttle'], f['turn'], f['channel3'],
+        '/'.join(str(p) for p in f['pulse']), ','.join(flags), lights)
+
+
+def csv_row(f):
+    return [f['time'], f['rcState'], f['driveMode'], f['flags'], f['throttle'], f['turn'], f['channel3']] + \
+        f['pulse'] + f['setting'] + f['level']
+
+
+def csv_header():
+    return ['time_ms', 'rc_state', 'drive_mode', 'flags', 'throttle', 'turn', 'channel3'] + \
+        ['pulse%d' % (i + 1) for i in range(NUM_RC_CHANNELS)] + \
+        ['setting%d' % (i + 1) for i in range(NUM_LIGHTS)] + ['level%d' % (i + 1) for i in range(NUM_LIGHTS)]
+
+
+CSV_HEADER = csv_header()
+
+
+def plot(source, seconds=10):
+    import matplotlib.pyplot as plt
+    history = collections.deque()
+    plt.ion()
+    fig, (ax_cmd, ax_lights) = plt.subplots(2, 1, sharex=True)
+    last_draw = 0
+    for f in source:
+        history.append(f)
+        while history and f['time'] - history[0]['time'] > seconds * 1000:
+            history.popleft()
+        if time.time() - last_draw < 0.2:
+            continue
+        last_draw = time.time()
+        t = [h['time'] / 1000.0 for h in history]
+        ax_cmd.clear()
+        ax_cmd.plot(t, [h['throttle'] for h in history], label='Throttle')
+        ax_cmd.plot(t, [h['turn'] for h in history], label='Turn')
+        ax_cmd.plot(t, [h['channel3'] * 20 for h in history], label='Channel 3 x 20')
+        ax_cmd.plot(t, [100 if h['flags'] & 1 else 0 for h in history], label='Braking', linestyle=':')
+        ax_cmd.set_ylim(-105, 105)
+        ax_cmd.legend(loc='upper left', fontsize='small')
+        ax_lights.clear()
+        for i in range(NUM_LIGHTS):
+            ax_lights.plot(t, [h['level'][i] + i * 300 for h in history], label='Light %d' % (i + 1))
+        ax_lights.set_yticks([])
+        ax_lights.set_xlabel('seconds')
+        ax_lights.legend(loc='upper left', fontsize='small', ncol=4)
+        plt.pause(0.001)
+
+
+def selftest():
+    """Encode frames the way the firmware does, decode them the way a live stream is decoded, and compare"""
+    rnd = random.Random(1)
+    cases = [bytes(FRAME.size), bytes([0xFF] * FRAME.size)]
+    cases += [bytes(rnd.choice([0, 0, 1, 255, rnd.randrange(256)]) for _ in range(FRAME.size)) for _ in range(2000)]
+    cases += [bytes([1] * 254), bytes([1] * 254 + [0]), bytes([1] * 300), bytes([0] * 3), b'']
+    for data in cases:
+        enc = cobs_encode(data)
+        assert 0 not in enc[:-1] and enc[-1] == 0, 'encoded frame contains a 0'
+        assert len(enc) <= len(data) + 2 + len(data) // 254, 'encoded frame too long'
+        assert cobs_decode(enc[:-1]) == data, 'round trip failed for %r' % data
+    # A good frame survives being mixed into debug text, a corrupted one is dropped
+    body = bytearray(FRAME.pack(TELEMETRY_VERSION, 1234, 1500, 1480, 1000, 50, -20, 3, 2, 2, 1, *([1] * NUM_LIGHTS + [255] * NUM_LIGHTS), 0))
+    body[-2:] = struct.pack('<H', crc_xmodem(body[:-2]))
+
+    class Stream:
+        def __init__(self, data):
+            self.data = bytearray(data)
+            self.in_waiting = len(data)
+
+        def read(self, n):
+            if not self.data:
+                raise StopIteration
+            r = bytes(self.data[:n])
+            del self.data[:n]
+            return r
+
+    bad = bytearray(cobs_encode(bytes(body)))
+    bad[5] ^= 0x40
+    stream = b'Drive Mode: Forward\r\n' + cobs_encode(bytes(body)) + bytes(bad) + cobs_encode(bytes(body))
+    got = []
+    try:
+        for f in frames(Stream(stream)):
+            got.append(f)
+    except (StopIteration, RuntimeError):
+        pass
+    assert len(got) == 2 and got[0]['time'] == 1234 and got[0]['throttle'] == 50 and got[0]['level'][0] == 255, got
+    print('Telemetry self-test passed (%d frames, %d bytes each, %d on the wire)' % (len(cases), FRAME.size, FRAME.size + 2))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Show or plot Open Source Lights telemetry')
+    ap.add_argument('port', nargs='?', help='serial port, eg COM3 or /dev/ttyUSB0')
+    ap.add_argument('--baud', type=int, default=38400, help='must match BaudRate in OSL_Settings.h')
+    ap.add_argument('--plot', action='store_true', help='live plot instead of text')
+    ap.add_argument('--csv', help='also save every snapshot to this CSV file')
+    ap.add_argument('--selftest', action='store_true', help='check the encoder and decoder, no board needed')
+    ap.add_argument('--registers', type=int, default=0, choices=range(2), help='ShiftRegisters in AA_UserConfig.h, 0 or 1 (default 0)')
+    args = ap.parse_args()
+    set_lights(8 + 8 * args.registers)
+
+    if args.selftest:
+        selftest()
+        return
+    if not args.port:
+        ap.error('give a serial port, or --selftest')
+
+    import serial
+    port = serial.Serial(args.port, args.baud, timeout=0.1)
+    source = frames(port)
+    if args.csv:
+        out = open(args.csv, 'w', newline='')
+        writer = csv.writer(out)
+        writer.writerow(CSV_HEADER)
+
+        def logged(src):
+            for f in src:
+                writer.writerow(csv_row(f))
+                yield f
+        source = logged(source)
+    try:
+        if args.plot:
+            plot(source)
+        else:
+            for f in source:
+                print(describe(f))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
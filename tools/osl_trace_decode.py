@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+osl_trace_decode.py     Turn an Open Source Lights trace dump into a readable timeline
+Source:                 https://github.com/OSRCL/OSL_Original
+
+TRACE must be set to true in AA_UserConfig.h. The OSL then logs radio, drive mode and light changes to a buffer in RAM,
+and sends the buffer when it receives a "t" command line over the serial port.
+
+The dump can be read straight from the board, or from a file of raw bytes captured by a terminal program. Opening the
+port normally resets a Nano, which would empty the buffer - this script holds DTR low to try to avoid that, but not every
+USB adapter or operating system honours it. If the board resets, capture the dump with a terminal program that doesn't
+reset it and decode the file instead.
+
+Usage:
+    osl_trace_decode.py --port PORT
+    osl_trace_decode.py FILE
+
+Reading from the board requires pyserial (pip install pyserial).
+"""
+
+import sys
+import time
+import struct
+import argparse
+
+# These must match OSL_Settings.h
+TRACE_DUMP_MAGIC = b'OSLT'
+TRACE_FORMAT_VERSION = 1
+SETTINGS = ['OFF', 'ON', 'NA', 'BLINK', 'BLINK_ALT', 'FASTBLINK', 'FASTBLINK_ALT', 'SOFTBLINK', 'DIM',
+            'FADEOFF', 'FADEON', 'XENON', 'BACKFIRE', 'SAFETYBLINK', 'SAFETYBLINK_ALT']
+RC_STATES = ['UNINITIALIZED', 'ACQUIRING', 'SYNCHED', 'LOST']
+DRIVE_MODES = {1: 'STOP', 2: 'FORWARD', 3: 'REVERSE'}
+CHANNELS = ['Throttle', 'Steering', 'Channel 3']
+
+
+def name(table, i):
+    if isinstance(table, dict):
+        return table.get(i, str(i))
+    return table[i] if i < len(table) else str(i)
+
+
+def describe(event, arg, value):
+    if event == 1:
+        return '%s pulse rejected (%d uS)' % (name(CHANNELS, arg), value)
+    if event == 2:
+        return '%s %s' % (name(CHANNELS, arg), name(RC_STATES, value))
+    if event == 3:
+        return 'Radio state %s' % name(RC_STATES, arg)
+    if event == 4:
+        return 'Drive mode %s%s' % (name(DRIVE_MODES, arg), ', braking' if value else '')
+    if event == 5:
+        return 'Light %d %s' % (arg + 1, name(SETTINGS, value))
+    return 'Unknown event %d (%d, %d)' % (event, arg, value)
+
+
+def crc_xmodem(data):
+    crc = 0
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def decode(data):
+    """Find the last complete dump in data and return (millis at dump, [(time, event, arg, value), ...])"""
+    start = data.rfind(TRACE_DUMP_MAGIC)
+    while start >= 0:
+        body = data[start + len(TRACE_DUMP_MAGIC):]
+        if len(body) >= 7:
+            version, size, count, now = struct.unpack_from('<BBBI', body)
+            end = 7 + size * count
+            if version != TRACE_FORMAT_VERSION:
+                sys.exit('Dump is format version %d, this script reads version %d' % (version, TRACE_FORMAT_VERSION))
+            if len(body) >= end + 2 and crc_xmodem(body[:end]) == struct.unpack_from('<H', body, end)[0]:
+                records = [struct.unpack_from('<IBBH', body, 7 + i * size) for i in range(count)]
+                return now, records
+        start = data.rfind(TRACE_DUMP_MAGIC, 0, start)
+    sys.exit('No complete trace dump found - is TRACE set to true?')
+
+
+def read_port(portname, baud, timeout=3.0):
+    import serial
+    port = serial.Serial()
+    port.port = portname
+    port.baudrate = baud
+    port.timeout = 0.2
+    port.dtr = False            # Try not to reset the board, which would lose the trace
+    port.open()
+    port.reset_input_buffer()
+    port.write(b't\n')
+    data = b''
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        data += port.read(256)
+    return data
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Decode an Open Source Lights trace dump')
+    ap.add_argument('file', nargs='?', help='file of raw bytes captured from the serial port')
+    ap.add_argument('--port', help='read the dump directly from the board, eg COM3 or /dev/ttyUSB0')
+    ap.add_argument('--baud', type=int, default=38400, help='must match BaudRate in OSL_Settings.h')
+    args = ap.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud)
+    elif args.file:
+        with open(args.file, 'rb') as f:
+            data = f.read()
+    else:
+        ap.error('give a file or --port')
+
+    now, records = decode(data)
+    print('%d events, dumped at %.3f s' % (len(records), now / 1000.0))
+    last = None
+    for t, event, arg, value in records:
+        delta = '' if last is None else '(+%d mS)' % (t - last)
+        print('%10.3f s  %-14s %s' % (t / 1000.0, delta, describe(event, arg, value)))
+        last = t
+
+
+if __name__ == '__main__':
+    main()